@@ -33,6 +33,17 @@ QMAKE_CXXFLAGS += -std=c++0x \
 
 INCLUDEPATH += $$PWD/lib/StanfordCPPLib/
 
+# SharedMemoryPriorityQueue uses POSIX shared memory and process-shared mutexes
+unix:!macx {
+    LIBS += -lrt -lpthread
+}
+
+# Build with "qmake CONFIG+=count_operations" to compile in the operation
+# counters (comparisons, copies, allocations, levels) of OperationCounters.h
+count_operations {
+    DEFINES += PQUEUE_COUNT_OPERATIONS
+}
+
 # Copies the given files to the destination directory
 # The rest of this file defines how to copy the resources folder
 defineTest(copyToDestdir) {
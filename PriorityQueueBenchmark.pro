@@ -0,0 +1,43 @@
+TEMPLATE = app
+TARGET = pqueue-bench
+
+# Builds the command-line benchmark runner in bench/ against the queues
+# in src/. The runner has its own main, so it leaves out the testing
+# harness and the library's default Main.
+CONFIG += console no_include_pwd
+CONFIG -= app_bundle
+
+SOURCES += $$files($$PWD/bench/*.cpp)
+SOURCES += $$files($$PWD/src/*.cpp)
+SOURCES -= $$PWD/src/pqueue-main.cpp
+SOURCES += $$files($$PWD/lib/StanfordCPPLib/*.cpp)
+SOURCES -= $$PWD/lib/StanfordCPPLib/main.cpp
+
+HEADERS += $$files($$PWD/bench/*.h)
+HEADERS += $$files($$PWD/src/*.h)
+HEADERS += $$files($$PWD/lib/StanfordCPPLib/*.h)
+
+# Benchmarks are only meaningful with optimization turned on
+QMAKE_CXXFLAGS += -std=c++0x \
+    -Wall \
+    -Wextra \
+    -Wreturn-type \
+    -Werror=return-type \
+    -Wno-missing-field-initializers \
+    -Wno-sign-compare \
+    -Wno-write-strings \
+    -g \
+    -O2
+
+INCLUDEPATH += $$PWD/src/
+INCLUDEPATH += $$PWD/lib/StanfordCPPLib/
+
+unix:!macx {
+    LIBS += -lrt -lpthread
+}
+
+# Build with "qmake CONFIG+=count_operations" to compile in the operation
+# counters (comparisons, copies, allocations, levels) of OperationCounters.h
+count_operations {
+    DEFINES += PQUEUE_COUNT_OPERATIONS
+}
@@ -0,0 +1,142 @@
+/*
+ *  File: PerfCounters.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the PerfCounterGroup on Linux
+ *  with perf_event_open, and as an empty group elsewhere.
+ */
+
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+
+/*
+ *  Function: openEvent
+ *  - - - - - - - - - - - - - - - - - -
+ *  Opens one event for the calling thread on any CPU, as a
+ *  member of the given group, or as a new group leader if
+ *  groupFd is -1. Returns -1 if the event is unavailable.
+ */
+static int openEvent(uint32_t type, uint64_t config, int groupFd) {
+    struct perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = type;
+    attributes.config = config;
+    attributes.disabled = (groupFd == -1);
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                             PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return syscall(__NR_perf_event_open, &attributes, 0, -1, groupFd, 0);
+}
+
+PerfCounterGroup::PerfCounterGroup() {
+    const uint32_t types[PERF_EVENT_COUNT] = {
+        PERF_TYPE_HARDWARE,
+        PERF_TYPE_HARDWARE,
+        PERF_TYPE_HW_CACHE,
+        PERF_TYPE_HARDWARE,
+        PERF_TYPE_HARDWARE
+    };
+    const uint64_t configs[PERF_EVENT_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+    leader = -1;
+    for(int i = 0; i < PERF_EVENT_COUNT; i++) {
+        fds[i] = openEvent(types[i], configs[i], leader);
+        if(leader == -1) leader = fds[i];
+        counts[i] = 0;
+    }
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+    for(int i = 0; i < PERF_EVENT_COUNT; i++) {
+        if(fds[i] >= 0) close(fds[i]);
+    }
+}
+
+void PerfCounterGroup::start() {
+    if(leader < 0) return;
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounterGroup::stop() {
+    if(leader < 0) return;
+    ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    /*
+     *  The group read returns the number of events and the
+     *  enabled and running times, then an (value, id) pair
+     *  for each event in the order they joined the group.
+     */
+    uint64_t buffer[3 + 2 * PERF_EVENT_COUNT];
+    ssize_t length = read(leader, buffer, sizeof(buffer));
+    for(int i = 0; i < PERF_EVENT_COUNT; i++) {
+        counts[i] = 0;
+    }
+    if(length < (ssize_t) (3 * sizeof(uint64_t))) return;
+    uint64_t events = buffer[0];
+    double scale = 1;
+    if(buffer[2] > 0 && buffer[2] < buffer[1]) scale = (double) buffer[1] / buffer[2];
+    uint64_t next = 0;
+    for(int i = 0; i < PERF_EVENT_COUNT; i++) {
+        if(fds[i] < 0) continue;
+        if(next < events && length >= (ssize_t) ((3 + 2 * next + 1) * sizeof(uint64_t))) {
+            counts[i] = buffer[3 + 2 * next] * scale;
+        }
+        next++;
+    }
+}
+
+#else
+
+PerfCounterGroup::PerfCounterGroup() {
+    leader = -1;
+    for(int i = 0; i < PERF_EVENT_COUNT; i++) {
+        fds[i] = -1;
+        counts[i] = 0;
+    }
+}
+
+PerfCounterGroup::~PerfCounterGroup() {}
+void PerfCounterGroup::start() {}
+void PerfCounterGroup::stop() {}
+
+#endif
+
+bool PerfCounterGroup::available(PerfEvent event) const {
+    return fds[event] >= 0;
+}
+
+bool PerfCounterGroup::anyAvailable() const {
+    return leader >= 0;
+}
+
+double PerfCounterGroup::count(PerfEvent event) const {
+    return counts[event];
+}
+
+string PerfCounterGroup::eventName(PerfEvent event) {
+    switch(event) {
+        case PERF_CYCLES: return "cycles";
+        case PERF_INSTRUCTIONS: return "instructions";
+        case PERF_L1D_MISSES: return "l1d_misses";
+        case PERF_LLC_MISSES: return "llc_misses";
+        case PERF_BRANCH_MISSES: return "branch_misses";
+        default: return "unknown";
+    }
+}
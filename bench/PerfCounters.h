@@ -0,0 +1,111 @@
+/*
+ *  File: PerfCounters.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the PerfCounterGroup, which reads
+ *  the CPU's hardware performance counters around a
+ *  measured phase of the benchmark.
+ */
+
+#ifndef _perfcounters_h
+#define _perfcounters_h
+
+#include <string>
+#include <stdint.h>
+using namespace std;
+
+/*
+ *  Enum: PerfEvent
+ *  - - - - - - - - - - - - - - -
+ *  The hardware events counted by a PerfCounterGroup.
+ */
+enum PerfEvent {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_EVENT_COUNT
+};
+
+/*
+ *  Class: PerfCounterGroup
+ *  - - - - - - - - - - - - - - -
+ *  This class opens the events above as one perf_event_open
+ *  group for the calling thread, so they are scheduled onto
+ *  the PMU together and counted over exactly the same
+ *  instructions. Kernel and hypervisor work is excluded.
+ *  When the kernel multiplexes the group, counts are scaled
+ *  by the fraction of time it ran.
+ *
+ *  Events the CPU or kernel does not offer are left out,
+ *  and if perf_event_open is unavailable altogether (other
+ *  platforms, containers, perf_event_paranoid) the group is
+ *  simply empty; callers check available before reporting.
+ */
+class PerfCounterGroup {
+public:
+    /*
+     *  Constructor: PerfCounterGroup
+     *  - - - - - - - - - - - - - - - - - -
+     *  Opens whichever events are available, disabled.
+     */
+    PerfCounterGroup();
+
+    /*
+     *  Destructor: ~PerfCounterGroup
+     *  - - - - - - - - - - - - - - - - - -
+     *  Closes the events.
+     */
+    ~PerfCounterGroup();
+
+    /*
+     *  Method: available
+     *  Parameters: PerfEvent event
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns whether the given event could be opened.
+     */
+    bool available(PerfEvent event) const;
+
+    /*
+     *  Method: anyAvailable
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns whether any event could be opened.
+     */
+    bool anyAvailable() const;
+
+    /*
+     *  Method: count
+     *  Parameters: PerfEvent event
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the count of the given event between the last
+     *  start and stop, or 0 if the event is unavailable.
+     */
+    double count(PerfEvent event) const;
+
+    /*
+     *  Methods: start, stop
+     *  - - - - - - - - - - - - - - - - - -
+     *  Reset and enable the group, and disable it and read
+     *  back its counts.
+     */
+    void start();
+    void stop();
+
+    /*
+     *  Method: eventName
+     *  Parameters: PerfEvent event
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns a column name for an event, such as "cycles".
+     */
+    static string eventName(PerfEvent event);
+
+private:
+    PerfCounterGroup(const PerfCounterGroup& other);
+    PerfCounterGroup& operator =(const PerfCounterGroup& other);
+
+    int leader;
+    int fds[PERF_EVENT_COUNT];
+    double counts[PERF_EVENT_COUNT];
+};
+
+#endif
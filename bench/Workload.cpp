@@ -0,0 +1,191 @@
+/*
+ *  File: Workload.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the workload generator.
+ */
+
+#include "Workload.h"
+#include <algorithm>  // for upper_bound, min, max
+#include <cmath>      // for pow
+#include <vector>
+#include "error.h"
+#include "strlib.h"
+
+/*
+ *  Uniform priorities are drawn from [0, kPriorityRange).
+ *  Small enough that rescheduled priorities cannot overflow.
+ */
+static const int kPriorityRange = 1 << 28;
+
+/*
+ *  Zipf priorities are ranks in [1, kZipfRanks], where rank k
+ *  is drawn with probability proportional to 1 / k^kZipfExponent.
+ */
+static const int kZipfRanks = 1 << 16;
+static const double kZipfExponent = 1.0;
+
+/*
+ *  Timer priorities advance by kTimerSpacing per entry,
+ *  plus up to kTimerJitter of random lateness.
+ */
+static const int kTimerSpacing = 16;
+static const int kTimerJitter = 256;
+
+/*
+ *  A sawtooth workload has kSawtoothTeeth ascending runs,
+ *  rising by kSawtoothStep per entry.
+ */
+static const int kSawtoothTeeth = 8;
+static const int kSawtoothStep = 8;
+
+/*
+ *  Number of distinct priorities in a duplicates workload.
+ */
+static const int kDistinctPriorities = 8;
+
+/*
+ *  Function: splitMix64
+ *  - - - - - - - - - - - - - - - - - -
+ *  Advances a splitmix64 state and returns its next output,
+ *  used to spread a seed over the generator's state.
+ */
+static uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t rotateLeft(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+WorkloadRandom::WorkloadRandom(uint64_t seed) {
+    for(int i = 0; i < 4; i++) {
+        state[i] = splitMix64(seed);
+    }
+}
+
+uint64_t WorkloadRandom::next() {
+    uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotateLeft(state[3], 45);
+    return result;
+}
+
+uint32_t WorkloadRandom::nextInt(uint32_t bound) {
+    return (uint32_t) (((next() >> 32) * bound) >> 32);
+}
+
+double WorkloadRandom::nextDouble() {
+    return (next() >> 11) * (1.0 / (1ULL << 53));
+}
+
+string distributionName(WorkloadDistribution distribution) {
+    switch(distribution) {
+        case DIST_UNIFORM: return "uniform";
+        case DIST_ZIPF: return "zipf";
+        case DIST_TIMER: return "timer";
+        case DIST_SAWTOOTH: return "sawtooth";
+        case DIST_DUPLICATES: return "duplicates";
+        case DIST_ASCENDING: return "ascending";
+        case DIST_DESCENDING: return "descending";
+        default: return "unknown";
+    }
+}
+
+WorkloadDistribution distributionNamed(string name) {
+    for(int i = 0; i < DIST_COUNT; i++) {
+        if(distributionName((WorkloadDistribution) i) == name) return (WorkloadDistribution) i;
+    }
+    error("unknown distribution " + name);
+    return DIST_UNIFORM;
+}
+
+/*
+ *  Class: ZipfSampler
+ *  - - - - - - - - - - - - - - -
+ *  Draws Zipf ranks by binary search over a table of
+ *  the cumulative distribution, built once per workload.
+ */
+class ZipfSampler {
+public:
+    ZipfSampler() {
+        double total = 0;
+        for(int rank = 1; rank <= kZipfRanks; rank++) {
+            total += 1 / pow(rank, kZipfExponent);
+            cumulative.push_back(total);
+        }
+        for(size_t i = 0; i < cumulative.size(); i++) {
+            cumulative[i] /= total;
+        }
+    }
+
+    int sample(WorkloadRandom& random) const {
+        double u = random.nextDouble();
+        int index = upper_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin();
+        return min(index, kZipfRanks - 1) + 1;
+    }
+
+private:
+    std::vector<double> cumulative;
+};
+
+void generateWorkload(Workload& workload, WorkloadDistribution distribution,
+                      int size, int mixPercent, uint64_t seed) {
+    WorkloadRandom random(seed ^ ((uint64_t) distribution << 48) ^ (uint64_t) size);
+    int sawtoothPeriod = max(2, size / kSawtoothTeeth);
+    ZipfSampler *zipf = (distribution == DIST_ZIPF) ? new ZipfSampler : NULL;
+
+    workload.distribution = distribution;
+    workload.values.clear();
+    workload.priorities.clear();
+    workload.increments.clear();
+    workload.enqueues.clear();
+    for(int i = 0; i < size; i++) {
+        int priority = 0;
+        int increment = 0;
+        switch(distribution) {
+            case DIST_UNIFORM:
+                priority = random.nextInt(kPriorityRange);
+                increment = random.nextInt(kPriorityRange);
+                break;
+            case DIST_ZIPF:
+                priority = zipf->sample(random);
+                increment = zipf->sample(random);
+                break;
+            case DIST_TIMER:
+                priority = i * kTimerSpacing + random.nextInt(kTimerJitter);
+                increment = random.nextInt((uint32_t) size * kTimerSpacing + kTimerJitter);
+                break;
+            case DIST_SAWTOOTH:
+                priority = (i % sawtoothPeriod) * kSawtoothStep;
+                increment = random.nextInt(sawtoothPeriod * kSawtoothStep);
+                break;
+            case DIST_DUPLICATES:
+                priority = random.nextInt(kDistinctPriorities);
+                increment = random.nextInt(kDistinctPriorities);
+                break;
+            case DIST_ASCENDING:
+                priority = i;
+                increment = size;
+                break;
+            case DIST_DESCENDING:
+                priority = size - i;
+                increment = 0;
+                break;
+            default:
+                break;
+        }
+        workload.values.add(integerToString(i));
+        workload.priorities.add(priority);
+        workload.increments.add(increment);
+        workload.enqueues.add((int) random.nextInt(100) < mixPercent);
+    }
+    delete zipf;
+}
@@ -0,0 +1,138 @@
+/*
+ *  File: Workload.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the workload generator used by the
+ *  benchmarks: a fast seeded random number generator and
+ *  the priority distributions whose streams it fills.
+ */
+
+#ifndef _workload_h
+#define _workload_h
+
+#include <string>
+#include <stdint.h>
+#include "vector.h"
+using namespace std;
+
+/*
+ *  Class: WorkloadRandom
+ *  - - - - - - - - - - - - - - -
+ *  A xoshiro256** generator seeded through splitmix64. It is
+ *  much faster than the library's random functions, and the
+ *  same seed gives the same stream on every platform.
+ */
+class WorkloadRandom {
+public:
+    /*
+     *  Constructor: WorkloadRandom
+     *  Parameters: uint64_t seed
+     *  - - - - - - - - - - - - - - - - - -
+     *  Starts the stream for the given seed.
+     */
+    WorkloadRandom(uint64_t seed);
+
+    /*
+     *  Method: next
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the next 64 random bits.
+     */
+    uint64_t next();
+
+    /*
+     *  Method: nextInt
+     *  Parameters: uint32_t bound
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns a random integer in [0, bound), using a
+     *  multiply and shift rather than a division.
+     */
+    uint32_t nextInt(uint32_t bound);
+
+    /*
+     *  Method: nextDouble
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns a random real number in [0, 1).
+     */
+    double nextDouble();
+
+private:
+    uint64_t state[4];
+};
+
+/*
+ *  Enum: WorkloadDistribution
+ *  - - - - - - - - - - - - - - -
+ *  The priority patterns the generator produces:
+ *
+ *  DIST_UNIFORM     - uniform over a wide range
+ *  DIST_ZIPF        - Zipf-distributed ranks, so a few small
+ *                     priorities account for most entries
+ *  DIST_TIMER       - increasing with jitter, like timer
+ *                     expiries scheduled a little out of order
+ *  DIST_SAWTOOTH    - ascending runs that repeatedly drop back
+ *  DIST_DUPLICATES  - only a handful of distinct priorities
+ *  DIST_ASCENDING   - strictly ascending, the worst case for
+ *                     LinkedPriorityQueue, which walks its whole
+ *                     list to append each entry
+ *  DIST_DESCENDING  - strictly descending, the worst case for
+ *                     the binary heaps, where each entry
+ *                     percolates up to the root
+ */
+enum WorkloadDistribution {
+    DIST_UNIFORM,
+    DIST_ZIPF,
+    DIST_TIMER,
+    DIST_SAWTOOTH,
+    DIST_DUPLICATES,
+    DIST_ASCENDING,
+    DIST_DESCENDING,
+    DIST_COUNT
+};
+
+/*
+ *  Functions: distributionName, distributionNamed
+ *  - - - - - - - - - - - - - - - - - -
+ *  Convert between a distribution and its option name, such
+ *  as "zipf". distributionNamed signals an error for an
+ *  unknown name.
+ */
+string distributionName(WorkloadDistribution distribution);
+WorkloadDistribution distributionNamed(string name);
+
+/*
+ *  Struct: Workload
+ *  - - - - - - - - - - - - - - -
+ *  The pregenerated streams for one benchmark run, so that
+ *  no generation happens while operations are timed:
+ *
+ *  values     - a short, distinct value for each entry
+ *  priorities - the entry priorities, in enqueue order
+ *  increments - how much later the hold workload reschedules
+ *               each dequeued entry
+ *  enqueues   - whether each step of the mixed workload is
+ *               an enqueue or a dequeue
+ */
+struct Workload {
+    WorkloadDistribution distribution;
+    Vector<string> values;
+    Vector<int> priorities;
+    Vector<int> increments;
+    Vector<bool> enqueues;
+};
+
+/*
+ *  Function: generateWorkload
+ *  Parameters: Workload& workload
+ *              WorkloadDistribution distribution
+ *              int size
+ *              int mixPercent
+ *              uint64_t seed
+ *  - - - - - - - - - - - - - - - - - -
+ *  Fills the workload with size entries drawn from the given
+ *  distribution, with enqueues making up mixPercent of the
+ *  mixed steps. The same arguments always give the same
+ *  workload.
+ */
+void generateWorkload(Workload& workload, WorkloadDistribution distribution,
+                      int size, int mixPercent, uint64_t seed);
+
+#endif
@@ -0,0 +1,951 @@
+/********************************************************************
+ * File: pqueue-bench.cpp
+ *
+ * Non-interactive benchmark runner for the priority queue classes.
+ * Each run times one workload with one priority distribution against
+ * one queue at one size and reports its throughput, so that an engine
+ * can be chosen for a workload from measurements rather than by
+ * guessing. A trace recorded with TracingPriorityQueue can be replayed
+ * against each queue in place of the generated workloads.
+ *
+ * Usage: pqueue-bench [--queues=vector,linked,heap,binomial,library,...]
+ *                     [--workloads=insert,drain,hold,mixed]
+ *                     [--distributions=uniform,zipf,timer,...]
+ *                     [--sizes=10,100,1000,...] [--mix=50]
+ *                     [--repeat=3] [--min-ops=100000]
+ *                     [--quadratic-limit=32768] [--seed=106]
+ *                     [--format=csv|json] [--latency=FILE] [--perf]
+ *                     [--replay=TRACE] [--pacing=full|recorded]
+ *                     [--thresholds=small=N,...] [--calibrate]
+ *                     [--tie-break=lexicographic|fifo|none]
+ */
+#include "VectorPriorityQueue.h"
+#include "LinkedPriorityQueue.h"
+#include "HeapPriorityQueue.h"
+#include "IndirectHeapPriorityQueue.h"
+#include "BinomialHeapPriorityQueue.h"
+#include "SortedArrayPriorityQueue.h"
+#include "RadixHeapPriorityQueue.h"
+#include "AdaptivePriorityQueue.h"
+#include "SmallPriorityQueue.h"
+#include "MinMaxHeapPriorityQueue.h"
+#include "GroupedPriorityQueue.h"
+#include "InstrumentedPriorityQueue.h"
+#include "OperationCounters.h"
+#include "OperationTrace.h"
+#include "PerfCounters.h"
+#include "Workload.h"
+#include "pqueue.h"
+#include "strlib.h"
+#include "vector.h"
+#include "error.h"
+
+#include <algorithm>  // For max
+#include <chrono>
+#include <cstdlib>    // For EXIT_SUCCESS, EXIT_FAILURE
+#include <fstream>
+#include <iomanip>    // For setprecision
+#include <iostream>
+#include <string>
+#include <thread>     // For this_thread::sleep_for
+
+using namespace std;
+
+/* Constants
+ * ------------------------------------------------------------
+ * Defaults for the command-line options.
+ */
+const string kAllQueues = "vector,linked,unrolled,heap,binomial,library,sorted,radix,adaptive,small,buffered,lazy,indirect,minmax,grouped";
+const string kDefaultQueues = "vector,linked,heap,binomial,library,adaptive";
+const string kAllWorkloads = "insert,drain,hold,mixed";
+const string kAllDistributions = "uniform,zipf,timer,sawtooth,duplicates,ascending,descending";
+const string kDefaultDistributions = "uniform";
+const string kDefaultSizes = "10,100,1000,10000,100000,1000000,10000000";
+const int kDefaultMixPercent = 50;
+const int kDefaultRepeat = 3;
+const int kDefaultMinOps = 100000;
+const int kDefaultQuadraticLimit = 1 << 15;
+const int kDefaultSeed = 106;
+
+/* Type: BenchConfig
+ * ------------------------------------------------------------
+ * The options for one invocation of the runner.
+ */
+struct BenchConfig {
+    Vector<string> queues;
+    Vector<string> workloads;
+    Vector<WorkloadDistribution> distributions;
+    Vector<int> sizes;
+    int mixPercent;
+    int repeat;
+    int minOps;
+    int quadraticLimit;
+    int seed;
+    string format;
+    string latencyPath;
+    PerfCounterGroup *perf;
+    OperationTraceReader *trace;
+    bool pacedReplay;
+    AdaptiveThresholds thresholds;
+    bool calibrate;
+    TieBreakPolicy tieBreak;
+};
+
+/* Type: BenchResult
+ * ------------------------------------------------------------
+ * The best of the repeated timings of one run, along with the
+ * per-call latencies measured during it when --latency is given
+ * and its hardware event counts when --perf is given. An event
+ * that could not be counted has a count of -1. A replay also
+ * counts the dequeues and peeks that answered differently than
+ * they did when the trace was recorded.
+ */
+struct BenchResult {
+    string queue;
+    string workload;
+    string distribution;
+    int size;
+    long long operations;
+    double seconds;
+    bool hasLatencies;
+    LatencyProfile latencies;
+    bool hasPerf;
+    double perfCounts[PERF_EVENT_COUNT];
+    long long divergences;
+#ifdef PQUEUE_COUNT_OPERATIONS
+    OperationCounters counters;
+#endif
+};
+
+/* Class: MeasuredPhase
+ * ------------------------------------------------------------
+ * A stopwatch around the timed part of a workload. The untimed
+ * setup, such as prefilling the queue, happens outside of it.
+ * When built with PQUEUE_COUNT_OPERATIONS it also captures the
+ * operation counters for the phase, and when given a group of
+ * hardware counters it counts them over the phase.
+ */
+class MeasuredPhase {
+public:
+    MeasuredPhase(PerfCounterGroup *perf = NULL) : perf(perf) {}
+
+    void begin() {
+#ifdef PQUEUE_COUNT_OPERATIONS
+        clearOperationCounters();
+#endif
+        if (perf != NULL) perf->start();
+        start = chrono::steady_clock::now();
+    }
+
+    void end() {
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        if (perf != NULL) perf->stop();
+        seconds = elapsed.count();
+#ifdef PQUEUE_COUNT_OPERATIONS
+        counters = operationCounters;
+#endif
+    }
+
+    double seconds;
+#ifdef PQUEUE_COUNT_OPERATIONS
+    OperationCounters counters;
+#endif
+
+    PerfCounterGroup *perf;
+
+private:
+    chrono::steady_clock::time_point start;
+};
+
+/* Type: LatencyProbe
+ * ------------------------------------------------------------
+ * Clears and collects the latency profile of a queue type, for
+ * the queues wrapped in an InstrumentedPriorityQueue, and does
+ * nothing for the rest.
+ */
+template <typename PQueue>
+struct LatencyProbe {
+    static void clear() {}
+
+    static bool collect(LatencyProfile&) {
+        return false;
+    }
+};
+
+template <typename PQueue>
+struct LatencyProbe<InstrumentedPriorityQueue<PQueue> > {
+    static void clear() {
+        InstrumentedPriorityQueue<PQueue>::latencies().clear();
+    }
+
+    static bool collect(LatencyProfile& profile) {
+        profile = InstrumentedPriorityQueue<PQueue>::latencies();
+        return true;
+    }
+};
+
+/* Function: fill
+ * ------------------------------------------------------------
+ * Enqueues every entry of the input into the queue.
+ */
+template <typename PQueue>
+void fill(PQueue& queue, const Workload& input) {
+    for (int i = 0; i < input.values.size(); i++) {
+        queue.enqueue(input.values[i], input.priorities[i]);
+    }
+}
+
+/* Function: runWorkload
+ * ------------------------------------------------------------
+ * Times one workload over enough queues of the given size that
+ * at least minOps operations are measured, and returns the number
+ * of operations performed. The workloads are:
+ *
+ *   insert: enqueue size entries into an empty queue.
+ *   drain:  dequeue every entry of a queue holding size entries.
+ *   hold:   on a queue holding size entries, repeatedly dequeue the
+ *           first entry and enqueue it again some distance later.
+ *   mixed:  on a queue holding size entries, enqueue or dequeue at
+ *           random, enqueueing mixPercent of the time.
+ */
+template <typename PQueue>
+long long runWorkload(const string& workload, const Workload& input, int minOps,
+                      MeasuredPhase& phase) {
+    int size = input.values.size();
+    int rounds = max(1, (minOps + size - 1) / size);
+    PQueue *queues = new PQueue[rounds];
+    long long operations = 0;
+    if (workload != "insert") {
+        for (int r = 0; r < rounds; r++) {
+            fill(queues[r], input);
+        }
+    }
+
+    LatencyProbe<PQueue>::clear();
+    phase.begin();
+    if (workload == "insert") {
+        for (int r = 0; r < rounds; r++) {
+            fill(queues[r], input);
+        }
+        operations = (long long) rounds * size;
+    } else if (workload == "drain") {
+        for (int r = 0; r < rounds; r++) {
+            while (!queues[r].isEmpty()) {
+                queues[r].dequeue();
+            }
+        }
+        operations = (long long) rounds * size;
+    } else if (workload == "hold") {
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < size; i++) {
+                int priority = (int) queues[r].peekPriority();
+                string value = queues[r].dequeue();
+                queues[r].enqueue(value, priority + input.increments[i]);
+            }
+        }
+        operations = 2LL * rounds * size;
+    } else if (workload == "mixed") {
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < size; i++) {
+                if (input.enqueues[i] || queues[r].isEmpty()) {
+                    queues[r].enqueue(input.values[i], input.priorities[i]);
+                } else {
+                    queues[r].dequeue();
+                }
+            }
+        }
+        operations = (long long) rounds * size;
+    }
+    phase.end();
+
+    delete[] queues;
+    return operations;
+}
+
+/* Function: waitUntil
+ * ------------------------------------------------------------
+ * Waits for the given time, sleeping while it is more than a
+ * millisecond away and spinning for the rest, since a sleep can
+ * overshoot by far more than the gaps between traced calls.
+ */
+void waitUntil(chrono::steady_clock::time_point due) {
+    const chrono::microseconds kSpinWindow(1000);
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    if (due - now > kSpinWindow) {
+        this_thread::sleep_for(due - now - kSpinWindow);
+    }
+    while (chrono::steady_clock::now() < due) {
+    }
+}
+
+/* Function: runReplay
+ * ------------------------------------------------------------
+ * Times the calls of a trace on a fresh queue and returns the
+ * number of calls made. Unless paced, the calls are made back
+ * to back; when paced, each call waits until its recorded time
+ * since the start of the trace, so that the queue sees the
+ * traffic as it arrived and only the latencies are meaningful.
+ * Adds to divergences each dequeue or peek whose answer differs
+ * from the recorded one, as happens when an engine breaks ties
+ * between equal priorities in another order.
+ */
+template <typename PQueue>
+long long runReplay(const OperationTraceReader& trace, bool paced, MeasuredPhase& phase,
+                    long long& divergences) {
+    PQueue queue;
+    long long answers = 0;
+    uint64_t dueNanos = 0;
+
+    LatencyProbe<PQueue>::clear();
+    phase.begin();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (long long i = 0; i < trace.size(); i++) {
+        const TraceRecord& record = trace.record(i);
+        if (paced) {
+            dueNanos += record.delayNanos;
+            waitUntil(start + chrono::nanoseconds(dueNanos));
+        }
+        switch (record.op) {
+        case TRACE_CLEAR:
+            queue.clear();
+            break;
+        case TRACE_DEQUEUE:
+            if (queue.dequeue() != trace.value(record.valueId)) divergences++;
+            break;
+        case TRACE_ENQUEUE:
+            queue.enqueue(trace.value(record.valueId), record.priority);
+            break;
+        case TRACE_IS_EMPTY:
+            answers += queue.isEmpty();
+            break;
+        case TRACE_PEEK:
+            if (queue.peek() != trace.value(record.valueId)) divergences++;
+            break;
+        case TRACE_PEEK_PRIORITY:
+            if ((int) queue.peekPriority() != record.priority) divergences++;
+            break;
+        case TRACE_SIZE:
+            answers += queue.size();
+            break;
+        default:
+            break;
+        }
+    }
+    phase.end();
+
+    /* Keeps the unchecked calls from being optimized away. */
+    if (answers < 0) cerr << answers;
+    return trace.operationCount();
+}
+
+/* Function: benchmark
+ * ------------------------------------------------------------
+ * Runs a workload repeat times on fresh queues of one type and
+ * keeps the fastest timing.
+ */
+template <typename PQueue>
+BenchResult benchmark(const string& queue, const string& workload,
+                      const Workload& input, const BenchConfig& config) {
+    bool replay = (workload == "replay");
+    BenchResult result;
+    result.queue = queue;
+    result.workload = workload;
+    result.distribution = replay ? "trace" : distributionName(input.distribution);
+    result.size = replay ? config.trace->peakSize() : input.values.size();
+    result.divergences = 0;
+    result.operations = 0;
+    result.seconds = 0;
+    result.hasLatencies = false;
+    result.hasPerf = (config.perf != NULL);
+    for (int i = 0; i < config.repeat; i++) {
+        MeasuredPhase phase(config.perf);
+        long long divergences = 0;
+        long long operations;
+        if (replay) {
+            operations = runReplay<PQueue>(*config.trace, config.pacedReplay, phase, divergences);
+        } else {
+            operations = runWorkload<PQueue>(workload, input, config.minOps, phase);
+        }
+        if (i == 0 || phase.seconds < result.seconds) {
+            result.divergences = divergences;
+            result.operations = operations;
+            result.seconds = phase.seconds;
+#ifdef PQUEUE_COUNT_OPERATIONS
+            result.counters = phase.counters;
+#endif
+            result.hasLatencies = LatencyProbe<PQueue>::collect(result.latencies);
+            for (int e = 0; e < PERF_EVENT_COUNT && result.hasPerf; e++) {
+                PerfEvent event = (PerfEvent) e;
+                result.perfCounts[e] = config.perf->available(event) ? config.perf->count(event) : -1;
+            }
+        }
+    }
+    return result;
+}
+
+/* Function: benchmarkQueue
+ * ------------------------------------------------------------
+ * Benchmarks a queue type, instrumenting it when latencies
+ * have been requested.
+ */
+template <typename PQueue>
+BenchResult benchmarkQueue(const string& queue, const string& workload,
+                           const Workload& input, const BenchConfig& config) {
+    if (config.latencyPath.empty()) {
+        return benchmark<PQueue>(queue, workload, input, config);
+    } else {
+        return benchmark<InstrumentedPriorityQueue<PQueue> >(queue, workload, input, config);
+    }
+}
+
+/* Function: runQueue
+ * ------------------------------------------------------------
+ * Dispatches a run to the queue class with the given name.
+ */
+BenchResult runQueue(const string& queue, const string& workload,
+                     const Workload& input, const BenchConfig& config) {
+    if (queue == "vector") {
+        return benchmarkQueue<VectorPriorityQueue>(queue, workload, input, config);
+    } else if (queue == "linked") {
+        return benchmarkQueue<LinkedPriorityQueue>(queue, workload, input, config);
+    } else if (queue == "unrolled") {
+        return benchmarkQueue<UnrolledLinkedPriorityQueue>(queue, workload, input, config);
+    } else if (queue == "heap") {
+        return benchmarkQueue<HeapPriorityQueue>(queue, workload, input, config);
+    } else if (queue == "binomial") {
+        return benchmarkQueue<BinomialHeapPriorityQueue>(queue, workload, input, config);
+    } else if (queue == "sorted") {
+        return benchmarkQueue<SortedArrayPriorityQueue>(queue, workload, input, config);
+    } else if (queue == "radix") {
+        return benchmarkQueue<RadixHeapPriorityQueue>(queue, workload, input, config);
+    } else if (queue == "adaptive") {
+        return benchmarkQueue<AdaptivePriorityQueue>(queue, workload, input, config);
+    } else if (queue == "small") {
+        return benchmarkQueue<SmallPriorityQueue<HeapPriorityQueue> >(queue, workload, input, config);
+    } else if (queue == "buffered") {
+        return benchmarkQueue<BufferedHeapPriorityQueue>(queue, workload, input, config);
+    } else if (queue == "lazy") {
+        return benchmarkQueue<LazyHeapPriorityQueue>(queue, workload, input, config);
+    } else if (queue == "indirect") {
+        return benchmarkQueue<IndirectHeapPriorityQueue>(queue, workload, input, config);
+    } else if (queue == "minmax") {
+        return benchmarkQueue<MinMaxHeapPriorityQueue>(queue, workload, input, config);
+    } else if (queue == "grouped") {
+        return benchmarkQueue<GroupedPriorityQueue>(queue, workload, input, config);
+    } else {
+        return benchmarkQueue<PriorityQueue<string> >(queue, workload, input, config);
+    }
+}
+
+/* Function: tryRunQueue
+ * ------------------------------------------------------------
+ * Runs like runQueue, but when a queue cannot run the workload,
+ * as the radix heap cannot when priorities are not monotone,
+ * notes it on standard error and returns false.
+ */
+bool tryRunQueue(const string& queue, const string& workload,
+                 const Workload& input, const BenchConfig& config, BenchResult& result) {
+    try {
+        result = runQueue(queue, workload, input, config);
+        return true;
+    } catch (ErrorException& ex) {
+        cerr << "skipping " << queue << " " << workload << ": " << ex.getMessage() << endl;
+        return false;
+    }
+}
+
+/* Function: isQuadratic
+ * ------------------------------------------------------------
+ * Returns whether the queue takes linear time per operation,
+ * so that runs at large sizes would take hours.
+ */
+bool isQuadratic(const string& queue) {
+    return queue == "vector" || queue == "linked" || queue == "unrolled" || queue == "sorted";
+}
+
+/* Function: nanosPerOp, opsPerSecond
+ * ------------------------------------------------------------
+ * Derived throughput figures for a result.
+ */
+double nanosPerOp(const BenchResult& result) {
+    return result.seconds * 1e9 / result.operations;
+}
+
+double opsPerSecond(const BenchResult& result) {
+    return result.seconds > 0 ? result.operations / result.seconds : 0;
+}
+
+/* Function: perOp
+ * ------------------------------------------------------------
+ * Divides a count over the operations of a result.
+ */
+double perOp(const BenchResult& result, unsigned long long count) {
+    return (double) count / result.operations;
+}
+
+/* Function: printCsvHeader, printCsv
+ * ------------------------------------------------------------
+ * Writes results as comma-separated rows. Builds that count
+ * operations add the counts per operation as extra columns.
+ */
+void printCsvHeader(const BenchConfig& config) {
+    cout << "queue,workload,distribution,size,operations,seconds,ns_per_op,ops_per_sec";
+#ifdef PQUEUE_COUNT_OPERATIONS
+    cout << ",comparisons_per_op,copies_per_op,moves_per_op,allocations_per_op,levels_per_op";
+#endif
+    for (int e = 0; e < PERF_EVENT_COUNT && config.perf != NULL; e++) {
+        cout << "," << PerfCounterGroup::eventName((PerfEvent) e) << "_per_op";
+    }
+    cout << endl;
+}
+
+void printCsv(const BenchResult& result) {
+    cout << result.queue << "," << result.workload << ","
+         << result.distribution << "," << result.size << ","
+         << result.operations << "," << result.seconds << ","
+         << nanosPerOp(result) << "," << opsPerSecond(result);
+#ifdef PQUEUE_COUNT_OPERATIONS
+    cout << "," << perOp(result, result.counters.comparisons)
+         << "," << perOp(result, result.counters.copies)
+         << "," << perOp(result, result.counters.moves)
+         << "," << perOp(result, result.counters.allocations)
+         << "," << perOp(result, result.counters.levels);
+#endif
+    for (int e = 0; e < PERF_EVENT_COUNT && result.hasPerf; e++) {
+        cout << ",";
+        if (result.perfCounts[e] >= 0) cout << result.perfCounts[e] / result.operations;
+    }
+    cout << endl;
+}
+
+/* Function: printJson
+ * ------------------------------------------------------------
+ * Writes one result as a JSON object.
+ */
+void printJson(const BenchResult& result, bool first) {
+    cout << (first ? "  " : ",\n  ")
+         << "{\"queue\": \"" << result.queue << "\", \"workload\": \"" << result.workload
+         << "\", \"distribution\": \"" << result.distribution
+         << "\", \"size\": " << result.size << ", \"operations\": " << result.operations
+         << ", \"seconds\": " << result.seconds << ", \"ns_per_op\": " << nanosPerOp(result)
+         << ", \"ops_per_sec\": " << opsPerSecond(result);
+#ifdef PQUEUE_COUNT_OPERATIONS
+    cout << ", \"comparisons_per_op\": " << perOp(result, result.counters.comparisons)
+         << ", \"copies_per_op\": " << perOp(result, result.counters.copies)
+         << ", \"moves_per_op\": " << perOp(result, result.counters.moves)
+         << ", \"allocations_per_op\": " << perOp(result, result.counters.allocations)
+         << ", \"levels_per_op\": " << perOp(result, result.counters.levels);
+#endif
+    for (int e = 0; e < PERF_EVENT_COUNT && result.hasPerf; e++) {
+        cout << ", \"" << PerfCounterGroup::eventName((PerfEvent) e) << "_per_op\": ";
+        if (result.perfCounts[e] >= 0) {
+            cout << result.perfCounts[e] / result.operations;
+        } else {
+            cout << "null";
+        }
+    }
+    cout << "}";
+}
+
+/* Function: printLatencyCsvHeader, printLatencyCsv, printLatencyJson
+ * ------------------------------------------------------------
+ * Write the latency percentiles of each method called during a
+ * run, in nanoseconds, one row or object per method.
+ */
+void printLatencyCsvHeader(ostream& out) {
+    out << "queue,workload,distribution,size,method,calls,p50_ns,p99_ns,p999_ns,max_ns" << endl;
+}
+
+void printLatencyCsv(ostream& out, const BenchResult& result) {
+    double scale = LatencyHistogram::nanosPerTick();
+    for (int i = 0; i < LATENCY_OP_COUNT; i++) {
+        const LatencyHistogram& histogram = result.latencies.ops[i];
+        if (histogram.count() == 0) continue;
+        out << result.queue << "," << result.workload << ","
+            << result.distribution << "," << result.size << ","
+            << latencyOpName((LatencyOp) i) << "," << histogram.count() << ","
+            << histogram.percentileTicks(50) * scale << ","
+            << histogram.percentileTicks(99) * scale << ","
+            << histogram.percentileTicks(99.9) * scale << ","
+            << histogram.maxTicks() * scale << endl;
+    }
+}
+
+void printLatencyJson(ostream& out, const BenchResult& result, bool& first) {
+    double scale = LatencyHistogram::nanosPerTick();
+    for (int i = 0; i < LATENCY_OP_COUNT; i++) {
+        const LatencyHistogram& histogram = result.latencies.ops[i];
+        if (histogram.count() == 0) continue;
+        out << (first ? "  " : ",\n  ")
+            << "{\"queue\": \"" << result.queue << "\", \"workload\": \"" << result.workload
+            << "\", \"distribution\": \"" << result.distribution
+            << "\", \"size\": " << result.size << ", \"method\": \"" << latencyOpName((LatencyOp) i)
+            << "\", \"calls\": " << histogram.count()
+            << ", \"p50_ns\": " << histogram.percentileTicks(50) * scale
+            << ", \"p99_ns\": " << histogram.percentileTicks(99) * scale
+            << ", \"p999_ns\": " << histogram.percentileTicks(99.9) * scale
+            << ", \"max_ns\": " << histogram.maxTicks() * scale << "}";
+        first = false;
+    }
+}
+
+/* Function: report
+ * ------------------------------------------------------------
+ * Writes a result in the chosen format, along with its latencies
+ * when they were measured, and notes on standard error how often
+ * a replay diverged from its trace.
+ */
+void report(const BenchResult& result, const BenchConfig& config, ostream& latencyFile,
+            bool& first, bool& firstLatency) {
+    if (config.format == "csv") {
+        printCsv(result);
+    } else {
+        printJson(result, first);
+    }
+    first = false;
+    if (result.hasLatencies) {
+        if (config.format == "csv") {
+            printLatencyCsv(latencyFile, result);
+        } else {
+            printLatencyJson(latencyFile, result, firstLatency);
+        }
+    }
+    if (result.divergences > 0) {
+        cerr << result.queue << " answered " << result.divergences
+             << " dequeues or peeks differently than the traced queue" << endl;
+    }
+}
+
+/* Function: printUsage
+ * ------------------------------------------------------------
+ * Describes the command-line options.
+ */
+void printUsage() {
+    cerr << "Usage: pqueue-bench [options]" << endl
+         << "  --queues=LIST          any of " << kAllQueues << " (default "
+         << kDefaultQueues << ")" << endl
+         << "  --workloads=LIST       any of " << kAllWorkloads << endl
+         << "  --distributions=LIST   priority patterns, any of " << kAllDistributions
+         << " (default " << kDefaultDistributions << ")" << endl
+         << "  --sizes=LIST           queue sizes, such as 10,1e3,1e6 (default "
+         << kDefaultSizes << ")" << endl
+         << "  --mix=PERCENT          share of enqueues in the mixed workload (default "
+         << kDefaultMixPercent << ")" << endl
+         << "  --repeat=N             timings per run, the fastest is kept (default "
+         << kDefaultRepeat << ")" << endl
+         << "  --min-ops=N            operations measured per timing (default "
+         << kDefaultMinOps << ")" << endl
+         << "  --quadratic-limit=N    largest size run on the linear-time queues (default "
+         << kDefaultQuadraticLimit << ")" << endl
+         << "  --seed=N               random seed (default " << kDefaultSeed << ")" << endl
+         << "  --format=csv|json      output format (default csv)" << endl
+         << "  --latency=FILE         also write per-call latency percentiles to FILE" << endl
+         << "  --perf                 count hardware events per operation with perf_event_open" << endl
+         << "  --replay=TRACE         replay a trace recorded by TracingPriorityQueue against"
+         << " each queue, instead of the workloads" << endl
+         << "  --pacing=full|recorded replay back to back, or at the recorded pace, where only"
+         << " --latency is meaningful (default full)" << endl
+         << "  --thresholds=LIST      crossovers for the adaptive queue, any of small, draining,"
+         << " draining-share, external, sample and stable, such as small=64,draining=2048" << endl
+         << "  --calibrate            measure the adaptive queue's crossovers on this machine"
+         << " and print them as a --thresholds option" << endl
+         << "  --tie-break=POLICY     order equal priorities by value (lexicographic), fifo or none"
+         << " (default lexicographic)" << endl;
+}
+
+/* Function: splitList
+ * ------------------------------------------------------------
+ * Splits a comma-separated option value.
+ */
+Vector<string> splitList(const string& list) {
+    Vector<string> items;
+    for (const string& item : stringSplit(list, ",")) {
+        if (!item.empty()) items.add(trim(item));
+    }
+    return items;
+}
+
+/* Function: parseCount
+ * ------------------------------------------------------------
+ * Parses a positive count, allowing forms such as 1e6.
+ */
+int parseCount(const string& text) {
+    double count = stringToReal(text);
+    if (count < 1 || count > 1e9) error("count out of range: " + text);
+    return (int) count;
+}
+
+/* Function: fasterThanHeap
+ * ------------------------------------------------------------
+ * Returns whether the sorted array runs a mixed workload of the
+ * given size and share of enqueues at least as fast as the heap.
+ */
+bool fasterThanHeap(int size, int mixPercent, const BenchConfig& config) {
+    Workload input;
+    generateWorkload(input, DIST_UNIFORM, size, mixPercent, config.seed);
+    BenchResult sorted = benchmark<SortedArrayPriorityQueue>("sorted", "mixed", input, config);
+    BenchResult heap = benchmark<HeapPriorityQueue>("heap", "mixed", input, config);
+    return sorted.seconds / sorted.operations <= heap.seconds / heap.operations;
+}
+
+/* Function: calibrateThresholds
+ * ------------------------------------------------------------
+ * Measures where the sorted array stops beating the heap on this
+ * machine, doubling the size until it loses, both for a balanced
+ * mix and for a queue being drained, and returns the adaptive
+ * queue's thresholds with those crossovers filled in.
+ */
+AdaptiveThresholds calibrateThresholds(const BenchConfig& config) {
+    AdaptiveThresholds thresholds = config.thresholds;
+    const int kLargestSize = 1 << 16;
+    int drainingPercent = (int) (thresholds.drainingEnqueueShare * 100);
+    thresholds.smallSize = 1;
+    for (int size = 2; size <= kLargestSize && fasterThanHeap(size, 50, config); size *= 2) {
+        thresholds.smallSize = size;
+    }
+    thresholds.drainingSize = thresholds.smallSize;
+    for (int size = 2; size <= kLargestSize && fasterThanHeap(size, drainingPercent, config); size *= 2) {
+        thresholds.drainingSize = max(thresholds.drainingSize, size);
+    }
+    return thresholds;
+}
+
+/* Function: thresholdsString
+ * ------------------------------------------------------------
+ * Formats adaptive thresholds as a --thresholds option value.
+ */
+string thresholdsString(const AdaptiveThresholds& thresholds) {
+    return "small=" + integerToString(thresholds.smallSize)
+         + ",draining=" + integerToString(thresholds.drainingSize)
+         + ",draining-share=" + realToString(thresholds.drainingEnqueueShare)
+         + ",external=" + integerToString(thresholds.externalSize)
+         + ",sample=" + integerToString(thresholds.sampleInterval)
+         + ",stable=" + integerToString(thresholds.stableSamples);
+}
+
+/* Function: parseThresholds
+ * ------------------------------------------------------------
+ * Reads a --thresholds option value, such as small=64,draining=2048,
+ * over the defaults. Signals an error for unknown names.
+ */
+AdaptiveThresholds parseThresholds(const string& text) {
+    AdaptiveThresholds thresholds;
+    for (const string& item : splitList(text)) {
+        size_t equals = item.find('=');
+        string name = item.substr(0, equals);
+        string value = (equals == string::npos) ? "" : item.substr(equals + 1);
+        if (name == "small") {
+            thresholds.smallSize = parseCount(value);
+        } else if (name == "draining") {
+            thresholds.drainingSize = parseCount(value);
+        } else if (name == "draining-share") {
+            thresholds.drainingEnqueueShare = stringToReal(value);
+        } else if (name == "external") {
+            thresholds.externalSize = parseCount(value);
+        } else if (name == "sample") {
+            thresholds.sampleInterval = parseCount(value);
+        } else if (name == "stable") {
+            thresholds.stableSamples = parseCount(value);
+        } else {
+            error("unknown threshold " + name);
+        }
+    }
+    return thresholds;
+}
+
+/* Function: parseArguments
+ * ------------------------------------------------------------
+ * Reads the command line into a BenchConfig. Signals an error
+ * for unknown options or values.
+ */
+BenchConfig parseArguments(int argc, char **argv) {
+    BenchConfig config;
+    config.queues = splitList(kDefaultQueues);
+    config.workloads = splitList(kAllWorkloads);
+    string sizes = kDefaultSizes;
+    string distributions = kDefaultDistributions;
+    config.mixPercent = kDefaultMixPercent;
+    config.repeat = kDefaultRepeat;
+    config.minOps = kDefaultMinOps;
+    config.quadraticLimit = kDefaultQuadraticLimit;
+    config.seed = kDefaultSeed;
+    config.format = "csv";
+    config.perf = NULL;
+    config.trace = NULL;
+    config.pacedReplay = false;
+    config.calibrate = false;
+    config.tieBreak = TIE_BREAK_LEXICOGRAPHIC;
+    bool perf = false;
+    string tracePath;
+    string pacing = "full";
+
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        size_t equals = argument.find('=');
+        string name = argument.substr(0, equals);
+        string value = (equals == string::npos) ? "" : argument.substr(equals + 1);
+        if (name == "--queues") {
+            config.queues = splitList(value);
+        } else if (name == "--workloads") {
+            config.workloads = splitList(value);
+        } else if (name == "--distributions") {
+            distributions = value;
+        } else if (name == "--sizes") {
+            sizes = value;
+        } else if (name == "--mix") {
+            config.mixPercent = stringToInteger(value);
+        } else if (name == "--repeat") {
+            config.repeat = parseCount(value);
+        } else if (name == "--min-ops") {
+            config.minOps = parseCount(value);
+        } else if (name == "--quadratic-limit") {
+            config.quadraticLimit = parseCount(value);
+        } else if (name == "--seed") {
+            config.seed = stringToInteger(value);
+        } else if (name == "--format") {
+            config.format = value;
+        } else if (name == "--perf") {
+            perf = true;
+        } else if (name == "--latency") {
+            if (value.empty()) error("--latency needs a file name");
+            config.latencyPath = value;
+        } else if (name == "--replay") {
+            if (value.empty()) error("--replay needs a trace file name");
+            tracePath = value;
+        } else if (name == "--pacing") {
+            pacing = value;
+        } else if (name == "--thresholds") {
+            config.thresholds = parseThresholds(value);
+        } else if (name == "--calibrate") {
+            config.calibrate = true;
+        } else if (name == "--tie-break") {
+            if (value == "lexicographic") {
+                config.tieBreak = TIE_BREAK_LEXICOGRAPHIC;
+            } else if (value == "fifo") {
+                config.tieBreak = TIE_BREAK_FIFO;
+            } else if (value == "none") {
+                config.tieBreak = TIE_BREAK_NONE;
+            } else {
+                error("unknown tie-break " + value);
+            }
+        } else {
+            error("unknown option " + argument);
+        }
+    }
+
+    for (const string& distribution : splitList(distributions)) {
+        config.distributions.add(distributionNamed(distribution));
+    }
+    for (const string& size : splitList(sizes)) {
+        config.sizes.add(parseCount(size));
+    }
+    for (const string& queue : config.queues) {
+        if (!stringContains("," + kAllQueues + ",", "," + queue + ",")) {
+            error("unknown queue " + queue);
+        }
+    }
+    for (const string& workload : config.workloads) {
+        if (!stringContains("," + kAllWorkloads + ",", "," + workload + ",")) {
+            error("unknown workload " + workload);
+        }
+    }
+    if (config.mixPercent < 0 || config.mixPercent > 100) error("mix must be a percentage");
+    if (config.format != "csv" && config.format != "json") error("unknown format " + config.format);
+    if (pacing != "full" && pacing != "recorded") error("unknown pacing " + pacing);
+    config.pacedReplay = (pacing == "recorded");
+    if (perf) config.perf = new PerfCounterGroup;
+    if (!tracePath.empty()) config.trace = new OperationTraceReader(tracePath);
+    return config;
+}
+
+/* Main program */
+
+int main(int argc, char **argv) {
+    if (argc == 2 && string(argv[1]) == "--help") {
+        printUsage();
+        return EXIT_SUCCESS;
+    }
+    BenchConfig config;
+    try {
+        config = parseArguments(argc, argv);
+    } catch (ErrorException& ex) {
+        cerr << "pqueue-bench: " << ex.getMessage() << endl;
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    ofstream latencyFile;
+    if (!config.latencyPath.empty()) {
+        latencyFile.open(config.latencyPath.c_str());
+        if (!latencyFile) {
+            cerr << "pqueue-bench: cannot write " << config.latencyPath << endl;
+            return EXIT_FAILURE;
+        }
+        latencyFile << setprecision(6);
+        if (config.format == "csv") {
+            printLatencyCsvHeader(latencyFile);
+        } else {
+            latencyFile << "[" << endl;
+        }
+    }
+
+    AdaptivePriorityQueue::setDefaultThresholds(config.thresholds);
+    setTieBreakPolicy(config.tieBreak);
+    if (config.calibrate) {
+        cout << "--thresholds=" << thresholdsString(calibrateThresholds(config)) << endl;
+        delete config.perf;
+        delete config.trace;
+        return EXIT_SUCCESS;
+    }
+
+    if (config.perf != NULL && !config.perf->anyAvailable()) {
+        cerr << "pqueue-bench: hardware counters are unavailable here "
+             << "(perf_event_open failed); their columns are left empty" << endl;
+    }
+
+    cout << setprecision(6);
+    if (config.format == "csv") {
+        printCsvHeader(config);
+    } else {
+        cout << "[" << endl;
+    }
+    bool first = true;
+    bool firstLatency = true;
+    Workload input;
+    if (config.trace != NULL) {
+        config.sizes.clear();
+        for (const string& queue : config.queues) {
+            if (isQuadratic(queue) && config.trace->peakSize() > config.quadraticLimit) {
+                cerr << "skipping " << queue << " replay (above --quadratic-limit)" << endl;
+                continue;
+            }
+            BenchResult result;
+            if (!tryRunQueue(queue, "replay", input, config, result)) continue;
+            report(result, config, latencyFile, first, firstLatency);
+        }
+    }
+    for (int size : config.sizes) {
+        for (WorkloadDistribution distribution : config.distributions) {
+            generateWorkload(input, distribution, size, config.mixPercent, config.seed);
+            for (const string& workload : config.workloads) {
+                for (const string& queue : config.queues) {
+                    if (isQuadratic(queue) && size > config.quadraticLimit) {
+                        cerr << "skipping " << queue << " " << workload << " at size " << size
+                             << " (above --quadratic-limit)" << endl;
+                        continue;
+                    }
+                    BenchResult result;
+                    if (!tryRunQueue(queue, workload, input, config, result)) continue;
+                    report(result, config, latencyFile, first, firstLatency);
+                }
+            }
+        }
+    }
+    if (config.format == "json") {
+        cout << endl << "]" << endl;
+        if (latencyFile.is_open()) latencyFile << endl << "]" << endl;
+    }
+    delete config.perf;
+    delete config.trace;
+    return EXIT_SUCCESS;
+}
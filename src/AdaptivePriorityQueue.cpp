@@ -0,0 +1,300 @@
+/*
+ *  File: AdaptivePriorityQueue.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the AdaptivePriorityQueue and
+ *  the engines it switches between.
+ */
+
+#include "AdaptivePriorityQueue.h"
+#include <algorithm>  // for max
+#include <utility>    // for move
+#include "ExternalPriorityQueue.h"
+#include "HeapPriorityQueue.h"
+#include "RadixHeapPriorityQueue.h"
+#include "SortedArrayPriorityQueue.h"
+
+/*
+ *  Class: AdaptiveEngine
+ *  - - - - - - - - - - - - - - -
+ *  The common interface of the engines, so the adaptive
+ *  queue can swap one for another at run time.
+ */
+class AdaptiveEngine {
+public:
+    virtual ~AdaptiveEngine() {}
+    virtual bool accepts(int priority) const = 0;
+    virtual void clear() = 0;
+    virtual string dequeue() = 0;
+    virtual void enqueue(string value, int priority) = 0;
+    virtual bool isEmpty() const = 0;
+    virtual string peek() const = 0;
+    virtual int peekPriority() const = 0;
+    virtual int size() const = 0;
+    virtual bool tryDequeue(string& value) = 0;
+    virtual const string* tryPeek() const = 0;
+    virtual bool tryPeekPriority(int& priority) const = 0;
+};
+
+/*
+ *  Class: AdaptiveEngineFor
+ *  - - - - - - - - - - - - - - -
+ *  Adapts a queue of type PQueue to the engine interface.
+ *  Every queue but the radix heap accepts any priority.
+ */
+template <typename PQueue>
+class AdaptiveEngineFor : public AdaptiveEngine {
+public:
+    bool accepts(int) const {
+        return true;
+    }
+
+    void clear() {
+        queue.clear();
+    }
+
+    string dequeue() {
+        return queue.dequeue();
+    }
+
+    void enqueue(string value, int priority) {
+        queue.enqueue(std::move(value), priority);
+    }
+
+    bool isEmpty() const {
+        return queue.isEmpty();
+    }
+
+    string peek() const {
+        return queue.peek();
+    }
+
+    int peekPriority() const {
+        return queue.peekPriority();
+    }
+
+    int size() const {
+        return queue.size();
+    }
+
+    bool tryDequeue(string& value) {
+        return queue.tryDequeue(value);
+    }
+
+    const string* tryPeek() const {
+        return queue.tryPeek();
+    }
+
+    bool tryPeekPriority(int& priority) const {
+        return queue.tryPeekPriority(priority);
+    }
+
+private:
+    PQueue queue;
+};
+
+template <>
+bool AdaptiveEngineFor<RadixHeapPriorityQueue>::accepts(int priority) const {
+    return queue.accepts(priority);
+}
+
+/*
+ *  Function: newEngine
+ *  Parameters: AdaptiveEngineKind kind
+ *              TieBreakPolicy policy
+ *  - - - - - - - - - - - - - - - - - -
+ *  Returns a new, empty engine of the given kind that
+ *  breaks ties by the given policy.
+ */
+static AdaptiveEngine *newEngine(AdaptiveEngineKind kind, TieBreakPolicy policy) {
+    TieBreakScope scope(policy);
+    switch(kind) {
+        case ENGINE_SORTED_ARRAY: return new AdaptiveEngineFor<SortedArrayPriorityQueue>;
+        case ENGINE_RADIX_HEAP: return new AdaptiveEngineFor<RadixHeapPriorityQueue>;
+        case ENGINE_EXTERNAL: return new AdaptiveEngineFor<ExternalPriorityQueue>;
+        default: return new AdaptiveEngineFor<HeapPriorityQueue>;
+    }
+}
+
+AdaptiveThresholds::AdaptiveThresholds() {
+    smallSize = 32;
+    drainingSize = 1024;
+    drainingEnqueueShare = 0.1;
+    externalSize = 1 << 24;
+    sampleInterval = 1024;
+    stableSamples = 2;
+}
+
+AdaptivePriorityQueue::AdaptivePriorityQueue() {
+    thresholds = defaultThresholds();
+    policy = getTieBreakPolicy();
+    current = newEngine(ENGINE_SORTED_ARRAY, policy);
+    currentKind = ENGINE_SORTED_ARRAY;
+    migrationCount = 0;
+    clear();
+}
+
+AdaptivePriorityQueue::AdaptivePriorityQueue(const AdaptiveThresholds& thresholds) {
+    this->thresholds = thresholds;
+    policy = getTieBreakPolicy();
+    current = newEngine(ENGINE_SORTED_ARRAY, policy);
+    currentKind = ENGINE_SORTED_ARRAY;
+    migrationCount = 0;
+    clear();
+}
+
+AdaptivePriorityQueue::~AdaptivePriorityQueue() {
+    delete current;
+}
+
+void AdaptivePriorityQueue::clear() {
+    current->clear();
+    sampleEnqueues = 0;
+    sampleDequeues = 0;
+    sampleMonotone = 0;
+    hasFloor = false;
+    floorPriority = 0;
+    proposedKind = currentKind;
+    proposedSamples = 0;
+}
+
+string AdaptivePriorityQueue::dequeue() {
+    string value;
+    if(!tryDequeue(value)) error("The queue is empty");
+    return value;
+}
+
+void AdaptivePriorityQueue::enqueue(string value, int priority) {
+    if(current->isEmpty()) hasFloor = false;
+    if(!hasFloor || priority >= floorPriority) sampleMonotone++;
+    if(!current->accepts(priority)) migrate(ENGINE_HEAP);
+    current->enqueue(std::move(value), priority);
+    sampleEnqueues++;
+    sampled();
+}
+
+bool AdaptivePriorityQueue::isEmpty() const {
+    return current->isEmpty();
+}
+
+string AdaptivePriorityQueue::peek() const {
+    const string *value = tryPeek();
+    if(value == NULL) error("The queue is empty");
+    return *value;
+}
+
+int AdaptivePriorityQueue::peekPriority() const {
+    int priority = 0;
+    if(!tryPeekPriority(priority)) error("The queue is empty");
+    return priority;
+}
+
+int AdaptivePriorityQueue::size() const {
+    return current->size();
+}
+
+bool AdaptivePriorityQueue::tryDequeue(string& value) {
+    int priority = 0;
+    if(!current->tryPeekPriority(priority)) return false;
+    hasFloor = true;
+    floorPriority = priority;
+    current->tryDequeue(value);
+    sampleDequeues++;
+    sampled();
+    return true;
+}
+
+const string* AdaptivePriorityQueue::tryPeek() const {
+    return current->tryPeek();
+}
+
+bool AdaptivePriorityQueue::tryPeekPriority(int& priority) const {
+    return current->tryPeekPriority(priority);
+}
+
+AdaptiveEngineKind AdaptivePriorityQueue::engine() const {
+    return currentKind;
+}
+
+int AdaptivePriorityQueue::migrations() const {
+    return migrationCount;
+}
+
+string AdaptivePriorityQueue::engineName(AdaptiveEngineKind kind) {
+    switch(kind) {
+        case ENGINE_SORTED_ARRAY: return "sorted";
+        case ENGINE_HEAP: return "heap";
+        case ENGINE_RADIX_HEAP: return "radix";
+        case ENGINE_EXTERNAL: return "external";
+        default: return "unknown";
+    }
+}
+
+void AdaptivePriorityQueue::setDefaultThresholds(const AdaptiveThresholds& thresholds) {
+    defaultThresholds() = thresholds;
+}
+
+AdaptiveThresholds& AdaptivePriorityQueue::defaultThresholds() {
+    static AdaptiveThresholds thresholds;
+    return thresholds;
+}
+
+AdaptiveEngineKind AdaptivePriorityQueue::chooseEngine() const {
+    int queueSize = current->size();
+    int operations = sampleEnqueues + sampleDequeues;
+    bool draining = sampleEnqueues <= thresholds.drainingEnqueueShare * operations;
+    bool monotone = sampleMonotone == sampleEnqueues;
+
+    if(queueSize >= thresholds.externalSize) return ENGINE_EXTERNAL;
+    if(queueSize <= thresholds.smallSize) return ENGINE_SORTED_ARRAY;
+    if(draining && queueSize <= thresholds.drainingSize) return ENGINE_SORTED_ARRAY;
+    /*
+     *  A sample of nothing but dequeues says nothing about
+     *  monotonicity, so it leaves a radix heap in place.
+     */
+    if(monotone && (sampleEnqueues > 0 || currentKind == ENGINE_RADIX_HEAP)) return ENGINE_RADIX_HEAP;
+    return ENGINE_HEAP;
+}
+
+void AdaptivePriorityQueue::migrate(AdaptiveEngineKind kind) {
+    if(kind == currentKind) return;
+    AdaptiveEngine *next = newEngine(kind, policy);
+    while(!current->isEmpty()) {
+        int priority = current->peekPriority();
+        next->enqueue(current->dequeue(), priority);
+    }
+    delete current;
+    current = next;
+    currentKind = kind;
+    migrationCount++;
+    proposedKind = kind;
+    proposedSamples = 0;
+}
+
+void AdaptivePriorityQueue::sampled() {
+    /*
+     *  A sorted array that has grown well past its threshold
+     *  would make every further enqueue of the sample slow,
+     *  so it does not wait for the sample to end.
+     */
+    int sortedLimit = thresholds.smallSize;
+    if(sampleEnqueues <= thresholds.drainingEnqueueShare * (sampleEnqueues + sampleDequeues)) {
+        sortedLimit = max(sortedLimit, thresholds.drainingSize);
+    }
+    bool overgrown = currentKind == ENGINE_SORTED_ARRAY && current->size() > 2 * sortedLimit;
+    if(sampleEnqueues + sampleDequeues < thresholds.sampleInterval && !overgrown) return;
+
+    AdaptiveEngineKind kind = chooseEngine();
+    sampleEnqueues = 0;
+    sampleDequeues = 0;
+    sampleMonotone = 0;
+    if(kind == currentKind) {
+        proposedSamples = 0;
+    } else if(overgrown) {
+        migrate(kind);
+    } else {
+        if(kind != proposedKind) proposedSamples = 0;
+        proposedKind = kind;
+        proposedSamples++;
+        if(proposedSamples >= thresholds.stableSamples) migrate(kind);
+    }
+}
@@ -0,0 +1,233 @@
+/*
+ *  File: AdaptivePriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the AdaptivePriorityQueue, which
+ *  watches how it is used and moves its contents to
+ *  whichever of the other queues suits its current
+ *  phase best.
+ */
+
+#ifndef _adaptivepriorityqueue_h
+#define _adaptivepriorityqueue_h
+
+#include <iostream>
+#include <string>
+#include "PQEntry.h"
+#include "error.h"
+using namespace std;
+
+class AdaptiveEngine;
+
+/*
+ *  Enum: AdaptiveEngineKind
+ *  - - - - - - - - - - - - - - -
+ *  The queues an AdaptivePriorityQueue can hold its
+ *  entries in:
+ *
+ *  ENGINE_SORTED_ARRAY  - SortedArrayPriorityQueue, for small
+ *                         queues and queues being drained
+ *  ENGINE_HEAP          - HeapPriorityQueue, the general case
+ *  ENGINE_RADIX_HEAP    - RadixHeapPriorityQueue, while no
+ *                         entry is enqueued ahead of the front
+ *  ENGINE_EXTERNAL      - ExternalPriorityQueue, for backlogs
+ *                         too large to keep in memory, spilling
+ *                         to the working directory
+ */
+enum AdaptiveEngineKind {
+    ENGINE_SORTED_ARRAY,
+    ENGINE_HEAP,
+    ENGINE_RADIX_HEAP,
+    ENGINE_EXTERNAL,
+    ENGINE_KIND_COUNT
+};
+
+/*
+ *  Struct: AdaptiveThresholds
+ *  - - - - - - - - - - - - - - -
+ *  The crossover points at which an AdaptivePriorityQueue
+ *  changes engine. The defaults suit a typical desktop CPU;
+ *  pqueue-bench --calibrate measures the first three for
+ *  the machine it runs on.
+ *
+ *  smallSize            - queues this size or smaller use
+ *                         the sorted array
+ *  drainingSize         - queues this size or smaller use the
+ *                         sorted array while being drained
+ *  drainingEnqueueShare - the share of enqueues in a sample
+ *                         at or below which the queue counts
+ *                         as being drained
+ *  externalSize         - queues this size or larger spill to
+ *                         external memory
+ *  sampleInterval       - enqueues and dequeues per sample
+ *  stableSamples        - consecutive samples that must agree
+ *                         on a new engine before migrating, so
+ *                         a queue near a threshold does not
+ *                         migrate back and forth
+ */
+struct AdaptiveThresholds {
+    AdaptiveThresholds();
+
+    int smallSize;
+    int drainingSize;
+    double drainingEnqueueShare;
+    int externalSize;
+    int sampleInterval;
+    int stableSamples;
+};
+
+/*
+ *  Class: AdaptivePriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class forwards each operation to one engine and,
+ *  every sampleInterval enqueues and dequeues, looks at
+ *  the queue's size, the share of enqueues in the sample
+ *  and whether every enqueue in it was monotone, that is,
+ *  no more urgent than the last entry dequeued. From these
+ *  it picks the engine best suited to the queue's phase:
+ *
+ *  - externalSize entries or more: ENGINE_EXTERNAL
+ *  - smallSize entries or fewer, or drainingSize or fewer
+ *    while draining: ENGINE_SORTED_ARRAY
+ *  - all enqueues monotone: ENGINE_RADIX_HEAP
+ *  - otherwise: ENGINE_HEAP
+ *
+ *  and migrates the contents by dequeueing them from the
+ *  old engine into the new one. Since migrating costs a
+ *  full drain, it only happens once stableSamples samples
+ *  in a row agree. An enqueue that the radix heap cannot
+ *  accept migrates to the binary heap at once.
+ */
+class AdaptivePriorityQueue {
+public:
+    /*
+     *  Constructor: AdaptivePriorityQueue
+     *  Parameters: const AdaptiveThresholds& thresholds
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes an empty queue in the sorted array,
+     *  using the given thresholds or the defaults set
+     *  with setDefaultThresholds.
+     */
+    AdaptivePriorityQueue();
+    AdaptivePriorityQueue(const AdaptiveThresholds& thresholds);
+
+    /*
+     *  Destructor: ~AdaptivePriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Frees the current engine.
+     */
+    ~AdaptivePriorityQueue();
+
+    /*
+     *  Methods: clear, dequeue, enqueue, isEmpty,
+     *           peek, peekPriority, size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Forward to the current engine. Enqueues and dequeues
+     *  are sampled and may migrate the queue to another engine.
+     */
+    void clear();
+    string dequeue();
+    void enqueue(string value, int priority);
+    bool isEmpty() const;
+    string peek() const;
+    int peekPriority() const;
+    int size() const;
+
+    /*
+     *  Methods: tryDequeue, tryPeek, tryPeekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Work as dequeue, peek and peekPriority, but on an empty
+     *  queue return false or NULL instead of throwing. A
+     *  successful tryDequeue is sampled like a dequeue. tryPeek
+     *  returns a pointer to the value, good until the queue is
+     *  next changed.
+     */
+    bool tryDequeue(string& value);
+    const string* tryPeek() const;
+    bool tryPeekPriority(int& priority) const;
+
+    /*
+     *  Method: engine
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the kind of engine currently holding the entries.
+     */
+    AdaptiveEngineKind engine() const;
+
+    /*
+     *  Method: migrations
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns how many times the queue has changed engine.
+     */
+    int migrations() const;
+
+    /*
+     *  Method: engineName
+     *  Parameters: AdaptiveEngineKind kind
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns a short name for an engine, such as "heap".
+     */
+    static string engineName(AdaptiveEngineKind kind);
+
+    /*
+     *  Method: setDefaultThresholds
+     *  Parameters: const AdaptiveThresholds& thresholds
+     *  - - - - - - - - - - - - - - - - - -
+     *  Sets the thresholds used by queues constructed without
+     *  any, so that calibrated values apply to every queue.
+     */
+    static void setDefaultThresholds(const AdaptiveThresholds& thresholds);
+
+private:
+    AdaptivePriorityQueue(const AdaptivePriorityQueue& other);
+    AdaptivePriorityQueue& operator =(const AdaptivePriorityQueue& other);
+
+    /*
+     *  Method: chooseEngine
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the engine suited to the sample just ended.
+     */
+    AdaptiveEngineKind chooseEngine() const;
+
+    /*
+     *  Method: migrate
+     *  Parameters: AdaptiveEngineKind kind
+     *  - - - - - - - - - - - - - - - - - -
+     *  Moves every entry into a new engine of the given kind.
+     */
+    void migrate(AdaptiveEngineKind kind);
+
+    /*
+     *  Method: sampled
+     *  - - - - - - - - - - - - - - - - - -
+     *  Called after every enqueue and dequeue to end the
+     *  sample once it is full and act on it.
+     */
+    void sampled();
+
+    /*
+     *  Method: defaultThresholds
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the thresholds set by setDefaultThresholds.
+     */
+    static AdaptiveThresholds& defaultThresholds();
+
+    AdaptiveThresholds thresholds;
+    AdaptiveEngine *current;
+    AdaptiveEngineKind currentKind;
+    int migrationCount;
+    TieBreakPolicy policy;
+
+    /*
+     *  The current sample: its enqueues and dequeues, how many
+     *  of the enqueues were monotone, the priority of the last
+     *  entry dequeued, and the engine the last samples chose.
+     */
+    int sampleEnqueues;
+    int sampleDequeues;
+    int sampleMonotone;
+    bool hasFloor;
+    int floorPriority;
+    AdaptiveEngineKind proposedKind;
+    int proposedSamples;
+};
+
+#endif
@@ -8,39 +8,42 @@
  */
 
 #include "BinomialHeapPriorityQueue.h"
+#include <utility>    // for move
 
-BinomialHeapPriorityQueue::BinomialHeapPriorityQueue() {
-
+BinomialHeapPriorityQueue::BinomialHeapPriorityQueue(MemoryResource *resource)
+    : heap(NodeAllocator(resource)) {
+    this->resource = resource;
+    policy = getTieBreakPolicy();
+    enqueueCount = 0;
 }
 
 BinomialHeapPriorityQueue::~BinomialHeapPriorityQueue() {
-
+    clear();
 }
 
 void BinomialHeapPriorityQueue::clear() {
+    for(int i = 0; i < (int) heap.size(); i++) {
+        deleteTree(heap[i]);
+    }
     heap.clear();
 }
 
 string BinomialHeapPriorityQueue::dequeue() {
-    if(heap.size() == 0) error("The queue is empty");
-    int dequeuedRootIndex = 0;
-    BinomialHeapNode* dequeuedRoot = NULL;
-    getDequeuedRoot(dequeuedRoot, dequeuedRootIndex);
-    string value = dequeuedRoot->entry.value;
-    Vector<BinomialHeapNode *> orphanedChildren = heap[dequeuedRootIndex]->children;
-    heap.remove(dequeuedRootIndex);
-    merge(orphanedChildren, heap);
+    string value;
+    if(!tryDequeue(value)) error("The queue is empty");
     return value;
 }
 
-void BinomialHeapPriorityQueue::enqueue(string value, int priority) {
-    Vector<BinomialHeapNode* > newHeap;
-    BinomialHeapNode* newTree = new BinomialHeapNode;
-    PQEntry newNode = {value, priority};
-    Vector<BinomialHeapNode* > newChildren;
-    newTree->entry = newNode;
-    newTree->children;
-    newHeap.add(newTree);
+void BinomialHeapPriorityQueue::enqueue(const string& value, int priority) {
+    enqueue(string(value), priority);
+}
+
+void BinomialHeapPriorityQueue::enqueue(string&& value, int priority) {
+    NodeVector newHeap(heap.get_allocator());
+    BinomialHeapNode* newTree = newObject<BinomialHeapNode>(resource, resource);
+    PQ_COUNT(allocations);
+    newTree->entry = PQEntry(std::move(value), priority, policy, enqueueCount++);
+    newHeap.push_back(newTree);
     merge(newHeap, heap);
 }
 
@@ -48,72 +51,138 @@ bool BinomialHeapPriorityQueue::isEmpty() const {
     return heap.size() == 0;
 }
 
-string BinomialHeapPriorityQueue::peek() const {
-    if(heap.size() == 0) error("The queue is empty");    
-    int dequeuedRootIndex = 0;
-    BinomialHeapNode* dequeuedRoot = NULL;
-    getDequeuedRoot(dequeuedRoot, dequeuedRootIndex);
-    return dequeuedRoot->entry.value;
+void BinomialHeapPriorityQueue::loadSnapshot(string path) {
+    PQSnapshotReader reader(path, SNAPSHOT_BINOMIAL_TREES);
+    enqueueCount = reader.nextSequence();
+    clear();
+    int index = 0;
+    while(index < reader.size()) {
+        if(reader.aux(index) < 0) {
+            heap.push_back(NULL);
+            index++;
+        } else {
+            heap.push_back(loadTree(reader, index));
+        }
+    }
+}
+
+const string& BinomialHeapPriorityQueue::peek() const {
+    const string *value = tryPeek();
+    if(value == NULL) error("The queue is empty");
+    return *value;
 }
 
 int BinomialHeapPriorityQueue::peekPriority() const {
-    if(heap.size() == 0) error("The queue is empty");
-    int dequeuedRootIndex = 0;
-    BinomialHeapNode* dequeuedRoot = NULL;
-    getDequeuedRoot(dequeuedRoot, dequeuedRootIndex);
-    return dequeuedRoot->entry.priority;
+    int priority = 0;
+    if(!tryPeekPriority(priority)) error("The queue is empty");
+    return priority;
+}
+
+void BinomialHeapPriorityQueue::saveSnapshot(string path) const {
+    PQSnapshotWriter writer(SNAPSHOT_BINOMIAL_TREES);
+    for(int i = 0; i < (int) heap.size(); i++) {
+        if(heap[i]) {
+            saveTree(writer, heap[i]);
+        } else {
+            writer.add("", 0, 0, -1);
+        }
+    }
+    writer.save(path);
 }
 
 int BinomialHeapPriorityQueue::size() const {
     int heapSize = 0;
-    for(int i = 0; i < heap.size(); i++) {
+    for(int i = 0; i < (int) heap.size(); i++) {
         if(heap[i] != NULL) heapSize += power(2, i);
     }
     return heapSize;
 }
 
-void BinomialHeapPriorityQueue::merge(Vector<BinomialHeapNode *>& heap1, Vector<BinomialHeapNode* >& heap2) {
-    Vector<BinomialHeapNode *> mergedHeap;
+bool BinomialHeapPriorityQueue::tryDequeue(string& value) {
+    if(heap.size() == 0) return false;
+    int dequeuedRootIndex = 0;
+    BinomialHeapNode* dequeuedRoot = NULL;
+    getDequeuedRoot(dequeuedRoot, dequeuedRootIndex);
+    value = std::move(dequeuedRoot->entry.value);
+    NodeVector orphanedChildren = std::move(dequeuedRoot->children);
+    /*
+     *  The root's slot is emptied rather than removed, so
+     *  the trees above it keep the slots of their orders.
+     */
+    heap[dequeuedRootIndex] = NULL;
+    deleteObject(resource, dequeuedRoot);
+    merge(orphanedChildren, heap);
+    while(!heap.empty() && heap.back() == NULL) {
+        heap.pop_back();
+    }
+    return true;
+}
+
+const string* BinomialHeapPriorityQueue::tryPeek() const {
+    if(heap.size() == 0) return NULL;
+    int dequeuedRootIndex = 0;
+    BinomialHeapNode* dequeuedRoot = NULL;
+    getDequeuedRoot(dequeuedRoot, dequeuedRootIndex);
+    return &dequeuedRoot->entry.value;
+}
+
+bool BinomialHeapPriorityQueue::tryPeekPriority(int& priority) const {
+    if(heap.size() == 0) return false;
+    int dequeuedRootIndex = 0;
+    BinomialHeapNode* dequeuedRoot = NULL;
+    getDequeuedRoot(dequeuedRoot, dequeuedRootIndex);
+    priority = dequeuedRoot->entry.priority;
+    return true;
+}
+
+void BinomialHeapPriorityQueue::merge(NodeVector& heap1, NodeVector& heap2) {
+    NodeVector mergedHeap(heap2.get_allocator());
     BinomialHeapNode* carry = NULL;
-    for(int i = 0; i < ((heap1.size() > heap2.size()) ? heap1.size() : heap2.size()); i++) {
-        Vector<BinomialHeapNode *> possibleTrees;
-        if(inBounds(heap1, i) && heap1[i]) possibleTrees.add(heap1[i]);
-        if(inBounds(heap2, i) && heap2[i]) possibleTrees.add(heap2[i]);
-        if(carry) possibleTrees.add(carry);
-        if(possibleTrees.size() == 0) {
-            mergedHeap.add(NULL);
+    for(int i = 0; i < (int) ((heap1.size() > heap2.size()) ? heap1.size() : heap2.size()); i++) {
+        PQ_COUNT(levels);
+        /*
+         *  At most three trees meet at one order: one from
+         *  each heap and the carry.
+         */
+        BinomialHeapNode* possibleTrees[3];
+        int treeCount = 0;
+        if(inBounds(heap1, i) && heap1[i]) possibleTrees[treeCount++] = heap1[i];
+        if(inBounds(heap2, i) && heap2[i]) possibleTrees[treeCount++] = heap2[i];
+        if(carry) possibleTrees[treeCount++] = carry;
+        if(treeCount == 0) {
+            mergedHeap.push_back(NULL);
             carry = NULL;
-        } else if(possibleTrees.size() == 1) {
-            mergedHeap.add(possibleTrees[0]);
+        } else if(treeCount == 1) {
+            mergedHeap.push_back(possibleTrees[0]);
             carry = NULL;
-        } else if(possibleTrees.size() == 2) {
-            mergedHeap.add(NULL);
+        } else if(treeCount == 2) {
+            mergedHeap.push_back(NULL);
             mergeTrees(carry, possibleTrees[0], possibleTrees[1]);
         } else {
-            mergedHeap.add(possibleTrees[2]);
+            mergedHeap.push_back(possibleTrees[2]);
             mergeTrees(carry, possibleTrees[0], possibleTrees[1]);
         }
     }
-    if(carry) mergedHeap.add(carry);
-    heap2 = mergedHeap;
+    if(carry) mergedHeap.push_back(carry);
+    heap2 = std::move(mergedHeap);
 }
 
-bool BinomialHeapPriorityQueue::inBounds(Vector<BinomialHeapNode *>& heap, int index) {
-    return (heap.size() - 1) >= index;
+bool BinomialHeapPriorityQueue::inBounds(NodeVector& heap, int index) {
+    return ((int) heap.size() - 1) >= index;
 }
 
 void BinomialHeapPriorityQueue::mergeTrees(BinomialHeapNode* & newTree, BinomialHeapNode* &tree1, BinomialHeapNode* &tree2) {
     if(tree1->entry >= tree2->entry) {
-        tree2->children.add(tree1);
+        tree2->children.push_back(tree1);
         newTree = tree2;
     } else {
-        tree1->children.add(tree2);
+        tree1->children.push_back(tree2);
         newTree = tree1;
     }
 }
 
 void BinomialHeapPriorityQueue::getDequeuedRoot(BinomialHeapNode*& dequeuedRoot, int& dequeuedRootIndex) const {
-    for(int i = 0; i < heap.size(); i++) {
+    for(int i = 0; i < (int) heap.size(); i++) {
         if(heap[i]) {
             if(!dequeuedRoot || dequeuedRoot->entry >= heap[i]->entry) {
                 dequeuedRootIndex = i;
@@ -130,3 +199,30 @@ int BinomialHeapPriorityQueue::power(int base, int exponent) const {
     }
     return result;
 }
+
+void BinomialHeapPriorityQueue::saveTree(PQSnapshotWriter& writer, BinomialHeapNode* tree) const {
+    writer.add(tree->entry.value, tree->entry.priority, tree->entry.sequence, tree->children.size());
+    for(int i = 0; i < (int) tree->children.size(); i++) {
+        saveTree(writer, tree->children[i]);
+    }
+}
+
+BinomialHeapPriorityQueue::BinomialHeapNode* BinomialHeapPriorityQueue::loadTree(PQSnapshotReader& reader, int& index) {
+    if(index >= reader.size() || reader.aux(index) < 0) error("PQSnapshot: truncated binomial tree");
+    BinomialHeapNode* tree = newObject<BinomialHeapNode>(resource, resource);
+    tree->entry = PQEntry(reader.value(index), reader.priority(index), policy, reader.sequence(index));
+    int childCount = reader.aux(index);
+    index++;
+    for(int i = 0; i < childCount; i++) {
+        tree->children.push_back(loadTree(reader, index));
+    }
+    return tree;
+}
+
+void BinomialHeapPriorityQueue::deleteTree(BinomialHeapNode* tree) {
+    if(tree == NULL) return;
+    for(int i = 0; i < (int) tree->children.size(); i++) {
+        deleteTree(tree->children[i]);
+    }
+    deleteObject(resource, tree);
+}
@@ -12,8 +12,11 @@
 
 #include <iostream>
 #include <string>
+#include <utility>    // for forward
+#include <vector>
+#include "MemoryResource.h"
 #include "PQEntry.h"
-#include "Vector.h"
+#include "PQSnapshot.h"
 #include "error.h"
 using namespace std;
 
@@ -29,29 +32,30 @@ class BinomialHeapPriorityQueue {
 public:
     /*
      *  Constructor: BinomialHeapPriorityQueue
+     *  Parameters: MemoryResource *resource
      *  - - - - - - - - - - - - - - - - - -
      *  Initializes a new BinomialHeapPriorityQueue. Since
      *  this class maintains order using a struct and
-     *  the Vector library, nothing is done in the
-     *  constructor.
+     *  standard vectors, nothing is done in the
+     *  constructor beyond noting the resource that the
+     *  nodes and their vectors are allocated from.
      */
-    BinomialHeapPriorityQueue();
+    explicit BinomialHeapPriorityQueue(MemoryResource *resource = defaultMemoryResource());
     
     /*
      *  Destructor: ~BinomialHeapPriorityQueue
      *  - - - - - - - - - - - - - - - - - -
      *  Frees any heap storage allocated by BinomialPriorityQueue,
-     *  which is minimal given the Vector library employed.
+     *  which requires the deletion of every node of every tree.
      */
     ~BinomialHeapPriorityQueue();
 
     /*
      *  Method: clear
      *  - - - - - - - - - - - - - - - - - -
-     *  Removes all items from VectorPriorityQueue. Since
-     *  this class uses the Vector library, this simply
-     *  leverages the clear() function from that class
-     *  to carry out the same job.
+     *  Removes all items from BinomialHeapPriorityQueue,
+     *  deleting each tree before clearing the vector of
+     *  roots.
      */
     void clear();
 
@@ -66,7 +70,8 @@ public:
      *  It then calls on a different helper function to retain
      *  the child branches of the now dequeued root with
      *  highest priority, leveraging the merge functionality
-     *  enumerated in the private section.
+     *  enumerated in the private section. The value is moved
+     *  out of its node, not copied.
      */
     string dequeue();
 
@@ -82,19 +87,46 @@ public:
      *  with the larger binomial heap already in place, if applicable.
      *  The merge process occurs for each bionmial tree in either of the
      *  binomial heaps, and closely mirrors binary addition.
+     *  A value passed as an rvalue is moved into its node
+     *  rather than copied.
      */
-    void enqueue(string value, int priority);
+    void enqueue(const string& value, int priority);
+    void enqueue(string&& value, int priority);
+
+    /*
+     *  Method: emplace
+     *  Parameters: int priority
+     *              Args&&... args
+     *  - - - - - - - - - - - - - - - - - -
+     *  Enqueues a value constructed from args at the given
+     *  priority without copying it. The priority comes first
+     *  so that the value's constructor arguments can trail it.
+     */
+    template <typename... Args>
+    void emplace(int priority, Args&&... args);
 
     /*
      *  Method: isEmpty
      *  - - - - - - - - - - - - - - - - - -
      *  Determines whether the PriorityQueue is empty.
-     *  Since the binomial heap is maintained by the
-     *  Vector library, this simply draws on its
+     *  Since the binomial heap is maintained by a
+     *  standard vector, this simply draws on its
      *  size function to return the associated boolean.
      */
     bool isEmpty() const;
 
+    /*
+     *  Method: loadSnapshot
+     *  Parameters: string path
+     *  - - - - - - - - - - - - - - - - - -
+     *  Replaces the contents of the PriorityQueue with those
+     *  of a snapshot written by saveSnapshot. The file is mapped
+     *  into memory and each tree is rebuilt node by node from
+     *  its preorder records, so no merging is needed before
+     *  the queue can be peeked or dequeued.
+     */
+    void loadSnapshot(string path);
+
     /*
      *  Method: peek
      *  - - - - - - - - - - - - - - - - - -
@@ -103,8 +135,9 @@ public:
      *  Since a binomial heap is employed, this requires a
      *  helper function to loop through each root of the heap
      *  and determine and return the node with the highest priority.
+     *  The reference is good until the queue is next changed.
      */
-    string peek() const;
+    const string& peek() const;
 
     /*
      *  Method: peekPriority
@@ -117,26 +150,82 @@ public:
      */
     int peekPriority() const;
 
+    /*
+     *  Method: saveSnapshot
+     *  Parameters: string path
+     *  - - - - - - - - - - - - - - - - - -
+     *  Writes the contents of the PriorityQueue to a binary
+     *  snapshot at the given path. Its records mirror the
+     *  root list: each slot is either an empty marker or its
+     *  tree in preorder, with every node recording how many
+     *  children follow it.
+     */
+    void saveSnapshot(string path) const;
+
     /*
      *  Method: size
      *  - - - - - - - - - - - - - - - - - -
      *  Returns the size of the PriorityQueue.
-     *  Leveraging the Vector library means this
-     *  function can just call on the size function
-     *  in that library.
+     *  Each root slot that holds a tree of order i
+     *  adds 2^i entries.
      */ 
     int size() const;
 
+    /*
+     *  Method: tryDequeue
+     *  Parameters: string& value
+     *  - - - - - - - - - - - - - - - - - -
+     *  Moves the value of the highest priority item into value,
+     *  removes the item and returns true, or returns false if
+     *  the PriorityQueue is empty. It never throws, so a consumer
+     *  loop can drain the queue without calling isEmpty first.
+     */
+    bool tryDequeue(string& value);
+
+    /*
+     *  Method: tryPeek
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns a pointer to the value of the highest priority
+     *  item, or NULL if the PriorityQueue is empty, standing in
+     *  for the optional that C++11 lacks.
+     */
+    const string* tryPeek() const;
+
+    /*
+     *  Method: tryPeekPriority
+     *  Parameters: int& priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Stores the priority of the highest priority item in
+     *  priority and returns true, or returns false if the
+     *  PriorityQueue is empty.
+     */
+    bool tryPeekPriority(int& priority) const;
+
 private:
+    BinomialHeapPriorityQueue(const BinomialHeapPriorityQueue& other);
+    BinomialHeapPriorityQueue& operator =(const BinomialHeapPriorityQueue& other);
+
+    struct BinomialHeapNode;
+
+    /*
+     *  Types: NodeAllocator, NodeVector
+     *  - - - - - - - - - - - - - - - - - -
+     *  A vector of trees, drawing from the queue's resource.
+     */
+    typedef ResourceAllocator<BinomialHeapNode *> NodeAllocator;
+    typedef vector<BinomialHeapNode *, NodeAllocator> NodeVector;
+
     struct BinomialHeapNode {
+        BinomialHeapNode(MemoryResource *resource) : children(NodeAllocator(resource)) {}
+
         PQEntry entry;
-        Vector<BinomialHeapNode *> children;
+        NodeVector children;
     };
 
     /*
      *  Method: merge
-     *  Parameters: Vector<BinomialHeapNode *>& heap1
-     *              Vector<BinomialHeapNode *>& heap2
+     *  Parameters: NodeVector& heap1
+     *              NodeVector& heap2
      *  - - - - - - - - - - - - - - - - - -
      *  Takes two heaps of any size as reference parameters and
      *  returns their syntheis by reference. This is accomplished
@@ -146,7 +235,7 @@ private:
      *  help of a carry node to keep track of the combinations and potentially
      *  inserting into the final combination.
      */ 
-    void merge(Vector<BinomialHeapNode *>& heap1, Vector<BinomialHeapNode* >& heap2);
+    void merge(NodeVector& heap1, NodeVector& heap2);
 
     /*
      *  Method: mergeTrees
@@ -165,14 +254,14 @@ private:
 
     /*
      *  Method: inBounds
-     *  Parameters: Vector<BinomialHeapNode *>& heap
+     *  Parameters: NodeVector& heap
      *              int index
      *  - - - - - - - - - - - - - - - - - -
      *  Helper function that determines whether a given
      *  index passed in is within bounds of a given
      *  vector passed by reference.
      */
-    bool inBounds(Vector<BinomialHeapNode *>& heap, int index);
+    bool inBounds(NodeVector& heap, int index);
 
     /*
      *  Method: getDequeuedRoot
@@ -203,13 +292,71 @@ private:
      */
     int power(int base, int exponent) const;
 
+    /*
+     *  Method: saveTree
+     *  Parameters: PQSnapshotWriter& writer
+     *              BinomialHeapNode* tree
+     *  - - - - - - - - - - - - - - - - - -
+     *  Helper function that appends a tree to a snapshot
+     *  in preorder, each node followed by its children.
+     */
+    void saveTree(PQSnapshotWriter& writer, BinomialHeapNode* tree) const;
+
+    /*
+     *  Method: loadTree
+     *  Parameters: PQSnapshotReader& reader
+     *              int& index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Helper function that rebuilds the tree whose root
+     *  record is at the given index, advancing the index
+     *  past the tree's last record.
+     */
+    BinomialHeapNode* loadTree(PQSnapshotReader& reader, int& index);
+
+    /*
+     *  Method: deleteTree
+     *  Parameters: BinomialHeapNode* tree
+     *  - - - - - - - - - - - - - - - - - -
+     *  Helper function that gives a tree's nodes back
+     *  to the resource, children first.
+     */
+    void deleteTree(BinomialHeapNode* tree);
+
     /*
      *  Vector: heap
      *  - - - - - - - -
      *  The data type used to house the binomial heap,
      *  which itself is comprised of binomial trees.
      */
-    Vector<BinomialHeapNode *> heap;
+    NodeVector heap;
+
+    /*
+     *  MemoryResource Pointer: resource
+     *  - - - - - - - -
+     *  Where the nodes and vectors are allocated.
+     */
+    MemoryResource *resource;
+
+    /*
+     *  TieBreakPolicy: policy
+     *  - - - - - - - -
+     *  The tie-break policy in effect when the queue
+     *  was constructed, stamped on each entry.
+     */
+    TieBreakPolicy policy;
+
+    /*
+     *  Integer: enqueueCount
+     *  - - - - - - - -
+     *  The sequence the queue stamps on the next entry it
+     *  enqueues, so entries are numbered per queue.
+     */
+    unsigned long long enqueueCount;
 };
 
+template <typename... Args>
+void BinomialHeapPriorityQueue::emplace(int priority, Args&&... args) {
+    enqueue(string(std::forward<Args>(args)...), priority);
+}
+
 #endif
@@ -0,0 +1,122 @@
+/*
+ *  File: BoundedPriorityQueue.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the BoundedPriorityQueue.
+ */
+
+#include "BoundedPriorityQueue.h"
+#include <utility>    // for move
+
+/*
+ *  Function: checkedCapacity
+ *  Parameters: int capacity
+ *  - - - - - - - - - - - - - - - - - -
+ *  Returns the capacity if it is positive, so the
+ *  entries are never allocated for a bad one.
+ */
+static int checkedCapacity(int capacity) {
+    if(capacity < 1) error("BoundedPriorityQueue: capacity must be positive");
+    return capacity;
+}
+
+BoundedPriorityQueue::BoundedPriorityQueue(int capacity, BoundedOverflowPolicy policy,
+                                           MemoryResource *resource)
+    : entries(checkedCapacity(capacity), resource) {
+    maxEntries = capacity;
+    this->policy = policy;
+    overflowCount = 0;
+    tieBreakPolicy = getTieBreakPolicy();
+}
+
+BoundedPriorityQueue::~BoundedPriorityQueue() {
+
+}
+
+void BoundedPriorityQueue::clear() {
+    entries.clear();
+    overflowCount = 0;
+}
+
+string BoundedPriorityQueue::dequeue() {
+    return entries.dequeueMin();
+}
+
+bool BoundedPriorityQueue::enqueue(string value, int priority) {
+    if(entries.size() < maxEntries) {
+        entries.enqueue(std::move(value), priority);
+        return true;
+    }
+    overflowCount++;
+    if(policy == BOUNDED_REJECT) return false;
+    /*
+     *  Most entries in a long stream do not make the cut, and
+     *  comparing priorities alone turns them away. On a tie,
+     *  the values are compared only under the lexicographic
+     *  policy; under FIFO the entry held came first, and
+     *  with no tie-breaking there is no reason to swap.
+     */
+    int lastPriority = entries.peekMaxPriority();
+    if(priority > lastPriority) return false;
+    if(priority == lastPriority) {
+        if(tieBreakPolicy != TIE_BREAK_LEXICOGRAPHIC || !(value < entries.peekMax())) return false;
+    }
+    entries.replaceMax(std::move(value), priority);
+    return true;
+}
+
+bool BoundedPriorityQueue::isEmpty() const {
+    return entries.isEmpty();
+}
+
+string BoundedPriorityQueue::peek() const {
+    return entries.peekMin();
+}
+
+int BoundedPriorityQueue::peekPriority() const {
+    return entries.peekPriority();
+}
+
+int BoundedPriorityQueue::size() const {
+    return entries.size();
+}
+
+bool BoundedPriorityQueue::tryDequeue(string& value) {
+    return entries.tryDequeue(value);
+}
+
+const string* BoundedPriorityQueue::tryPeek() const {
+    return entries.tryPeek();
+}
+
+bool BoundedPriorityQueue::tryPeekPriority(int& priority) const {
+    return entries.tryPeekPriority(priority);
+}
+
+int BoundedPriorityQueue::capacity() const {
+    return maxEntries;
+}
+
+long long BoundedPriorityQueue::evictions() const {
+    return overflowCount;
+}
+
+Vector<PQEntry> BoundedPriorityQueue::extractSorted() {
+    Vector<PQEntry> sorted;
+    while(!entries.isEmpty()) {
+        int priority = entries.peekPriority();
+        sorted.add(PQEntry(entries.dequeueMin(), priority));
+    }
+    return sorted;
+}
+
+bool BoundedPriorityQueue::isFull() const {
+    return entries.size() == maxEntries;
+}
+
+string BoundedPriorityQueue::peekLast() const {
+    return entries.peekMax();
+}
+
+int BoundedPriorityQueue::peekLastPriority() const {
+    return entries.peekMaxPriority();
+}
@@ -0,0 +1,169 @@
+/*
+ *  File: BoundedPriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the BoundedPriorityQueue, a
+ *  fixed-capacity queue that keeps only its K most
+ *  urgent entries, for streaming top-K selection.
+ */
+
+#ifndef _boundedpriorityqueue_h
+#define _boundedpriorityqueue_h
+
+#include <iostream>
+#include <string>
+#include "vector.h"
+#include "PQEntry.h"
+#include "MinMaxHeapPriorityQueue.h"
+#include "error.h"
+using namespace std;
+
+/*
+ *  Enum: BoundedOverflowPolicy
+ *  - - - - - - - - - - - - - - -
+ *  What a full BoundedPriorityQueue does with an
+ *  enqueue:
+ *
+ *  BOUNDED_EVICT   - if the new entry is more urgent than
+ *                    the least urgent one held, that one is
+ *                    evicted to make room; otherwise the
+ *                    new entry is dropped
+ *  BOUNDED_REJECT  - the new entry is refused, so the queue
+ *                    keeps the first K entries it was given
+ */
+enum BoundedOverflowPolicy {
+    BOUNDED_EVICT,
+    BOUNDED_REJECT
+};
+
+/*
+ *  Class: BoundedPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class holds at most K entries in a
+ *  MinMaxHeapPriorityQueue whose array is allocated for
+ *  K entries when the queue is constructed, so it never
+ *  allocates again, apart from the strings themselves.
+ *  The least urgent entry is kept within reach, so a full
+ *  queue turns away an entry that would not make the cut
+ *  with a single comparison and evicts in O(log K); a
+ *  stream of any length can be reduced to its K most
+ *  urgent entries in constant memory.
+ */
+class BoundedPriorityQueue {
+public:
+    /*
+     *  Constructor: BoundedPriorityQueue
+     *  Parameters: int capacity
+     *              BoundedOverflowPolicy policy
+     *              MemoryResource *resource
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes an empty queue that holds at most
+     *  capacity entries, allocated from the resource, and
+     *  treats an enqueue into a full queue according to
+     *  the given policy.
+     */
+    BoundedPriorityQueue(int capacity, BoundedOverflowPolicy policy = BOUNDED_EVICT,
+                         MemoryResource *resource = defaultMemoryResource());
+
+    /*
+     *  Destructor: ~BoundedPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Frees the preallocated entries.
+     */
+    ~BoundedPriorityQueue();
+
+    /*
+     *  Methods: clear, dequeue, isEmpty,
+     *           peek, peekPriority, size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Work as in the other queues, on the entries held.
+     */
+    void clear();
+    string dequeue();
+    bool isEmpty() const;
+    string peek() const;
+    int peekPriority() const;
+    int size() const;
+
+    /*
+     *  Method: enqueue
+     *  Parameters: string value
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Adds an item to the PriorityQueue if it has room,
+     *  or, once full, as the overflow policy allows.
+     *  Returns whether the item was kept.
+     */
+    bool enqueue(string value, int priority);
+
+    /*
+     *  Methods: tryDequeue, tryPeek, tryPeekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Work as dequeue, peek and peekPriority, but on an empty
+     *  queue return false or NULL instead of throwing. tryPeek
+     *  returns a pointer to the value, good until the queue is
+     *  next changed.
+     */
+    bool tryDequeue(string& value);
+    const string* tryPeek() const;
+    bool tryPeekPriority(int& priority) const;
+
+    /*
+     *  Method: capacity
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the most entries the queue will hold.
+     */
+    int capacity() const;
+
+    /*
+     *  Method: evictions
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns how many enqueues have been turned away or
+     *  have evicted an entry since the queue was cleared.
+     */
+    long long evictions() const;
+
+    /*
+     *  Method: extractSorted
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes every entry and returns them from the most
+     *  to the least urgent, the final result of a top-K
+     *  selection.
+     */
+    Vector<PQEntry> extractSorted();
+
+    /*
+     *  Method: isFull
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns whether the queue holds capacity entries.
+     */
+    bool isFull() const;
+
+    /*
+     *  Methods: peekLast, peekLastPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Return the value or the priority of the least urgent
+     *  entry held, the one the next eviction would remove.
+     */
+    string peekLast() const;
+    int peekLastPriority() const;
+
+private:
+    BoundedPriorityQueue(const BoundedPriorityQueue& other);
+    BoundedPriorityQueue& operator =(const BoundedPriorityQueue& other);
+
+    MinMaxHeapPriorityQueue entries;
+    int maxEntries;
+    BoundedOverflowPolicy policy;
+    long long overflowCount;
+
+    /*
+     *  TieBreakPolicy: tieBreakPolicy
+     *  - - - - - - - - - - - - - -
+     *  The tie-break policy in effect when the queue was
+     *  constructed, which decides whether a new entry that
+     *  ties with the least urgent one displaces it.
+     */
+    TieBreakPolicy tieBreakPolicy;
+};
+
+#endif
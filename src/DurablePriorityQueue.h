@@ -0,0 +1,360 @@
+/*
+ *  File: DurablePriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the DurablePriorityQueue, which
+ *  wraps any of the priority queues that support
+ *  snapshots so that its contents survive a crash.
+ */
+
+#ifndef _durablepriorityqueue_h
+#define _durablepriorityqueue_h
+
+#include <cstdio>     // for remove, rename
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "FileSync.h"
+#include "WriteAheadLog.h"
+#include "error.h"
+#include "vector.h"
+using namespace std;
+
+/*
+ *  Class: DurablePriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class forwards each operation to an in-memory
+ *  queue of type PQueue and records every change in a
+ *  write-ahead log beside it. Log records are synced in
+ *  groups, and after a configurable number of records
+ *  the queue is checkpointed into a snapshot and a new,
+ *  empty log is started. On construction the last
+ *  checkpoint is loaded and its log replayed onto it.
+ *
+ *  Each checkpoint and its log share a generation number.
+ *  A small manifest file names the current generation and
+ *  is replaced atomically once a new checkpoint and log
+ *  are on disk, so a crash during a checkpoint leaves
+ *  either the old pair or the new pair in effect, never
+ *  a mix that would replay the same records twice.
+ *
+ *  Operations in a group that has not yet been committed
+ *  may be lost in a crash, so a dequeued value can be
+ *  delivered again after recovery. Call sync to commit
+ *  the pending group immediately.
+ */
+template <typename PQueue>
+class DurablePriorityQueue {
+public:
+    /*
+     *  Constructor: DurablePriorityQueue
+     *  Parameters: string basePath
+     *              int groupCommitSize
+     *              long syncIntervalMS
+     *              int checkpointInterval
+     *  - - - - - - - - - - - - - - - - - -
+     *  Opens the durable queue stored at basePath, recovering
+     *  its contents from the generation named in basePath.manifest.
+     *  The log is synced every groupCommitSize records, or
+     *  by the first operation at least syncIntervalMS
+     *  milliseconds after the last sync, and checkpointed
+     *  every checkpointInterval records. Nothing is synced
+     *  between operations; call sync to commit on a timer.
+     */
+    DurablePriorityQueue(string basePath,
+                         int groupCommitSize = kDefaultGroupCommitSize,
+                         long syncIntervalMS = kDefaultSyncIntervalMS,
+                         int checkpointInterval = kDefaultCheckpointInterval);
+
+    /*
+     *  Destructor: ~DurablePriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Commits any pending log records.
+     */
+    ~DurablePriorityQueue();
+
+    /*
+     *  Method: checkpoint
+     *  - - - - - - - - - - - - - - - - - -
+     *  Saves the queue to the next generation's snapshot and
+     *  starts that generation's empty log, then switches the
+     *  manifest to it and deletes the previous generation.
+     */
+    void checkpoint();
+
+    /*
+     *  Methods: clear, dequeue, enqueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Apply the operation to the queue and append it to the
+     *  log. A dequeue is logged with the value and priority
+     *  it removed, so replay removes that same entry.
+     */
+    void clear();
+    string dequeue();
+    void enqueue(string value, int priority);
+
+    /*
+     *  Methods: isEmpty, peek, peekPriority, size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Forward to the queue; these are not logged.
+     */
+    bool isEmpty() const;
+    string peek() const;
+    int peekPriority() const;
+    int size() const;
+
+    /*
+     *  Method: sync
+     *  - - - - - - - - - - - - - - - - - -
+     *  Commits the pending group of log records now.
+     */
+    void sync();
+
+private:
+    DurablePriorityQueue(const DurablePriorityQueue& other);
+    DurablePriorityQueue& operator =(const DurablePriorityQueue& other);
+
+    /*
+     *  Method: recover
+     *  Parameters: int& replayed
+     *  - - - - - - - - - - - - - - - - - -
+     *  Loads the current generation's checkpoint, if any,
+     *  and replays the intact records of its log onto it,
+     *  setting replayed to their number. Returns the length
+     *  of the log up to its last intact record.
+     */
+    long long recover(int& replayed);
+
+    /*
+     *  Method: replayDequeue
+     *  Parameters: const string& value
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes the logged entry from the queue during replay.
+     *  Under TIE_BREAK_NONE a reloaded queue may order equal
+     *  priorities differently than before, so entries ahead of
+     *  the logged one at its priority are set aside and put back.
+     */
+    void replayDequeue(const string& value, int priority);
+
+    /*
+     *  Methods: checkpointPath, logPath
+     *  Parameters: int generation
+     *  - - - - - - - - - - - - - - - - - -
+     *  Return the file names used by a generation.
+     */
+    string checkpointPath(int generation) const;
+    string logPath(int generation) const;
+
+    /*
+     *  Method: removeGeneration
+     *  Parameters: int generation
+     *  - - - - - - - - - - - - - - - - - -
+     *  Deletes a generation's checkpoint and log, if present.
+     */
+    void removeGeneration(int generation) const;
+
+    /*
+     *  Method: logged
+     *  - - - - - - - - - - - - - - - - - -
+     *  Called after every logged operation to
+     *  checkpoint once enough records have built up.
+     */
+    void logged();
+
+    static const int kDefaultGroupCommitSize = 128;
+    static const long kDefaultSyncIntervalMS = 10;
+    static const int kDefaultCheckpointInterval = 1 << 20;
+
+    string basePath;
+    int generation;
+    int checkpointInterval;
+    PQueue queue;
+    WriteAheadLog *log;
+};
+
+/* Implementation section */
+
+template <typename PQueue>
+DurablePriorityQueue<PQueue>::DurablePriorityQueue(string basePath, int groupCommitSize,
+                                                   long syncIntervalMS, int checkpointInterval) {
+    this->basePath = basePath;
+    this->checkpointInterval = checkpointInterval;
+    int replayed = 0;
+    long long validLength = recover(replayed);
+    log = new WriteAheadLog(logPath(generation), groupCommitSize, syncIntervalMS);
+    /*
+     *  Drop any torn record at the end of the log so
+     *  that new records are not appended after it. The
+     *  replayed records still count toward the next
+     *  checkpoint, so a queue that is reopened often
+     *  does not let its log grow without bound.
+     */
+    log->truncate(validLength, replayed);
+    logged();
+}
+
+template <typename PQueue>
+DurablePriorityQueue<PQueue>::~DurablePriorityQueue() {
+    delete log;
+}
+
+template <typename PQueue>
+void DurablePriorityQueue<PQueue>::checkpoint() {
+    int next = generation + 1;
+    log->commit();
+    queue.saveSnapshot(checkpointPath(next));
+    WriteAheadLog *nextLog = new WriteAheadLog(logPath(next), log->groupCommitSize(), log->syncInterval());
+    nextLog->truncate();
+
+    string manifestPath = basePath + ".manifest";
+    string tempPath = manifestPath + ".tmp";
+    ofstream manifest(tempPath.c_str(), ios::trunc);
+    manifest << next << endl;
+    manifest.close();
+    if(!manifest) {
+        delete nextLog;
+        error("DurablePriorityQueue: cannot write " + tempPath);
+    }
+    syncFile(tempPath);
+#ifdef _WIN32
+    remove(manifestPath.c_str());
+#endif
+    if(rename(tempPath.c_str(), manifestPath.c_str()) != 0) {
+        delete nextLog;
+        error("DurablePriorityQueue: cannot replace " + manifestPath);
+    }
+    syncDirectory(manifestPath);
+
+    delete log;
+    log = nextLog;
+    removeGeneration(generation);
+    generation = next;
+}
+
+template <typename PQueue>
+void DurablePriorityQueue<PQueue>::clear() {
+    queue.clear();
+    log->append(WAL_CLEAR);
+    logged();
+}
+
+template <typename PQueue>
+string DurablePriorityQueue<PQueue>::dequeue() {
+    int priority = queue.peekPriority();
+    string value = queue.dequeue();
+    log->append(WAL_DEQUEUE, value, priority);
+    logged();
+    return value;
+}
+
+template <typename PQueue>
+void DurablePriorityQueue<PQueue>::enqueue(string value, int priority) {
+    log->append(WAL_ENQUEUE, value, priority);
+    queue.enqueue(value, priority);
+    logged();
+}
+
+template <typename PQueue>
+bool DurablePriorityQueue<PQueue>::isEmpty() const {
+    return queue.isEmpty();
+}
+
+template <typename PQueue>
+string DurablePriorityQueue<PQueue>::peek() const {
+    return queue.peek();
+}
+
+template <typename PQueue>
+int DurablePriorityQueue<PQueue>::peekPriority() const {
+    return queue.peekPriority();
+}
+
+template <typename PQueue>
+int DurablePriorityQueue<PQueue>::size() const {
+    return queue.size();
+}
+
+template <typename PQueue>
+void DurablePriorityQueue<PQueue>::sync() {
+    log->commit();
+}
+
+template <typename PQueue>
+long long DurablePriorityQueue<PQueue>::recover(int& replayed) {
+    generation = 0;
+    ifstream manifest((basePath + ".manifest").c_str());
+    if(manifest.is_open() && !(manifest >> generation)) {
+        error("DurablePriorityQueue: cannot read " + basePath + ".manifest");
+    }
+    manifest.close();
+    /*
+     *  Files of the previous generation, or of a checkpoint
+     *  that never reached the manifest, are left over from a crash.
+     */
+    removeGeneration(generation - 1);
+    removeGeneration(generation + 1);
+
+    ifstream checkpointFile(checkpointPath(generation).c_str());
+    bool hasCheckpoint = checkpointFile.is_open();
+    checkpointFile.close();
+    if(hasCheckpoint) queue.loadSnapshot(checkpointPath(generation));
+
+    WriteAheadLogReader reader(logPath(generation));
+    WriteAheadLogOp op;
+    string value;
+    int priority;
+    while(reader.next(op, value, priority)) {
+        if(op == WAL_ENQUEUE) {
+            queue.enqueue(value, priority);
+        } else if(op == WAL_DEQUEUE) {
+            replayDequeue(value, priority);
+        } else if(op == WAL_CLEAR) {
+            queue.clear();
+        }
+    }
+    replayed = reader.recordCount();
+    return reader.validLength();
+}
+
+template <typename PQueue>
+void DurablePriorityQueue<PQueue>::replayDequeue(const string& value, int priority) {
+    Vector<string> skipped;
+    while(true) {
+        if(queue.isEmpty() || queue.peekPriority() != priority) {
+            error("DurablePriorityQueue: log dequeues an entry the queue does not hold");
+        }
+        string front = queue.dequeue();
+        if(front == value) break;
+        skipped.add(front);
+    }
+    for(int i = 0; i < skipped.size(); i++) {
+        queue.enqueue(skipped[i], priority);
+    }
+}
+
+template <typename PQueue>
+void DurablePriorityQueue<PQueue>::logged() {
+    if(log->recordCount() >= checkpointInterval) checkpoint();
+}
+
+template <typename PQueue>
+string DurablePriorityQueue<PQueue>::checkpointPath(int generation) const {
+    ostringstream path;
+    path << basePath << ".checkpoint." << generation;
+    return path.str();
+}
+
+template <typename PQueue>
+string DurablePriorityQueue<PQueue>::logPath(int generation) const {
+    ostringstream path;
+    path << basePath << ".wal." << generation;
+    return path.str();
+}
+
+template <typename PQueue>
+void DurablePriorityQueue<PQueue>::removeGeneration(int generation) const {
+    remove(checkpointPath(generation).c_str());
+    remove(logPath(generation).c_str());
+}
+
+#endif
@@ -0,0 +1,267 @@
+/*
+ *  File: ExternalPriorityQueue.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the ExternalPriorityQueue,
+ *  which spills sorted runs to disk and merges
+ *  them back in as they are dequeued.
+ */
+
+#include "ExternalPriorityQueue.h"
+#include <algorithm>  // for max, push_heap, pop_heap, sort
+#include <cstdio>     // for remove
+#include <functional> // for greater
+#include <sstream>
+#include <utility>    // for move
+#include "timer.h"
+
+ExternalPriorityQueue::ExternalPriorityQueue(int memoryBudget, string spillDirectory) {
+    if(memoryBudget < 2) error("ExternalPriorityQueue: memory budget must be at least 2 entries");
+    insertionCapacity = memoryBudget / 2;
+    runBufferSize = max(1, (memoryBudget - insertionCapacity) / kMaxRuns);
+    this->spillDirectory = spillDirectory;
+    runSequence = 0;
+    count = 0;
+    policy = getTieBreakPolicy();
+    enqueueCount = 0;
+}
+
+ExternalPriorityQueue::~ExternalPriorityQueue() {
+    clear();
+}
+
+void ExternalPriorityQueue::clear() {
+    insertionHeap.clear();
+    for(int i = 0; i < front.size(); i++) {
+        closeRun(front[i]);
+    }
+    front.clear();
+    count = 0;
+}
+
+string ExternalPriorityQueue::dequeue() {
+    string value;
+    if(!tryDequeue(value)) error("The queue is empty");
+    return value;
+}
+
+void ExternalPriorityQueue::enqueue(string value, int priority) {
+    if((int) insertionHeap.size() >= insertionCapacity) spillInsertionHeap();
+    insertionHeap.push_back(PQEntry(std::move(value), priority, policy, enqueueCount++));
+    push_heap(insertionHeap.begin(), insertionHeap.end(), greater<PQEntry>());
+    count++;
+}
+
+bool ExternalPriorityQueue::isEmpty() const {
+    return count == 0;
+}
+
+string ExternalPriorityQueue::peek() const {
+    const string *value = tryPeek();
+    if(value == NULL) error("The queue is empty");
+    return *value;
+}
+
+int ExternalPriorityQueue::peekPriority() const {
+    int priority = 0;
+    if(!tryPeekPriority(priority)) error("The queue is empty");
+    return priority;
+}
+
+int ExternalPriorityQueue::runCount() const {
+    return front.size();
+}
+
+long long ExternalPriorityQueue::size() const {
+    return count;
+}
+
+bool ExternalPriorityQueue::tryDequeue(string& value) {
+    if(count == 0) return false;
+    if(frontIsNext()) {
+        value = std::move(takeHead(front).value);
+    } else {
+        pop_heap(insertionHeap.begin(), insertionHeap.end(), greater<PQEntry>());
+        value = std::move(insertionHeap.back().value);
+        insertionHeap.pop_back();
+    }
+    count--;
+    return true;
+}
+
+const string* ExternalPriorityQueue::tryPeek() const {
+    if(count == 0) return NULL;
+    if(frontIsNext()) return &head(front[0]).value;
+    return &insertionHeap.front().value;
+}
+
+bool ExternalPriorityQueue::tryPeekPriority(int& priority) const {
+    if(count == 0) return false;
+    priority = frontIsNext() ? head(front[0]).priority : insertionHeap.front().priority;
+    return true;
+}
+
+void ExternalPriorityQueue::spillInsertionHeap() {
+    string filename = nextRunFilename();
+    ofstream output(filename.c_str(), ios::binary | ios::trunc);
+    if(!output) error("ExternalPriorityQueue: cannot create run file " + filename);
+    sort(insertionHeap.begin(), insertionHeap.end());
+    for(int i = 0; i < (int) insertionHeap.size(); i++) {
+        writeEntry(output, insertionHeap[i]);
+    }
+    output.close();
+    if(!output) error("ExternalPriorityQueue: cannot write run file " + filename);
+    long long length = insertionHeap.size();
+    insertionHeap.clear();
+    openRun(filename, length, 0);
+    for(int level = 0; runsOnLevel(level) >= kMergeFanIn; level++) {
+        mergeRuns(level);
+    }
+}
+
+void ExternalPriorityQueue::mergeRuns(int level) {
+    /*
+     *  Pull the level's runs out of the merge front into a
+     *  heap of their own, and rebuild the front from the rest.
+     */
+    Vector<Run *> merging;
+    Vector<Run *> rest;
+    for(int i = 0; i < front.size(); i++) {
+        if(front[i]->level == level) {
+            merging.add(front[i]);
+            siftUp(merging, merging.size() - 1);
+        } else {
+            rest.add(front[i]);
+            siftUp(rest, rest.size() - 1);
+        }
+    }
+    front = rest;
+
+    string filename = nextRunFilename();
+    ofstream output(filename.c_str(), ios::binary | ios::trunc);
+    if(!output) error("ExternalPriorityQueue: cannot create run file " + filename);
+    long long length = 0;
+    while(!merging.isEmpty()) {
+        writeEntry(output, takeHead(merging));
+        length++;
+    }
+    output.close();
+    if(!output) error("ExternalPriorityQueue: cannot write run file " + filename);
+    openRun(filename, length, level + 1);
+}
+
+int ExternalPriorityQueue::runsOnLevel(int level) const {
+    int runs = 0;
+    for(int i = 0; i < front.size(); i++) {
+        if(front[i]->level == level) runs++;
+    }
+    return runs;
+}
+
+void ExternalPriorityQueue::openRun(string filename, long long length, int level) {
+    Run* run = new Run;
+    run->filename = filename;
+    run->input.open(filename.c_str(), ios::binary);
+    if(!run->input) {
+        delete run;
+        error("ExternalPriorityQueue: cannot open run file " + filename);
+    }
+    run->remaining = length;
+    run->level = level;
+    refill(run);
+    if(run->buffer.isEmpty()) {
+        closeRun(run);
+        return;
+    }
+    front.add(run);
+    siftUp(front, front.size() - 1);
+}
+
+void ExternalPriorityQueue::writeEntry(ofstream& output, const PQEntry& entry) {
+    int valueLength = entry.value.length();
+    output.write((const char *) &entry.priority, sizeof(entry.priority));
+    output.write((const char *) &entry.sequence, sizeof(entry.sequence));
+    output.write((const char *) &valueLength, sizeof(valueLength));
+    output.write(entry.value.data(), valueLength);
+}
+
+PQEntry ExternalPriorityQueue::takeHead(Vector<Run *>& runs) {
+    Run* run = runs[0];
+    PQEntry entry = std::move(run->buffer[run->bufferIndex]);
+    run->bufferIndex++;
+    if(run->bufferIndex == run->buffer.size()) refill(run);
+    if(run->buffer.isEmpty()) {
+        closeRun(run);
+        runs[0] = runs[runs.size() - 1];
+        runs.remove(runs.size() - 1);
+    }
+    if(!runs.isEmpty()) siftDown(runs, 0);
+    return entry;
+}
+
+void ExternalPriorityQueue::refill(Run* run) {
+    run->buffer.clear();
+    run->bufferIndex = 0;
+    while(run->remaining > 0 && run->buffer.size() < runBufferSize) {
+        int priority;
+        unsigned long long sequence;
+        int valueLength;
+        run->input.read((char *) &priority, sizeof(priority));
+        run->input.read((char *) &sequence, sizeof(sequence));
+        run->input.read((char *) &valueLength, sizeof(valueLength));
+        if(!run->input || valueLength < 0) error("ExternalPriorityQueue: cannot read run file " + run->filename);
+        string value(valueLength, '\0');
+        if(valueLength > 0) run->input.read(&value[0], valueLength);
+        if(!run->input) error("ExternalPriorityQueue: cannot read run file " + run->filename);
+        run->buffer.add(PQEntry(std::move(value), priority, policy, sequence));
+        run->remaining--;
+    }
+}
+
+void ExternalPriorityQueue::closeRun(Run* run) {
+    run->input.close();
+    remove(run->filename.c_str());
+    delete run;
+}
+
+bool ExternalPriorityQueue::frontIsNext() const {
+    if(front.isEmpty()) return false;
+    if(insertionHeap.empty()) return true;
+    return head(front[0]) < insertionHeap.front();
+}
+
+void ExternalPriorityQueue::siftUp(Vector<Run *>& runs, int index) {
+    while(index > 0) {
+        int parent = (index - 1) / 2;
+        if(!(head(runs[index]) < head(runs[parent]))) break;
+        Run* temp = runs[index];
+        runs[index] = runs[parent];
+        runs[parent] = temp;
+        index = parent;
+    }
+}
+
+void ExternalPriorityQueue::siftDown(Vector<Run *>& runs, int index) {
+    while(true) {
+        int smallest = index;
+        int left = 2 * index + 1;
+        int right = left + 1;
+        if(left < runs.size() && head(runs[left]) < head(runs[smallest])) smallest = left;
+        if(right < runs.size() && head(runs[right]) < head(runs[smallest])) smallest = right;
+        if(smallest == index) break;
+        Run* temp = runs[index];
+        runs[index] = runs[smallest];
+        runs[smallest] = temp;
+        index = smallest;
+    }
+}
+
+const PQEntry& ExternalPriorityQueue::head(Run* run) const {
+    return run->buffer[run->bufferIndex];
+}
+
+string ExternalPriorityQueue::nextRunFilename() {
+    ostringstream filename;
+    filename << spillDirectory << "/pqueue-" << Timer::currentTimeMS() << "-"
+             << (void *) this << "-" << runSequence++ << ".run";
+    return filename.str();
+}
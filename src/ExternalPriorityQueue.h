@@ -0,0 +1,368 @@
+/*
+ *  File: ExternalPriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the ExternalPriorityQueue,
+ *  which holds more entries than fit in memory
+ *  by spilling sorted runs to disk and merging
+ *  them back in as they are dequeued.
+ */
+
+#ifndef _externalpriorityqueue_h
+#define _externalpriorityqueue_h
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "PQEntry.h"
+#include "vector.h"
+#include "error.h"
+using namespace std;
+
+/*
+ *  Class: ExternalPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class maintains an ordered set of values
+ *  within a fixed memory budget, in the style of a
+ *  sequence heap. New entries land in a bounded
+ *  in-memory insertion heap. When it fills, it is
+ *  drained in order into a sorted run file, and a
+ *  k-way merge over the heads of all runs feeds
+ *  dequeues alongside the insertion heap. Runs are
+ *  merged level by level, as in a log-structured
+ *  merge tree, so that each entry is rewritten only a
+ *  logarithmic number of times.
+ */
+class ExternalPriorityQueue {
+public:
+    /*
+     *  Constructor: ExternalPriorityQueue
+     *  Parameters: int memoryBudget
+     *              string spillDirectory
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes a new ExternalPriorityQueue that keeps
+     *  at most memoryBudget entries in memory. Half of the
+     *  budget goes to the insertion heap and the rest is
+     *  shared among the read buffers of the runs, which
+     *  are written to the given directory.
+     */
+    ExternalPriorityQueue(int memoryBudget = kDefaultMemoryBudget, string spillDirectory = ".");
+
+    /*
+     *  Destructor: ~ExternalPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Frees any heap storage allocated by ExternalPriorityQueue
+     *  and deletes any run files it has written.
+     */
+    ~ExternalPriorityQueue();
+
+    /*
+     *  Method: clear
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes all items from ExternalPriorityQueue,
+     *  emptying the insertion heap and deleting every run.
+     */
+    void clear();
+
+    /*
+     *  Method: dequeue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value of the highest priority item in the
+     *  PriorityQueue and also removes it from the queue.
+     *  The item is the smaller of the insertion heap's top
+     *  and the head of the merge front. Taking from a run
+     *  advances its read buffer, refilling it from disk
+     *  in blocks, and deletes the run once it is exhausted.
+     */
+    string dequeue();
+
+    /*
+     *  Method: enqueue
+     *  Parameters: string value
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Adds a user-defined item to the PriorityQueue given
+     *  the item's key and its corresponding priority level.
+     *  Items go into the insertion heap, which is spilled
+     *  to a new sorted run once it reaches its capacity.
+     */
+    void enqueue(string value, int priority);
+
+    /*
+     *  Method: isEmpty
+     *  - - - - - - - - - - - - - - - - - -
+     *  Determines whether the PriorityQueue is empty.
+     */
+    bool isEmpty() const;
+
+    /*
+     *  Method: peek
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value of the highest priority item in the
+     *  PriorityQueue without removing it.
+     */
+    string peek() const;
+
+    /*
+     *  Method: peekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the priority of the highest priority item in the
+     *  PriorityQueue without removing it.
+     */
+    int peekPriority() const;
+
+    /*
+     *  Method: runCount
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the number of sorted runs currently on disk.
+     */
+    int runCount() const;
+
+    /*
+     *  Method: size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the size of the PriorityQueue, counting
+     *  entries both in memory and on disk.
+     */
+    long long size() const;
+
+    /*
+     *  Methods: tryDequeue, tryPeek, tryPeekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Work as dequeue, peek and peekPriority, but on an empty
+     *  queue return false or NULL instead of throwing. tryPeek
+     *  returns a pointer to the value, good until the queue is
+     *  next changed.
+     */
+    bool tryDequeue(string& value);
+    const string* tryPeek() const;
+    bool tryPeekPriority(int& priority) const;
+
+private:
+    /*
+     *  Struct: Run
+     *  - - - - - - - - - - - - - -
+     *  A sorted run on disk, read back through a buffer
+     *  of entries that starts at bufferIndex, with the
+     *  number of entries still on disk. A spilled run is
+     *  on level 0 and merging a level's runs makes one
+     *  run on the next.
+     */
+    struct Run {
+        string filename;
+        ifstream input;
+        Vector<PQEntry> buffer;
+        int bufferIndex;
+        long long remaining;
+        int level;
+    };
+
+    /*
+     *  Copying would share run files between queues, so it is disallowed.
+     */
+    ExternalPriorityQueue(const ExternalPriorityQueue& other);
+    ExternalPriorityQueue& operator =(const ExternalPriorityQueue& other);
+
+    /*
+     *  Method: spillInsertionHeap
+     *  - - - - - - - - - - - - - - - - - -
+     *  Sorts the insertion heap into a new run on level 0
+     *  and adds it to the merge front. Each level that
+     *  then holds kMergeFanIn runs is merged into the
+     *  next, which may fill that one in turn.
+     */
+    void spillInsertionHeap();
+
+    /*
+     *  Method: mergeRuns
+     *  Parameters: int level
+     *  - - - - - - - - - - - - - - - - - -
+     *  Merges the runs on the given level into a single
+     *  new run on the next level, leaving the other runs
+     *  alone. Runs on one level are of similar length, so
+     *  each entry is rewritten once per level and merging
+     *  n entries costs O(n log n) I/O in all.
+     */
+    void mergeRuns(int level);
+
+    /*
+     *  Method: runsOnLevel
+     *  Parameters: int level
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the number of runs on the given level.
+     */
+    int runsOnLevel(int level) const;
+
+    /*
+     *  Method: openRun
+     *  Parameters: string filename
+     *              long long length
+     *              int level
+     *  - - - - - - - - - - - - - - - - - -
+     *  Opens a run file that has just been written, loads
+     *  its first buffer, and adds it to the merge front.
+     */
+    void openRun(string filename, long long length, int level);
+
+    /*
+     *  Method: writeEntry
+     *  Parameters: ofstream& output
+     *              const PQEntry& entry
+     *  - - - - - - - - - - - - - - - - - -
+     *  Appends one record to a run file: the priority, the
+     *  sequence, so FIFO ties survive the trip to disk, and
+     *  the length-prefixed value.
+     */
+    void writeEntry(ofstream& output, const PQEntry& entry);
+
+    /*
+     *  Method: takeHead
+     *  Parameters: Vector<Run *>& runs
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes and returns the head entry of a heap of runs,
+     *  advancing its run, closing the run once it is
+     *  exhausted, and restoring the heap's order.
+     */
+    PQEntry takeHead(Vector<Run *>& runs);
+
+    /*
+     *  Method: refill
+     *  Parameters: Run* run
+     *  - - - - - - - - - - - - - - - - - -
+     *  Reads the next block of a run's entries into its buffer.
+     */
+    void refill(Run* run);
+
+    /*
+     *  Method: closeRun
+     *  Parameters: Run* run
+     *  - - - - - - - - - - - - - - - - - -
+     *  Closes a run's file, deletes it, and frees the run.
+     */
+    void closeRun(Run* run);
+
+    /*
+     *  Method: frontIsNext
+     *  - - - - - - - - - - - - - - - - - -
+     *  Determines whether the next entry to dequeue
+     *  comes from the merge front rather than the
+     *  insertion heap.
+     */
+    bool frontIsNext() const;
+
+    /*
+     *  Methods: siftUp, siftDown
+     *  Parameters: Vector<Run *>& runs
+     *              int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Restore the order of a binary heap of runs ordered
+     *  by their head entries, such as the merge front.
+     */
+    void siftUp(Vector<Run *>& runs, int index);
+    void siftDown(Vector<Run *>& runs, int index);
+
+    /*
+     *  Method: head
+     *  Parameters: Run* run
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the next entry of a run.
+     */
+    const PQEntry& head(Run* run) const;
+
+    /*
+     *  Method: nextRunFilename
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns a file name in the spill directory that is
+     *  not used by any other run of any queue.
+     */
+    string nextRunFilename();
+
+    /*
+     *  Integer: kDefaultMemoryBudget
+     *  - - - - - - - - - - - - - -
+     *  Default number of entries kept in memory.
+     */
+    static const int kDefaultMemoryBudget = 1 << 20;
+
+    /*
+     *  Integer: kMergeFanIn
+     *  - - - - - - - - - - - - - -
+     *  Number of runs a level collects before they are
+     *  merged into one run on the next level.
+     */
+    static const int kMergeFanIn = 8;
+
+    /*
+     *  Integer: kMaxRuns
+     *  - - - - - - - - - - - - - -
+     *  Number of runs the read buffers are sized for.
+     *  Each level holds fewer than kMergeFanIn runs, so
+     *  nine levels, reached only after 8^9 spills, fit.
+     */
+    static const int kMaxRuns = 64;
+
+    /*
+     *  Vector: insertionHeap
+     *  - - - - - - - - - - - - - -
+     *  Bounded in-memory min-heap receiving new entries,
+     *  kept with push_heap and pop_heap so that a spill
+     *  can sort it in place and write whole entries.
+     */
+    vector<PQEntry> insertionHeap;
+
+    /*
+     *  Vector: front
+     *  - - - - - - - -
+     *  Binary heap of open runs ordered by their
+     *  head entries, used for the k-way merge.
+     */
+    Vector<Run *> front;
+
+    /*
+     *  Integers: insertionCapacity, runBufferSize
+     *  - - - - - - - - - - - - - -
+     *  Shares of the memory budget given to the
+     *  insertion heap and to each run's buffer.
+     */
+    int insertionCapacity;
+    int runBufferSize;
+
+    /*
+     *  String: spillDirectory
+     *  - - - - - - - - - - - - - -
+     *  Directory in which run files are written.
+     */
+    string spillDirectory;
+
+    /*
+     *  Integer: runSequence
+     *  - - - - - - - - - - - - - -
+     *  Counter used to name this queue's run files.
+     */
+    int runSequence;
+
+    /*
+     *  Integer: count
+     *  - - - - - - - - - - - - - -
+     *  Number of entries in memory and on disk.
+     */
+    long long count;
+
+    /*
+     *  TieBreakPolicy: policy
+     *  - - - - - - - - - - - - - -
+     *  The tie-break policy in effect when the queue
+     *  was constructed, stamped on each entry read back.
+     */
+    TieBreakPolicy policy;
+
+    /*
+     *  Integer: enqueueCount
+     *  - - - - - - - - - - - - - -
+     *  The sequence the queue stamps on the next entry it
+     *  enqueues, so entries are numbered per queue.
+     */
+    unsigned long long enqueueCount;
+};
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ *  File: FileSync.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the file and directory sync helpers.
+ */
+
+#include "FileSync.h"
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#define fsync _commit
+#else
+#include <unistd.h>
+#endif
+
+void syncFile(string path) {
+#ifdef _WIN32
+    int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+#endif
+    if(fd < 0) error("FileSync: cannot open " + path);
+    int result = fsync(fd);
+    close(fd);
+    if(result != 0) error("FileSync: cannot sync " + path);
+}
+
+void syncDirectory(string path) {
+#ifndef _WIN32
+    size_t slash = path.rfind('/');
+    string directory = (slash == string::npos) ? "." : (slash == 0) ? "/" : path.substr(0, slash);
+    int fd = open(directory.c_str(), O_RDONLY);
+    if(fd < 0) error("FileSync: cannot open " + directory);
+    int result = fsync(fd);
+    close(fd);
+    if(result != 0) error("FileSync: cannot sync " + directory);
+#endif
+}
@@ -0,0 +1,35 @@
+/*
+ *  File: FileSync.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the helpers that flush files
+ *  and directories to disk, shared by the snapshot
+ *  writer and the write-ahead log.
+ */
+
+#ifndef _filesync_h
+#define _filesync_h
+
+#include <string>
+#include "error.h"
+using namespace std;
+
+/*
+ *  Function: syncFile
+ *  Parameters: string path
+ *  - - - - - - - - - - - - - - - - - -
+ *  Flushes a file that has already been written and
+ *  closed, such as a snapshot, to disk.
+ */
+void syncFile(string path);
+
+/*
+ *  Function: syncDirectory
+ *  Parameters: string path
+ *  - - - - - - - - - - - - - - - - - -
+ *  Flushes the directory holding the given file, so a
+ *  rename onto that file survives a crash. Does nothing
+ *  on platforms that cannot sync a directory.
+ */
+void syncDirectory(string path);
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ *  File: GroupedPriorityQueue.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the GroupedPriorityQueue, which
+ *  keeps one run of values per distinct priority.
+ */
+
+#include "GroupedPriorityQueue.h"
+#include <algorithm>  // for push_heap, pop_heap
+#include <functional> // for greater
+#include <utility>    // for move
+
+/*
+ *  A FIFO run is compacted once its head passes this many
+ *  dequeued values and half of its array.
+ */
+static const int kMinCompaction = 32;
+
+GroupedPriorityQueue::GroupedPriorityQueue() {
+    policy = getTieBreakPolicy();
+    queueSize = 0;
+}
+
+GroupedPriorityQueue::~GroupedPriorityQueue() {
+
+}
+
+void GroupedPriorityQueue::clear() {
+    runs.clear();
+    priorities.clear();
+    queueSize = 0;
+}
+
+string GroupedPriorityQueue::dequeue() {
+    string value;
+    if(!tryDequeue(value)) error("The queue is empty");
+    return value;
+}
+
+void GroupedPriorityQueue::enqueue(string value, int priority) {
+    unordered_map<int, PriorityRun>::iterator found = runs.find(priority);
+    if(found == runs.end()) {
+        found = runs.insert(make_pair(priority, PriorityRun())).first;
+        found->second.head = 0;
+        priorities.push_back(priority);
+        push_heap(priorities.begin(), priorities.end(), greater<int>());
+    }
+    PriorityRun& run = found->second;
+    run.values.push_back(std::move(value));
+    if(policy == TIE_BREAK_LEXICOGRAPHIC) {
+        push_heap(run.values.begin(), run.values.end(), greater<string>());
+    }
+    queueSize++;
+}
+
+bool GroupedPriorityQueue::isEmpty() const {
+    return queueSize == 0;
+}
+
+string GroupedPriorityQueue::peek() const {
+    const string *value = tryPeek();
+    if(value == NULL) error("The queue is empty");
+    return *value;
+}
+
+int GroupedPriorityQueue::peekPriority() const {
+    int priority = 0;
+    if(!tryPeekPriority(priority)) error("The queue is empty");
+    return priority;
+}
+
+int GroupedPriorityQueue::priorityCount() const {
+    return priorities.size();
+}
+
+int GroupedPriorityQueue::size() const {
+    return queueSize;
+}
+
+bool GroupedPriorityQueue::tryDequeue(string& value) {
+    if(queueSize == 0) return false;
+    int priority = priorities[0];
+    PriorityRun& run = runs[priority];
+    if(policy == TIE_BREAK_FIFO) {
+        value = std::move(run.values[run.head]);
+        run.head++;
+        if(run.head >= kMinCompaction && 2 * run.head >= (int) run.values.size()) {
+            run.values.erase(run.values.begin(), run.values.begin() + run.head);
+            run.head = 0;
+        }
+    } else if(policy == TIE_BREAK_LEXICOGRAPHIC) {
+        pop_heap(run.values.begin(), run.values.end(), greater<string>());
+        value = std::move(run.values.back());
+        run.values.pop_back();
+    } else {
+        value = std::move(run.values.back());
+        run.values.pop_back();
+    }
+    queueSize--;
+    if(run.head == (int) run.values.size()) {
+        runs.erase(priority);
+        pop_heap(priorities.begin(), priorities.end(), greater<int>());
+        priorities.pop_back();
+    }
+    return true;
+}
+
+const string* GroupedPriorityQueue::tryPeek() const {
+    if(queueSize == 0) return NULL;
+    const PriorityRun& run = frontRun();
+    return &run.values[front(run)];
+}
+
+bool GroupedPriorityQueue::tryPeekPriority(int& priority) const {
+    if(queueSize == 0) return false;
+    priority = priorities[0];
+    return true;
+}
+
+int GroupedPriorityQueue::front(const PriorityRun& run) const {
+    switch(policy) {
+        case TIE_BREAK_FIFO: return run.head;
+        case TIE_BREAK_LEXICOGRAPHIC: return 0;
+        default: return run.values.size() - 1;
+    }
+}
+
+const GroupedPriorityQueue::PriorityRun& GroupedPriorityQueue::frontRun() const {
+    return runs.find(priorities[0])->second;
+}
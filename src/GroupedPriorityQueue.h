@@ -0,0 +1,178 @@
+/*
+ *  File: GroupedPriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the GroupedPriorityQueue, which
+ *  keeps one run of values per distinct priority, for
+ *  queues with many entries over few priorities.
+ */
+
+#ifndef _groupedpriorityqueue_h
+#define _groupedpriorityqueue_h
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "PQEntry.h"
+#include "error.h"
+using namespace std;
+
+/*
+ *  Class: GroupedPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class files each value into the run for its
+ *  priority, found through a hash table, and keeps a
+ *  binary heap of the distinct priorities alone. An
+ *  enqueue at a priority already in the queue is an
+ *  amortized constant-time append, and the heap only
+ *  grows with the number of distinct priorities.
+ *
+ *  Each run is a contiguous array of values kept in the
+ *  order of the tie-break policy in effect when the queue
+ *  was constructed: a small heap of values for
+ *  TIE_BREAK_LEXICOGRAPHIC, a FIFO for TIE_BREAK_FIFO,
+ *  and a stack, the cheapest, for TIE_BREAK_NONE.
+ */
+class GroupedPriorityQueue {
+public:
+    /*
+     *  Constructor: GroupedPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes a new, empty GroupedPriorityQueue that
+     *  breaks ties by the current tie-break policy.
+     */
+    GroupedPriorityQueue();
+
+    /*
+     *  Destructor: ~GroupedPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Frees the runs.
+     */
+    ~GroupedPriorityQueue();
+
+    /*
+     *  Method: clear
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes all items from the PriorityQueue.
+     */
+    void clear();
+
+    /*
+     *  Method: dequeue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value of the highest priority item in the
+     *  PriorityQueue and also removes it from the queue, by
+     *  taking the first value of the most urgent run. A run
+     *  that empties is dropped along with its priority.
+     */
+    string dequeue();
+
+    /*
+     *  Method: enqueue
+     *  Parameters: string value
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Adds a user-defined item to the PriorityQueue given
+     *  the item's key and its corresponding priority level,
+     *  appending it to that priority's run, which is created
+     *  if the priority is new.
+     */
+    void enqueue(string value, int priority);
+
+    /*
+     *  Method: isEmpty
+     *  - - - - - - - - - - - - - - - - - -
+     *  Determines whether the PriorityQueue is empty.
+     */
+    bool isEmpty() const;
+
+    /*
+     *  Method: peek
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value of the highest priority item in the
+     *  PriorityQueue without removing it.
+     */
+    string peek() const;
+
+    /*
+     *  Method: peekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the priority of the highest priority item in the
+     *  PriorityQueue without removing it.
+     */
+    int peekPriority() const;
+
+    /*
+     *  Method: priorityCount
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the number of distinct priorities, which is
+     *  the size of the heap.
+     */
+    int priorityCount() const;
+
+    /*
+     *  Method: size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the size of the PriorityQueue.
+     */
+    int size() const;
+
+    /*
+     *  Methods: tryDequeue, tryPeek, tryPeekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Work as dequeue, peek and peekPriority, but on an empty
+     *  queue return false or NULL instead of throwing. tryPeek
+     *  returns a pointer to the value, good until the queue is
+     *  next changed.
+     */
+    bool tryDequeue(string& value);
+    const string* tryPeek() const;
+    bool tryPeekPriority(int& priority) const;
+
+private:
+    /*
+     *  Struct: PriorityRun
+     *  - - - - - - - - - - - - - - - - - -
+     *  The values enqueued at one priority. A FIFO run
+     *  starts at index head, which is compacted away once
+     *  it covers half the array; other runs start at 0.
+     */
+    struct PriorityRun {
+        vector<string> values;
+        int head;
+    };
+
+    /*
+     *  Method: front
+     *  Parameters: const PriorityRun& run
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the index of the run's next value to dequeue.
+     */
+    int front(const PriorityRun& run) const;
+
+    /*
+     *  Method: frontRun
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the run of the most urgent priority.
+     */
+    const PriorityRun& frontRun() const;
+
+    /*
+     *  Map: runs
+     *  - - - - - - - - - - - - - - - - - -
+     *  The run for each priority in the queue.
+     */
+    unordered_map<int, PriorityRun> runs;
+
+    /*
+     *  Vector: priorities
+     *  - - - - - - - - - - - - - - - - - -
+     *  The distinct priorities, as a min-heap.
+     */
+    vector<int> priorities;
+
+    TieBreakPolicy policy;
+    int queueSize;
+};
+
+#endif
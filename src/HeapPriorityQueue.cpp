@@ -8,15 +8,35 @@
  */
 
 #include "HeapPriorityQueue.h"
+#include <utility>    // for move
 
-HeapPriorityQueue::HeapPriorityQueue() {
+HeapPriorityQueue::HeapPriorityQueue(HeapInsertMode mode, MemoryResource *resource) {
+    this->resource = resource;
+    policy = getTieBreakPolicy();
+    enqueueCount = 0;
     queueCapacity = kInitialCapacity;
-    queue = new PQEntry[queueCapacity];
+    queue = newArray<PQEntry>(resource, queueCapacity);
+    PQ_COUNT(allocations);
     queueSize = 0;
+    this->mode = mode;
+    buffer = NULL;
+    if(mode == HEAP_INSERT_BUFFERED) {
+        buffer = newArray<PQEntry>(resource, kBufferCapacity);
+        PQ_COUNT(allocations);
+    }
+    bufferSize = 0;
+    bufferMinIndex = 0;
+    unheapified = 0;
+}
+
+HeapPriorityQueue::HeapPriorityQueue(MemoryResource *resource)
+    : HeapPriorityQueue(HEAP_INSERT_SIFT, resource) {
+
 }
 
 HeapPriorityQueue::~HeapPriorityQueue() {
-    delete[] queue;
+    deleteArray(resource, queue, queueCapacity);
+    if(buffer != NULL) deleteArray(resource, buffer, kBufferCapacity);
 }
 
 void HeapPriorityQueue::clear() {
@@ -24,112 +44,203 @@ void HeapPriorityQueue::clear() {
         queue[i] = {};
     }
     queueSize = 0;
+    for(int i = 0; i < bufferSize; i++) {
+        buffer[i] = {};
+    }
+    bufferSize = 0;
+    unheapified = 0;
 }
 
 string HeapPriorityQueue::dequeue() {
-    if(queueSize == 0) error("The queue is empty");
-    string value = queue[kZeroBaseOffset].value;
-    int lastNodeIndex = queueSize;
-    trickleDown(lastNodeIndex);
-    queueSize--;
+    string value;
+    if(!tryDequeue(value)) error("The queue is empty");
     return value;
 }
 
-void HeapPriorityQueue::enqueue(string value, int priority) {
-    PQEntry newNode = {value, priority};
+void HeapPriorityQueue::enqueue(const string& value, int priority) {
+    enqueue(string(value), priority);
+}
+
+void HeapPriorityQueue::enqueue(string&& value, int priority) {
+    if(mode == HEAP_INSERT_BUFFERED) {
+        if(bufferSize == kBufferCapacity) flushBuffer();
+        buffer[bufferSize] = PQEntry(std::move(value), priority, policy, enqueueCount++);
+        if(bufferSize == 0 || buffer[bufferSize] < buffer[bufferMinIndex]) bufferMinIndex = bufferSize;
+        bufferSize++;
+        return;
+    }
+    if(mode == HEAP_INSERT_LAZY) {
+        if(queueCapacity <= queueSize + kZeroBaseOffset) expandQueueCapacity();
+        queue[queueSize + kZeroBaseOffset] = PQEntry(std::move(value), priority, policy, enqueueCount++);
+        queueSize++;
+        unheapified++;
+        return;
+    }
     int newNodeIndex = queueSize + kZeroBaseOffset;
     if(queueCapacity <= newNodeIndex) expandQueueCapacity();
-    queue[newNodeIndex] = newNode;
+    queue[newNodeIndex] = PQEntry(std::move(value), priority, policy, enqueueCount++);
     queueSize++;
-    if(newNodeIndex != kZeroBaseOffset) percolateUp(newNodeIndex);
+    siftUp(newNodeIndex);
 }
 
 bool HeapPriorityQueue::isEmpty() const {
-    return queueSize == 0;
+    return queueSize + bufferSize == 0;
+}
+
+void HeapPriorityQueue::loadSnapshot(string path) {
+    PQSnapshotReader reader(path, SNAPSHOT_HEAP_ARRAY);
+    enqueueCount = reader.nextSequence();
+    int snapshotSize = reader.size();
+    clear();
+    if(queueCapacity <= snapshotSize) {
+        deleteArray(resource, queue, queueCapacity);
+        queueCapacity = snapshotSize + kZeroBaseOffset;
+        queue = newArray<PQEntry>(resource, queueCapacity);
+    }
+    for(int i = 0; i < snapshotSize; i++) {
+        queue[i + kZeroBaseOffset] = PQEntry(reader.value(i), reader.priority(i), policy, reader.sequence(i));
+    }
+    queueSize = snapshotSize;
 }
 
-string HeapPriorityQueue::peek() const {
-    if(queueSize == 0) error("The queue is empty");
-    return queue[kZeroBaseOffset].value;
+const string& HeapPriorityQueue::peek() const {
+    const string *value = tryPeek();
+    if(value == NULL) error("The queue is empty");
+    return *value;
 }
 
 int HeapPriorityQueue::peekPriority() const {
-    if(queueSize == 0) error("The queue is empty");
-    return queue[kZeroBaseOffset].priority;
+    int priority = 0;
+    if(!tryPeekPriority(priority)) error("The queue is empty");
+    return priority;
+}
+
+void HeapPriorityQueue::saveSnapshot(string path) const {
+    heapifySuffix();
+    flushBuffer();
+    PQSnapshotWriter writer(SNAPSHOT_HEAP_ARRAY);
+    for(int i = kZeroBaseOffset; i < queueSize + kZeroBaseOffset; i++) {
+        writer.add(queue[i].value, queue[i].priority, queue[i].sequence);
+    }
+    writer.save(path);
 }
 
 int HeapPriorityQueue::size() const {
-    return queueSize;
+    return queueSize + bufferSize;
+}
+
+bool HeapPriorityQueue::tryDequeue(string& value) {
+    if(queueSize + bufferSize == 0) return false;
+    heapifySuffix();
+    if(bufferSize > 0 && (queueSize == 0 || buffer[bufferMinIndex] < queue[kZeroBaseOffset])) {
+        flushBuffer();
+    }
+    value = std::move(queue[kZeroBaseOffset].value);
+    int lastNodeIndex = queueSize;
+    if(lastNodeIndex != kZeroBaseOffset) queue[kZeroBaseOffset] = std::move(queue[lastNodeIndex]);
+    queueSize--;
+    if(queueSize > 0) siftDown(kZeroBaseOffset);
+    return true;
+}
+
+const string* HeapPriorityQueue::tryPeek() const {
+    if(queueSize + bufferSize == 0) return NULL;
+    heapifySuffix();
+    return &front().value;
+}
+
+bool HeapPriorityQueue::tryPeekPriority(int& priority) const {
+    if(queueSize + bufferSize == 0) return false;
+    heapifySuffix();
+    priority = front().priority;
+    return true;
 }
 
-void HeapPriorityQueue::expandQueueCapacity() {
+void HeapPriorityQueue::expandQueueCapacity() const {
     PQEntry *oldQueue = queue;
+    int oldCapacity = queueCapacity;
     queueCapacity *= 2;
-    queue = new PQEntry[queueCapacity];
+    queue = newArray<PQEntry>(resource, queueCapacity);
+    PQ_COUNT(allocations);
     queue[0] = {};
     for(int i = 1; i < queueSize + kZeroBaseOffset; i++) {
-        queue[i] = oldQueue[i];
-    }
-    delete[] oldQueue;
-}
-
-void HeapPriorityQueue::percolateUp(int childIndex) {
-    int parentIndex = childIndex / 2;
-    PQEntry child = setRoot(childIndex);
-    PQEntry parent = setRoot(parentIndex);
-    while(validBranch(child) && child < parent) {
-        queue[parentIndex] = child;
-        queue[childIndex] = parent;
-        childIndex = parentIndex;
-        parentIndex = childIndex / 2;
-        parent = queue[parentIndex];
-    }
-}
-
-void HeapPriorityQueue::trickleDown(int lastNodeIndex) {
-    int trickleDownIndex = kZeroBaseOffset;
-    queue[trickleDownIndex] = queue[lastNodeIndex];  //Swap lowest priority with top root
-    queue[lastNodeIndex] = {};
-    PQEntry trickleDownNode = queue[trickleDownIndex];
-    PQEntry leftChild = setRoot(getLeftChildIndex(trickleDownIndex));
-    PQEntry rightChild = setRoot(getRightChildIndex(trickleDownIndex));
-    /*
-     *  Use PQEntry built-in operators for determining equality
-     */
-    while((validBranch(leftChild) && trickleDownNode > leftChild) ||
-          (validBranch(rightChild) && trickleDownNode > rightChild)) {
-        if(validBranch(rightChild) && leftChild > rightChild) {
-            swap(rightChild, trickleDownNode, getRightChildIndex(trickleDownIndex), trickleDownIndex);
-        } else {
-            swap(leftChild, trickleDownNode, getLeftChildIndex(trickleDownIndex), trickleDownIndex);
-        }
-        leftChild = setRoot(getLeftChildIndex(trickleDownIndex));
-        rightChild = setRoot(getRightChildIndex(trickleDownIndex));
+        queue[i] = std::move(oldQueue[i]);
     }
+    deleteArray(resource, oldQueue, oldCapacity);
 }
 
-int HeapPriorityQueue::getLeftChildIndex(int index) const {
-    return 2 * index;
+void HeapPriorityQueue::flushBuffer() const {
+    if(bufferSize == 0) return;
+    while(queueCapacity <= queueSize + bufferSize) expandQueueCapacity();
+    int first = queueSize + kZeroBaseOffset;
+    for(int i = 0; i < bufferSize; i++) {
+        queue[queueSize + kZeroBaseOffset] = std::move(buffer[i]);
+        queueSize++;
+    }
+    bufferSize = 0;
+    heapifyRange(first, queueSize);
+}
+
+const PQEntry& HeapPriorityQueue::front() const {
+    if(queueSize == 0) return buffer[bufferMinIndex];
+    if(bufferSize > 0 && buffer[bufferMinIndex] < queue[kZeroBaseOffset]) return buffer[bufferMinIndex];
+    return queue[kZeroBaseOffset];
 }
 
-int HeapPriorityQueue::getRightChildIndex(int index) const {
-    return 2 * index + 1;
+void HeapPriorityQueue::heapifyRange(int first, int last) const {
+    int low = first / 2;
+    int high = last / 2;
+    while(high >= kZeroBaseOffset) {
+        if(low < kZeroBaseOffset) low = kZeroBaseOffset;
+        for(int i = high; i >= low; i--) {
+            siftDown(i);
+        }
+        if(low == kZeroBaseOffset) break;
+        low /= 2;
+        high /= 2;
+    }
 }
 
-void HeapPriorityQueue::swap(PQEntry& childNode, PQEntry& trickleDownNode, int childIndex, int& trickleDownIndex) {
-    queue[trickleDownIndex] = childNode;
-    queue[childIndex] = trickleDownNode;
-    trickleDownIndex = childIndex;
-    trickleDownNode = queue[trickleDownIndex];
+void HeapPriorityQueue::heapifySuffix() const {
+    if(unheapified == 0) return;
+    int first = queueSize - unheapified + kZeroBaseOffset;
+    int depth = 0;
+    for(int i = queueSize; i > kZeroBaseOffset; i /= 2) {
+        depth++;
+    }
+    if(unheapified * depth >= queueSize) {
+        heapifyRange(first, queueSize);
+    } else {
+        for(int i = first; i <= queueSize; i++) {
+            siftUp(i);
+        }
+    }
+    unheapified = 0;
+}
+
+void HeapPriorityQueue::siftDown(int index) const {
+    PQEntry entry = std::move(queue[index]);
+    while(getLeftChildIndex(index) <= queueSize) {
+        int childIndex = getLeftChildIndex(index);
+        if(childIndex < queueSize && queue[childIndex + 1] < queue[childIndex]) childIndex++;
+        if(!(queue[childIndex] < entry)) break;
+        PQ_COUNT(levels);
+        queue[index] = std::move(queue[childIndex]);
+        index = childIndex;
+    }
+    queue[index] = std::move(entry);
 }
 
-PQEntry HeapPriorityQueue::setRoot(int index) {
-    PQEntry root;
-    if(index <= queueSize) root = queue[index];
-    return root;
+void HeapPriorityQueue::siftUp(int index) const {
+    PQEntry entry = std::move(queue[index]);
+    while(index > kZeroBaseOffset && entry < queue[index / 2]) {
+        PQ_COUNT(levels);
+        queue[index] = std::move(queue[index / 2]);
+        index /= 2;
+    }
+    queue[index] = std::move(entry);
 }
 
-bool HeapPriorityQueue::validBranch(PQEntry& root) {
-    PQEntry blankRoot;
-    return root != blankRoot;
+int HeapPriorityQueue::getLeftChildIndex(int index) const {
+    return 2 * index;
 }
@@ -12,10 +12,34 @@
 
 #include <iostream>
 #include <string>
+#include <utility>    // for forward
+#include "MemoryResource.h"
 #include "PQEntry.h"
+#include "PQSnapshot.h"
 #include "error.h"
 using namespace std;
 
+/*
+ *  Enum: HeapInsertMode
+ *  - - - - - - - - - - - - - - -
+ *  How a HeapPriorityQueue takes in new entries:
+ *
+ *  HEAP_INSERT_SIFT      - each entry is percolated up into
+ *                          the heap as it is enqueued
+ *  HEAP_INSERT_BUFFERED  - entries collect in a small unsorted
+ *                          buffer that is merged into the heap
+ *                          in bulk, for bursts of enqueues
+ *  HEAP_INSERT_LAZY      - entries are appended to the array and
+ *                          only heapified by the next peek or
+ *                          dequeue, for loading a queue and then
+ *                          draining it
+ */
+enum HeapInsertMode {
+    HEAP_INSERT_SIFT,
+    HEAP_INSERT_BUFFERED,
+    HEAP_INSERT_LAZY
+};
+
 /*
  *  Class: HeapPriorityQueue
  *  - - - - - - - - - - - - - - -
@@ -28,13 +52,20 @@ class HeapPriorityQueue {
 public:
     /*
      *  Constructor: HeapPriorityQueue
+     *  Parameters: HeapInsertMode mode
+     *              MemoryResource *resource
      *  - - - - - - - - - - - - - - - - - -
      *  Initializes a new HeapPriorityQueue. Since
      *  this class uses a C-style array to maintain order,
      *  this initializes the array used in the
-     *  binomial tree.
+     *  binomial tree, and the insertion buffer if the
+     *  queue is buffered. The arrays are allocated from
+     *  the given resource, as is every larger array the
+     *  tree grows into.
      */
-    HeapPriorityQueue();
+    HeapPriorityQueue(HeapInsertMode mode = HEAP_INSERT_SIFT,
+                      MemoryResource *resource = defaultMemoryResource());
+    explicit HeapPriorityQueue(MemoryResource *resource);
     
     /*
      *  Destructor: ~HeapPriorityQueue
@@ -64,7 +95,11 @@ public:
      *  has to reorder the rest of the tree now that global
      *  root is removed.  To do this, it takes the lowest priority
      *  branch, moves it to the top of the tree, and then 
-     *  rearranges it accordingly.
+     *  rearranges it accordingly. If the highest priority item
+     *  is in the insertion buffer, the buffer is flushed first,
+     *  and entries a lazy queue appended are heapified first.
+     *  The value is moved out, and entries are only ever moved
+     *  within the tree, so no string is copied.
      */
     string dequeue();
 
@@ -78,9 +113,25 @@ public:
      *  used for retrieval. Since a binomial tree is used,
      *  the value is enqueued as if it is the lowest priority branch,
      *  and then moved up in the tree based on comparison with its
-     *  parent node.
+     *  parent node. A buffered queue instead adds it to the
+     *  insertion buffer, flushing the buffer first if it is full,
+     *  and a lazy queue appends it to the array unordered.
+     *  A value passed as an rvalue is moved in rather than copied.
      */
-    void enqueue(string value, int priority);
+    void enqueue(const string& value, int priority);
+    void enqueue(string&& value, int priority);
+
+    /*
+     *  Method: emplace
+     *  Parameters: int priority
+     *              Args&&... args
+     *  - - - - - - - - - - - - - - - - - -
+     *  Enqueues a value constructed from args at the given
+     *  priority without copying it. The priority comes first
+     *  so that the value's constructor arguments can trail it.
+     */
+    template <typename... Args>
+    void emplace(int priority, Args&&... args);
 
     /*
      *  Method: isEmpty
@@ -92,6 +143,18 @@ public:
      */
     bool isEmpty() const;
 
+    /*
+     *  Method: loadSnapshot
+     *  Parameters: string path
+     *  - - - - - - - - - - - - - - - - - -
+     *  Replaces the contents of the PriorityQueue with those
+     *  of a snapshot written by saveSnapshot. The file is mapped
+     *  into memory and its records are copied straight into
+     *  the array in heap order, so no percolating is needed
+     *  before the queue can be peeked or dequeued.
+     */
+    void loadSnapshot(string path);
+
     /*
      *  Method: peek
      *  - - - - - - - - - - - - - - - - - -
@@ -99,8 +162,9 @@ public:
      *  PriorityQueue without removing it.
      *  Since a binomial tree is employed, this is as simple as
      *  calling the key value from the top of the list.
+     *  The reference is good until the queue is next changed.
      */
-    string peek() const;
+    const string& peek() const;
 
     /*
      *  Method: peekPriority
@@ -112,6 +176,17 @@ public:
      */
     int peekPriority() const;
 
+    /*
+     *  Method: saveSnapshot
+     *  Parameters: string path
+     *  - - - - - - - - - - - - - - - - - -
+     *  Writes the contents of the PriorityQueue to a binary
+     *  snapshot at the given path. Its records mirror the
+     *  array in heap order, with the values gathered into
+     *  one contiguous blob and referenced by offset.
+     */
+    void saveSnapshot(string path) const;
+
     /*
      *  Method: size
      *  - - - - - - - - - - - - - - - - - -
@@ -122,6 +197,39 @@ public:
      */
     int size() const;
 
+    /*
+     *  Method: tryDequeue
+     *  Parameters: string& value
+     *  - - - - - - - - - - - - - - - - - -
+     *  Moves the value of the highest priority item into value,
+     *  removes the item and returns true, or returns false if
+     *  the PriorityQueue is empty. It never throws, so a consumer
+     *  loop can drain the queue without calling isEmpty first.
+     *  Like dequeue, it heapifies a lazy queue's appended
+     *  entries and flushes the buffer as needed.
+     */
+    bool tryDequeue(string& value);
+
+    /*
+     *  Method: tryPeek
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns a pointer to the value of the highest priority
+     *  item, or NULL if the PriorityQueue is empty, standing in
+     *  for the optional that C++11 lacks.
+     *  The pointer is good until the queue is next changed.
+     */
+    const string* tryPeek() const;
+
+    /*
+     *  Method: tryPeekPriority
+     *  Parameters: int& priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Stores the priority of the highest priority item in
+     *  priority and returns true, or returns false if the
+     *  PriorityQueue is empty.
+     */
+    bool tryPeekPriority(int& priority) const;
+
 private:
     /*
      *  Method: expandQueueCapacity
@@ -131,95 +239,92 @@ private:
      *  as specified in the constant member variable,
      *  kInititalCapacity.
      */
-    void expandQueueCapacity();
+    void expandQueueCapacity() const;
 
     /*
-     *  Method: percolateUp
-     *  Parameters: int index
+     *  Method: flushBuffer
      *  - - - - - - - - - - - - - - - - - -
-     *  This helper function determines whether the newly
-     *  enqueued value should assume a higher priority
-     *  in the binomial tree.  Since it is either a child or
-     *  the sole root, it needs to only check its parent's
-     *  priority and then swap places if indeed higher priority.
+     *  This helper function appends the insertion buffer
+     *  to the end of the array and merges it into the
+     *  binomial tree from the bottom up with heapifyRange.
      */
-    void percolateUp(int childIndex);
+    void flushBuffer() const;
 
     /*
-     *  Method: trickleDown
-     *  Parameters: int lastNodeIndex
+     *  Method: front
      *  - - - - - - - - - - - - - - - - - -
-     *  This helper function reorders the binomial
-     *  tree after it has recently been dequeued.
-     *  It does so by taking the lowest priority branch
-     *  and swapping it with the highest priority root
-     *  position in tree. It then checks all of its
-     *  new children to see if it is lower priority,
-     *  and swaps places accordingly.
+     *  This helper function returns the highest priority
+     *  entry, which is either atop the tree or the cached
+     *  minimum of the insertion buffer.
      */
-    void trickleDown(int lastNodeIndex);
+    const PQEntry& front() const;
 
     /*
-     *  Method: swap
-     *  Parameters: PQEntry& childNode
-     *              PGEntry& trickleDownNode
-     *              int childIndex
-     *              int trickleDownIndex
+     *  Method: heapifyRange
+     *  Parameters: int first
+     *              int last
      *  - - - - - - - - - - - - - - - - - -
-     *  This helper function swaps two nodes
-     *  in the binomial tree class given their values
-     *  and index locations within the tree.
+     *  This helper function restores the tree after the
+     *  entries from index first to last were appended
+     *  unordered. It sifts down the parents of that range,
+     *  then their parents, and so on up to the root, so a
+     *  range covering the whole array is Floyd's build.
      */
-    void swap(PQEntry& childNode, PQEntry& trickleDownNode, int childIndex, int& trickleDownIndex);
+    void heapifyRange(int first, int last) const;
 
     /*
-     *  Method: getLeftChildIndex
-     *  Parameters: int index
+     *  Method: heapifySuffix
      *  - - - - - - - - - - - - - - - - - -
-     *  This helper function returns the lefthand
-     *  child index of a given parent index based
-     *  on the binomial tree used.
+     *  This helper function brings the entries a lazy
+     *  queue appended since it was last heapified into the
+     *  tree. A suffix large next to the tree is merged with
+     *  heapifyRange, in linear time; a short one is sifted
+     *  up one entry at a time, which costs a level or two
+     *  per entry for random priorities.
      */
-    int getLeftChildIndex(int index) const;
+    void heapifySuffix() const;
 
     /*
-     *  Method: getRightChildIndex
+     *  Method: siftDown
      *  Parameters: int index
      *  - - - - - - - - - - - - - - - - - -
-     *  This helper function returns the righthand
-     *  child index of a given parent index based
-     *  on the binomial tree used.
+     *  This helper function moves the entry at index down
+     *  the tree until neither child has higher priority,
+     *  moving each child it passes up a level in turn.
      */
-    int getRightChildIndex(int index) const;
+    void siftDown(int index) const;
 
     /*
-     *  Method: setRoot
+     *  Method: siftUp
      *  Parameters: int index
      *  - - - - - - - - - - - - - - - - - -
-     *  This helper function returns a tree branch
-     *  that is in bounds if the branch exists in the tree,
-     *  or returns a null branch if it doesn't.
+     *  This helper function moves the entry at index up
+     *  the tree until its parent has higher priority,
+     *  moving each parent it passes down a level in turn.
      */
-    PQEntry setRoot(int index);
+    void siftUp(int index) const;
 
     /*
-     *  Method: validBranch
-     *  Parameters: PQEntry& root
+     *  Method: getLeftChildIndex
+     *  Parameters: int index
      *  - - - - - - - - - - - - - - - - - -
-     *  This helper function is a substitute
-     *  for the == operator that isn't exported
-     *  in the PQEntry class.
+     *  This helper function returns the lefthand
+     *  child index of a given parent index based
+     *  on the binomial tree used.
      */
-    bool validBranch(PQEntry& root);
+    int getLeftChildIndex(int index) const;
 
     /*
      *  Array: queue
      *  - - - - - - - - - - - - - - - - - -
      *  C-style array used to house the binomial
      *  tree. It is initialized in the constructor
-     *  and deleted in the destructor.
+     *  and deleted in the destructor. It is mutable,
+     *  as are the buffer and sizes, so that a const
+     *  peek or saveSnapshot can heapify a lazy queue
+     *  and saveSnapshot can flush the buffer first.
      */
-    PQEntry *queue;
+    mutable PQEntry *queue;
 
     /*
      *  Integer: kInitialCapacity
@@ -236,19 +341,106 @@ private:
      */
     static const int kZeroBaseOffset = 1;
 
+    /*
+     *  Integer: kBufferCapacity
+     *  - - - - - - - - - - - - - -
+     *  Entries the insertion buffer holds before
+     *  it is flushed into the tree.
+     */
+    static const int kBufferCapacity = 32;
+
     /*
      *  Integer: queueCapacity
      *  - - - - - - - - - - - - - -
      *  Max size of array.
      */
-    int queueCapacity;
+    mutable int queueCapacity;
     
     /*
      *  Integer: kZeroBaseOffset
      *  - - - - - - - - - - - - - -
      *  Current number of items in array.
      */
-    int queueSize;
+    mutable int queueSize;
+
+    /*
+     *  HeapInsertMode: mode
+     *  - - - - - - - - - - - - - -
+     *  How new entries reach the tree.
+     */
+    HeapInsertMode mode;
+
+    /*
+     *  Array: buffer
+     *  - - - - - - - - - - - - - -
+     *  Unsorted insertion buffer of kBufferCapacity
+     *  entries, or NULL unless the queue is buffered,
+     *  with its number of entries and the index of
+     *  the highest priority one among them.
+     */
+    mutable PQEntry *buffer;
+    mutable int bufferSize;
+    mutable int bufferMinIndex;
+
+    /*
+     *  Integer: unheapified
+     *  - - - - - - - - - - - - - -
+     *  Number of entries at the end of the array
+     *  that a lazy queue has not heapified yet.
+     */
+    mutable int unheapified;
+
+    /*
+     *  MemoryResource Pointer: resource
+     *  - - - - - - - - - - - - - -
+     *  Where the arrays are allocated.
+     */
+    MemoryResource *resource;
+
+    /*
+     *  TieBreakPolicy: policy
+     *  - - - - - - - - - - - - - -
+     *  The tie-break policy in effect when the queue
+     *  was constructed, stamped on each entry.
+     */
+    TieBreakPolicy policy;
+
+    /*
+     *  Integer: enqueueCount
+     *  - - - - - - - - - - - - - -
+     *  The sequence the queue stamps on the next entry it
+     *  enqueues, so entries are numbered per queue.
+     */
+    unsigned long long enqueueCount;
 };
 
+/*
+ *  Class: BufferedHeapPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  A HeapPriorityQueue in HEAP_INSERT_BUFFERED mode,
+ *  for code that constructs its queues by type.
+ */
+class BufferedHeapPriorityQueue : public HeapPriorityQueue {
+public:
+    explicit BufferedHeapPriorityQueue(MemoryResource *resource = defaultMemoryResource())
+        : HeapPriorityQueue(HEAP_INSERT_BUFFERED, resource) {}
+};
+
+/*
+ *  Class: LazyHeapPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  A HeapPriorityQueue in HEAP_INSERT_LAZY mode,
+ *  for code that constructs its queues by type.
+ */
+class LazyHeapPriorityQueue : public HeapPriorityQueue {
+public:
+    explicit LazyHeapPriorityQueue(MemoryResource *resource = defaultMemoryResource())
+        : HeapPriorityQueue(HEAP_INSERT_LAZY, resource) {}
+};
+
+template <typename... Args>
+void HeapPriorityQueue::emplace(int priority, Args&&... args) {
+    enqueue(string(std::forward<Args>(args)...), priority);
+}
+
 #endif
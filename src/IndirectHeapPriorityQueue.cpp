@@ -0,0 +1,195 @@
+/*
+ *  File: IndirectHeapPriorityQueue.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the IndirectHeapPriorityQueue.
+ */
+
+#include "IndirectHeapPriorityQueue.h"
+#include <utility>    // for move
+
+IndirectHeapPriorityQueue::IndirectHeapPriorityQueue(MemoryResource *resource)
+    : slots(ResourceAllocator<Slot>(resource)), heap(ResourceAllocator<HeapNode>(resource)) {
+    freeHead = kNoSlot;
+    policy = getTieBreakPolicy();
+    enqueueCount = 0;
+}
+
+IndirectHeapPriorityQueue::~IndirectHeapPriorityQueue() {
+
+}
+
+void IndirectHeapPriorityQueue::clear() {
+    slots.clear();
+    heap.clear();
+    freeHead = kNoSlot;
+    policy = getTieBreakPolicy();
+    enqueueCount = 0;
+}
+
+string IndirectHeapPriorityQueue::dequeue() {
+    string value;
+    if(!tryDequeue(value)) error("The queue is empty");
+    return value;
+}
+
+bool IndirectHeapPriorityQueue::isEmpty() const {
+    return heap.empty();
+}
+
+const string& IndirectHeapPriorityQueue::peek() const {
+    const string *value = tryPeek();
+    if(value == NULL) error("The queue is empty");
+    return *value;
+}
+
+int IndirectHeapPriorityQueue::peekPriority() const {
+    int priority = 0;
+    if(!tryPeekPriority(priority)) error("The queue is empty");
+    return priority;
+}
+
+int IndirectHeapPriorityQueue::size() const {
+    return heap.size();
+}
+
+bool IndirectHeapPriorityQueue::tryDequeue(string& value) {
+    if(heap.empty()) return false;
+    value = removeAt(0);
+    return true;
+}
+
+const string* IndirectHeapPriorityQueue::tryPeek() const {
+    if(heap.empty()) return NULL;
+    return &slots[heap[0].slot].entry.value;
+}
+
+bool IndirectHeapPriorityQueue::tryPeekPriority(int& priority) const {
+    if(heap.empty()) return false;
+    priority = heap[0].priority;
+    return true;
+}
+
+IndirectHeapPriorityQueue::Handle IndirectHeapPriorityQueue::enqueue(const string& value, int priority) {
+    return enqueue(string(value), priority);
+}
+
+IndirectHeapPriorityQueue::Handle IndirectHeapPriorityQueue::enqueue(string&& value, int priority) {
+    Handle handle = freeHead;
+    if(handle != kNoSlot) {
+        freeHead = slots[handle].nextFree;
+        slots[handle].entry = PQEntry(std::move(value), priority, policy, enqueueCount++);
+    } else {
+        handle = slots.size();
+        Slot slot = {PQEntry(std::move(value), priority, policy, enqueueCount++), kFreeSlot, kNoSlot};
+        slots.push_back(std::move(slot));
+    }
+    HeapNode node = {priority, handle};
+    slots[handle].heapIndex = heap.size();
+    heap.push_back(node);
+    siftUp(heap.size() - 1);
+    return handle;
+}
+
+void IndirectHeapPriorityQueue::changePriority(Handle handle, int priority) {
+    checkedSlot(handle);
+    Slot& slot = slots[handle];
+    int oldPriority = slot.entry.priority;
+    slot.entry.priority = priority;
+    heap[slot.heapIndex].priority = priority;
+    if(priority < oldPriority) {
+        siftUp(slot.heapIndex);
+    } else {
+        siftDown(slot.heapIndex);
+    }
+}
+
+bool IndirectHeapPriorityQueue::contains(Handle handle) const {
+    return handle < slots.size() && slots[handle].heapIndex != kFreeSlot;
+}
+
+IndirectHeapPriorityQueue::Handle IndirectHeapPriorityQueue::peekHandle() const {
+    if(heap.empty()) error("The queue is empty");
+    return heap[0].slot;
+}
+
+int IndirectHeapPriorityQueue::priorityOf(Handle handle) const {
+    return checkedSlot(handle).entry.priority;
+}
+
+const string& IndirectHeapPriorityQueue::valueOf(Handle handle) const {
+    return checkedSlot(handle).entry.value;
+}
+
+string IndirectHeapPriorityQueue::remove(Handle handle) {
+    return removeAt(checkedSlot(handle).heapIndex);
+}
+
+const IndirectHeapPriorityQueue::Slot& IndirectHeapPriorityQueue::checkedSlot(Handle handle) const {
+    if(!contains(handle)) error("IndirectHeapPriorityQueue: the handle is not queued");
+    return slots[handle];
+}
+
+void IndirectHeapPriorityQueue::freeSlot(Handle handle) {
+    slots[handle].heapIndex = kFreeSlot;
+    slots[handle].nextFree = freeHead;
+    freeHead = handle;
+}
+
+bool IndirectHeapPriorityQueue::lessThan(const HeapNode& first, const HeapNode& second) const {
+    PQ_COUNT(comparisons);
+    if(first.priority != second.priority) return first.priority < second.priority;
+    const PQEntry& firstEntry = slots[first.slot].entry;
+    const PQEntry& secondEntry = slots[second.slot].entry;
+    return breaksTieBefore(firstEntry.value, firstEntry.sequence,
+                           secondEntry.value, secondEntry.sequence, policy);
+}
+
+string IndirectHeapPriorityQueue::removeAt(int index) {
+    Handle handle = heap[index].slot;
+    string value = std::move(slots[handle].entry.value);
+    freeSlot(handle);
+    int last = heap.size() - 1;
+    if(index != last) {
+        heap[index] = heap[last];
+        slots[heap[index].slot].heapIndex = index;
+    }
+    heap.pop_back();
+    /*
+     *  The node moved into the hole came from the bottom,
+     *  but from another subtree, so it may need to go
+     *  either way.
+     */
+    if(index < last) {
+        siftDown(index);
+        siftUp(index);
+    }
+    return value;
+}
+
+void IndirectHeapPriorityQueue::siftDown(int index) {
+    HeapNode node = heap[index];
+    int count = heap.size();
+    while(2 * index + 1 < count) {
+        int child = 2 * index + 1;
+        if(child + 1 < count && lessThan(heap[child + 1], heap[child])) child++;
+        if(!lessThan(heap[child], node)) break;
+        PQ_COUNT(levels);
+        heap[index] = heap[child];
+        slots[heap[index].slot].heapIndex = index;
+        index = child;
+    }
+    heap[index] = node;
+    slots[node.slot].heapIndex = index;
+}
+
+void IndirectHeapPriorityQueue::siftUp(int index) {
+    HeapNode node = heap[index];
+    while(index > 0 && lessThan(node, heap[(index - 1) / 2])) {
+        PQ_COUNT(levels);
+        heap[index] = heap[(index - 1) / 2];
+        slots[heap[index].slot].heapIndex = index;
+        index = (index - 1) / 2;
+    }
+    heap[index] = node;
+    slots[node.slot].heapIndex = index;
+}
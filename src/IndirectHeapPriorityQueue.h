@@ -0,0 +1,266 @@
+/*
+ *  File: IndirectHeapPriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the IndirectHeapPriorityQueue,
+ *  a binary heap of slot indices over entries that
+ *  stay put, whose slots serve as handles.
+ */
+
+#ifndef _indirectheappriorityqueue_h
+#define _indirectheappriorityqueue_h
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>    // for forward
+#include <vector>
+#include "MemoryResource.h"
+#include "PQEntry.h"
+#include "error.h"
+using namespace std;
+
+/*
+ *  Class: IndirectHeapPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class keeps each entry in a slot of a stable
+ *  array, reusing freed slots through a free list, and
+ *  orders them with a binary heap whose nodes hold only
+ *  a 32-bit slot index and a copy of the priority. A sift
+ *  moves those 8-byte nodes, however large the values,
+ *  and compares the priority copies in the heap array
+ *  itself, reaching into the slots only to break ties.
+ *
+ *  Because an entry never leaves its slot, enqueue
+ *  returns the slot index as a handle, through which the
+ *  entry can later be removed or given a new priority in
+ *  logarithmic time. A handle is good until its entry is
+ *  dequeued or removed; after that the slot may be reused.
+ */
+class IndirectHeapPriorityQueue {
+public:
+    /*
+     *  Type: Handle
+     *  - - - - - - - - - - - - - - - - - -
+     *  The slot index of an entry.
+     */
+    typedef uint32_t Handle;
+
+    /*
+     *  Constructor: IndirectHeapPriorityQueue
+     *  Parameters: MemoryResource *resource
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes a new, empty IndirectHeapPriorityQueue
+     *  whose slots and heap grow into arrays from the
+     *  given resource.
+     */
+    explicit IndirectHeapPriorityQueue(MemoryResource *resource = defaultMemoryResource());
+
+    /*
+     *  Destructor: ~IndirectHeapPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Frees the slots and the heap.
+     */
+    ~IndirectHeapPriorityQueue();
+
+    /*
+     *  Methods: clear, dequeue, isEmpty, peek, peekPriority,
+     *           size, tryDequeue, tryPeek, tryPeekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Work as in HeapPriorityQueue. A dequeued entry's slot
+     *  goes on the free list; clear frees every slot.
+     */
+    void clear();
+    string dequeue();
+    bool isEmpty() const;
+    const string& peek() const;
+    int peekPriority() const;
+    int size() const;
+    bool tryDequeue(string& value);
+    const string* tryPeek() const;
+    bool tryPeekPriority(int& priority) const;
+
+    /*
+     *  Method: enqueue
+     *  Parameters: string value
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Stores the item in a free slot, or a new one if none
+     *  is free, sifts its index up the heap and returns the
+     *  slot as the item's handle. A value passed as an
+     *  rvalue is moved into its slot rather than copied.
+     */
+    Handle enqueue(const string& value, int priority);
+    Handle enqueue(string&& value, int priority);
+
+    /*
+     *  Method: emplace
+     *  Parameters: int priority
+     *              Args&&... args
+     *  - - - - - - - - - - - - - - - - - -
+     *  Enqueues a value constructed from args at the given
+     *  priority and returns its handle.
+     */
+    template <typename... Args>
+    Handle emplace(int priority, Args&&... args);
+
+    /*
+     *  Method: changePriority
+     *  Parameters: Handle handle
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Gives the queued item a new priority and sifts its
+     *  index up, for a decrease-key, or down otherwise.
+     */
+    void changePriority(Handle handle, int priority);
+
+    /*
+     *  Method: contains
+     *  Parameters: Handle handle
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns whether the handle names a queued item.
+     */
+    bool contains(Handle handle) const;
+
+    /*
+     *  Method: peekHandle
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the handle of the highest priority item.
+     */
+    Handle peekHandle() const;
+
+    /*
+     *  Methods: priorityOf, valueOf
+     *  Parameters: Handle handle
+     *  - - - - - - - - - - - - - - - - - -
+     *  Return the priority or the value of a queued item.
+     */
+    int priorityOf(Handle handle) const;
+    const string& valueOf(Handle handle) const;
+
+    /*
+     *  Method: remove
+     *  Parameters: Handle handle
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes a queued item from anywhere in the heap and
+     *  returns its value.
+     */
+    string remove(Handle handle);
+
+private:
+    IndirectHeapPriorityQueue(const IndirectHeapPriorityQueue& other);
+    IndirectHeapPriorityQueue& operator =(const IndirectHeapPriorityQueue& other);
+
+    /*
+     *  Struct: Slot
+     *  - - - - - - - - - - - - - - - - - -
+     *  An entry and the position of its node in the heap,
+     *  or kFreeSlot, in which case nextFree links it to the
+     *  next free slot.
+     */
+    struct Slot {
+        PQEntry entry;
+        int heapIndex;
+        Handle nextFree;
+    };
+
+    /*
+     *  Struct: HeapNode
+     *  - - - - - - - - - - - - - - - - - -
+     *  A node of the heap: a copy of the entry's priority,
+     *  so most comparisons stay in the heap array, and the
+     *  index of its slot.
+     */
+    struct HeapNode {
+        int priority;
+        Handle slot;
+    };
+
+    /*
+     *  Method: checkedSlot
+     *  Parameters: Handle handle
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the slot of a queued item, or reports an
+     *  error if the handle does not name one.
+     */
+    const Slot& checkedSlot(Handle handle) const;
+
+    /*
+     *  Method: freeSlot
+     *  Parameters: Handle handle
+     *  - - - - - - - - - - - - - - - - - -
+     *  Pushes a slot whose node has left the heap onto
+     *  the free list.
+     */
+    void freeSlot(Handle handle);
+
+    /*
+     *  Method: lessThan
+     *  Parameters: const HeapNode& first
+     *              const HeapNode& second
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns whether the first node is more urgent,
+     *  comparing the priority copies and, only on a tie,
+     *  the entries by the tie-break policy.
+     */
+    bool lessThan(const HeapNode& first, const HeapNode& second) const;
+
+    /*
+     *  Method: removeAt
+     *  Parameters: int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Takes the node at index out of the heap, filling the
+     *  hole with the last node, and frees its slot after
+     *  moving the value out.
+     */
+    string removeAt(int index);
+
+    /*
+     *  Method: siftDown, siftUp
+     *  Parameters: int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Move the node at index down past its more urgent
+     *  children, or up past its less urgent parents,
+     *  keeping each moved node's slot pointing at it.
+     */
+    void siftDown(int index);
+    void siftUp(int index);
+
+    /*
+     *  Integer: kFreeSlot
+     *  - - - - - - - - - - - - - -
+     *  The heap index of a slot that holds no entry.
+     */
+    static const int kFreeSlot = -1;
+
+    /*
+     *  Handle: kNoSlot
+     *  - - - - - - - - - - - - - -
+     *  Ends the free list.
+     */
+    static const Handle kNoSlot = UINT32_MAX;
+
+    /*
+     *  Vector: slots
+     *  - - - - - - - - - - - - - - - - - -
+     *  Every slot ever used, queued or free.
+     */
+    vector<Slot, ResourceAllocator<Slot> > slots;
+
+    /*
+     *  Vector: heap
+     *  - - - - - - - - - - - - - - - - - -
+     *  The nodes, as a 0-based binary min-heap.
+     */
+    vector<HeapNode, ResourceAllocator<HeapNode> > heap;
+
+    Handle freeHead;
+    TieBreakPolicy policy;
+    unsigned long long enqueueCount;
+};
+
+template <typename... Args>
+IndirectHeapPriorityQueue::Handle IndirectHeapPriorityQueue::emplace(int priority, Args&&... args) {
+    return enqueue(string(std::forward<Args>(args)...), priority);
+}
+
+#endif
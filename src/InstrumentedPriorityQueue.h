@@ -0,0 +1,149 @@
+/*
+ *  File: InstrumentedPriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the InstrumentedPriorityQueue,
+ *  which wraps any of the priority queues and records
+ *  the latency of every call in histograms.
+ */
+
+#ifndef _instrumentedpriorityqueue_h
+#define _instrumentedpriorityqueue_h
+
+#include <iostream>
+#include <string>
+#include <utility>    // for move
+#include "LatencyHistogram.h"
+using namespace std;
+
+/*
+ *  Class: InstrumentedPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class forwards each public method to a queue of
+ *  type PQueue, timing the call with the cycle counter and
+ *  recording it in that method's LatencyHistogram. Wrapping
+ *  a queue is the only way to turn profiling on, so queues
+ *  that are not wrapped pay nothing for it.
+ *
+ *  The histograms are thread-local and shared by every
+ *  instrumented queue of the same type on a thread, so
+ *  recording takes no lock; each thread reports its own
+ *  profile, and profiles can be combined with merge.
+ */
+template <typename PQueue>
+class InstrumentedPriorityQueue {
+public:
+    /*
+     *  Methods: clear, dequeue, enqueue, isEmpty,
+     *           peek, peekPriority, size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Forward to the queue, recording the latency of the call.
+     *  An rvalue value is moved into the queue.
+     */
+    void clear();
+    string dequeue();
+    void enqueue(const string& value, int priority);
+    void enqueue(string&& value, int priority);
+    bool isEmpty() const;
+    string peek() const;
+    int peekPriority() const;
+    int size() const;
+
+    /*
+     *  Methods: tryDequeue, tryPeek, tryPeekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Forward to the queue's try* methods, recording their
+     *  latency with dequeue, peek and peekPriority, so an
+     *  instrumented consumer loop need not throw on empty.
+     */
+    bool tryDequeue(string& value);
+    const string* tryPeek() const;
+    bool tryPeekPriority(int& priority) const;
+
+    /*
+     *  Method: latencies
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the calling thread's profile for this queue
+     *  type, which can be printed with printLatencyReport
+     *  or cleared to start a new measurement.
+     */
+    static LatencyProfile& latencies();
+
+private:
+    PQueue queue;
+};
+
+/* Implementation section */
+
+template <typename PQueue>
+void InstrumentedPriorityQueue<PQueue>::clear() {
+    LatencyScope scope(latencies().ops[LATENCY_CLEAR]);
+    queue.clear();
+}
+
+template <typename PQueue>
+string InstrumentedPriorityQueue<PQueue>::dequeue() {
+    LatencyScope scope(latencies().ops[LATENCY_DEQUEUE]);
+    return queue.dequeue();
+}
+
+template <typename PQueue>
+void InstrumentedPriorityQueue<PQueue>::enqueue(const string& value, int priority) {
+    LatencyScope scope(latencies().ops[LATENCY_ENQUEUE]);
+    queue.enqueue(value, priority);
+}
+
+template <typename PQueue>
+void InstrumentedPriorityQueue<PQueue>::enqueue(string&& value, int priority) {
+    LatencyScope scope(latencies().ops[LATENCY_ENQUEUE]);
+    queue.enqueue(std::move(value), priority);
+}
+
+template <typename PQueue>
+bool InstrumentedPriorityQueue<PQueue>::isEmpty() const {
+    LatencyScope scope(latencies().ops[LATENCY_IS_EMPTY]);
+    return queue.isEmpty();
+}
+
+template <typename PQueue>
+string InstrumentedPriorityQueue<PQueue>::peek() const {
+    LatencyScope scope(latencies().ops[LATENCY_PEEK]);
+    return queue.peek();
+}
+
+template <typename PQueue>
+int InstrumentedPriorityQueue<PQueue>::peekPriority() const {
+    LatencyScope scope(latencies().ops[LATENCY_PEEK_PRIORITY]);
+    return queue.peekPriority();
+}
+
+template <typename PQueue>
+int InstrumentedPriorityQueue<PQueue>::size() const {
+    LatencyScope scope(latencies().ops[LATENCY_SIZE]);
+    return queue.size();
+}
+
+template <typename PQueue>
+bool InstrumentedPriorityQueue<PQueue>::tryDequeue(string& value) {
+    LatencyScope scope(latencies().ops[LATENCY_DEQUEUE]);
+    return queue.tryDequeue(value);
+}
+
+template <typename PQueue>
+const string* InstrumentedPriorityQueue<PQueue>::tryPeek() const {
+    LatencyScope scope(latencies().ops[LATENCY_PEEK]);
+    return queue.tryPeek();
+}
+
+template <typename PQueue>
+bool InstrumentedPriorityQueue<PQueue>::tryPeekPriority(int& priority) const {
+    LatencyScope scope(latencies().ops[LATENCY_PEEK_PRIORITY]);
+    return queue.tryPeekPriority(priority);
+}
+
+template <typename PQueue>
+LatencyProfile& InstrumentedPriorityQueue<PQueue>::latencies() {
+    static thread_local LatencyProfile profile;
+    return profile;
+}
+
+#endif
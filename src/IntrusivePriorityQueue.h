@@ -0,0 +1,390 @@
+/*
+ *  File: IntrusivePriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the IntrusivePriorityQueue, a
+ *  priority queue of objects the caller owns, linked
+ *  together through a hook embedded in each one so
+ *  that the queue itself never allocates.
+ */
+
+#ifndef _intrusivepriorityqueue_h
+#define _intrusivepriorityqueue_h
+
+#include <functional> // for less
+#include "OperationCounters.h"
+#include "error.h"
+using namespace std;
+
+/*
+ *  Struct: IntrusiveHeapHook
+ *  - - - - - - - - - - - - - - -
+ *  The links an object needs to sit in an
+ *  IntrusivePriorityQueue. Objects derive from it;
+ *  its fields belong to the queue and are null while
+ *  the object is not queued.
+ */
+struct IntrusiveHeapHook {
+    IntrusiveHeapHook() : left(NULL), right(NULL), parent(NULL) {}
+
+    IntrusiveHeapHook *left;
+    IntrusiveHeapHook *right;
+    IntrusiveHeapHook *parent;
+};
+
+/*
+ *  Class: IntrusivePriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class keeps a binary min-heap of objects of
+ *  type T, which must derive from IntrusiveHeapHook,
+ *  ordered by Less so the least object is the most
+ *  urgent. Rather than an array, the heap is a complete
+ *  binary tree linked through the hooks: the path to the
+ *  last position is read off the bits of the size, and
+ *  sifting swaps the links of two objects. The objects
+ *  are never copied or moved, so pointers to them stay
+ *  valid, and an object can be removed or reprioritized
+ *  in O(log n) through its own hook, as timer and
+ *  scheduler code needs.
+ *
+ *  The caller must keep each object alive while it is
+ *  queued, and call update after changing anything Less
+ *  looks at.
+ */
+template <typename T, typename Less = less<T> >
+class IntrusivePriorityQueue {
+public:
+    /*
+     *  Constructor: IntrusivePriorityQueue
+     *  Parameters: const Less& less
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes an empty queue ordered by less.
+     */
+    IntrusivePriorityQueue(const Less& less = Less());
+
+    /*
+     *  Destructor: ~IntrusivePriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Unlinks any objects still queued.
+     */
+    ~IntrusivePriorityQueue();
+
+    /*
+     *  Method: clear
+     *  - - - - - - - - - - - - - - - - - -
+     *  Unlinks every object, in time linear in the size.
+     */
+    void clear();
+
+    /*
+     *  Method: contains
+     *  Parameters: const T& item
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns whether the object is in this queue,
+     *  assuming it is in no other.
+     */
+    bool contains(const T& item) const;
+
+    /*
+     *  Method: dequeue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Unlinks the most urgent object and returns it.
+     */
+    T& dequeue();
+
+    /*
+     *  Method: enqueue
+     *  Parameters: T& item
+     *  - - - - - - - - - - - - - - - - - -
+     *  Links an object that is not queued into the heap.
+     */
+    void enqueue(T& item);
+
+    /*
+     *  Method: isEmpty
+     *  - - - - - - - - - - - - - - - - - -
+     *  Determines whether the queue is empty.
+     */
+    bool isEmpty() const;
+
+    /*
+     *  Method: peek
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the most urgent object without unlinking it.
+     */
+    T& peek() const;
+
+    /*
+     *  Method: remove
+     *  Parameters: T& item
+     *  - - - - - - - - - - - - - - - - - -
+     *  Unlinks a queued object from anywhere in the heap.
+     */
+    void remove(T& item);
+
+    /*
+     *  Method: size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the number of objects queued.
+     */
+    int size() const;
+
+    /*
+     *  Method: update
+     *  Parameters: T& item
+     *  - - - - - - - - - - - - - - - - - -
+     *  Moves a queued object whose priority has changed
+     *  up or down to its new place.
+     */
+    void update(T& item);
+
+private:
+    IntrusivePriorityQueue(const IntrusivePriorityQueue& other);
+    IntrusivePriorityQueue& operator =(const IntrusivePriorityQueue& other);
+
+    /*
+     *  Method: lessThan
+     *  Parameters: IntrusiveHeapHook *first
+     *              IntrusiveHeapHook *second
+     *  - - - - - - - - - - - - - - - - - -
+     *  Compares the objects the two hooks belong to.
+     */
+    bool lessThan(IntrusiveHeapHook *first, IntrusiveHeapHook *second) const;
+
+    /*
+     *  Method: pathTo
+     *  Parameters: int position
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the link that holds the node at the given
+     *  1-based position in the complete tree, following
+     *  the bits of the position below its highest one,
+     *  from the top: 0 for left and 1 for right.
+     */
+    IntrusiveHeapHook **pathTo(int position);
+
+    /*
+     *  Method: siftDown, siftUp
+     *  Parameters: IntrusiveHeapHook *node
+     *  - - - - - - - - - - - - - - - - - -
+     *  Swap the node with its smaller child, or with its
+     *  parent, for as long as they are out of order.
+     */
+    void siftDown(IntrusiveHeapHook *node);
+    void siftUp(IntrusiveHeapHook *node);
+
+    /*
+     *  Method: swapWithParent
+     *  Parameters: IntrusiveHeapHook *child
+     *  - - - - - - - - - - - - - - - - - -
+     *  Exchanges a node and its parent in the tree by
+     *  relinking the two and their neighbors.
+     */
+    void swapWithParent(IntrusiveHeapHook *child);
+
+    /*
+     *  Method: unlinkAll
+     *  Parameters: IntrusiveHeapHook *node
+     *  - - - - - - - - - - - - - - - - - -
+     *  Clears the hooks of a subtree.
+     */
+    static void unlinkAll(IntrusiveHeapHook *node);
+
+    IntrusiveHeapHook *root;
+    int count;
+    Less compare;
+};
+
+/* Implementation section */
+
+template <typename T, typename Less>
+IntrusivePriorityQueue<T, Less>::IntrusivePriorityQueue(const Less& less) : compare(less) {
+    root = NULL;
+    count = 0;
+}
+
+template <typename T, typename Less>
+IntrusivePriorityQueue<T, Less>::~IntrusivePriorityQueue() {
+    clear();
+}
+
+template <typename T, typename Less>
+void IntrusivePriorityQueue<T, Less>::clear() {
+    unlinkAll(root);
+    root = NULL;
+    count = 0;
+}
+
+template <typename T, typename Less>
+bool IntrusivePriorityQueue<T, Less>::contains(const T& item) const {
+    const IntrusiveHeapHook *hook = &item;
+    return hook->parent != NULL || hook == root;
+}
+
+template <typename T, typename Less>
+T& IntrusivePriorityQueue<T, Less>::dequeue() {
+    if(count == 0) error("The queue is empty");
+    T& item = static_cast<T&>(*root);
+    remove(item);
+    return item;
+}
+
+template <typename T, typename Less>
+void IntrusivePriorityQueue<T, Less>::enqueue(T& item) {
+    if(contains(item)) error("IntrusivePriorityQueue: the item is already queued");
+    IntrusiveHeapHook *node = &item;
+    node->left = NULL;
+    node->right = NULL;
+    count++;
+    IntrusiveHeapHook **link = pathTo(count);
+    node->parent = (count == 1) ? NULL : pathTo(count / 2)[0];
+    *link = node;
+    siftUp(node);
+}
+
+template <typename T, typename Less>
+bool IntrusivePriorityQueue<T, Less>::isEmpty() const {
+    return count == 0;
+}
+
+template <typename T, typename Less>
+T& IntrusivePriorityQueue<T, Less>::peek() const {
+    if(count == 0) error("The queue is empty");
+    return static_cast<T&>(*root);
+}
+
+template <typename T, typename Less>
+void IntrusivePriorityQueue<T, Less>::remove(T& item) {
+    if(!contains(item)) error("IntrusivePriorityQueue: the item is not queued");
+    IntrusiveHeapHook *node = &item;
+    /*
+     *  Detach the last node, then put it in the removed
+     *  node's place and sift it whichever way it needs.
+     */
+    IntrusiveHeapHook **lastLink = pathTo(count);
+    IntrusiveHeapHook *last = *lastLink;
+    *lastLink = NULL;
+    count--;
+    if(last != node) {
+        last->left = node->left;
+        last->right = node->right;
+        last->parent = node->parent;
+        if(last->left != NULL) last->left->parent = last;
+        if(last->right != NULL) last->right->parent = last;
+        if(node->parent == NULL) {
+            root = last;
+        } else if(node->parent->left == node) {
+            node->parent->left = last;
+        } else {
+            node->parent->right = last;
+        }
+        siftDown(last);
+        siftUp(last);
+    } else if(node == root) {
+        root = NULL;
+    }
+    node->left = NULL;
+    node->right = NULL;
+    node->parent = NULL;
+}
+
+template <typename T, typename Less>
+int IntrusivePriorityQueue<T, Less>::size() const {
+    return count;
+}
+
+template <typename T, typename Less>
+void IntrusivePriorityQueue<T, Less>::update(T& item) {
+    if(!contains(item)) error("IntrusivePriorityQueue: the item is not queued");
+    siftUp(&item);
+    siftDown(&item);
+}
+
+template <typename T, typename Less>
+bool IntrusivePriorityQueue<T, Less>::lessThan(IntrusiveHeapHook *first,
+                                               IntrusiveHeapHook *second) const {
+    PQ_COUNT(comparisons);
+    return compare(static_cast<const T&>(*first), static_cast<const T&>(*second));
+}
+
+template <typename T, typename Less>
+IntrusiveHeapHook **IntrusivePriorityQueue<T, Less>::pathTo(int position) {
+    int bit = 1;
+    while(bit <= position / 2) {
+        bit *= 2;
+    }
+    IntrusiveHeapHook **link = &root;
+    for(bit /= 2; bit > 0; bit /= 2) {
+        link = (position & bit) ? &(*link)->right : &(*link)->left;
+    }
+    return link;
+}
+
+template <typename T, typename Less>
+void IntrusivePriorityQueue<T, Less>::siftDown(IntrusiveHeapHook *node) {
+    while(true) {
+        IntrusiveHeapHook *smallest = node;
+        if(node->left != NULL && lessThan(node->left, smallest)) smallest = node->left;
+        if(node->right != NULL && lessThan(node->right, smallest)) smallest = node->right;
+        if(smallest == node) return;
+        PQ_COUNT(levels);
+        swapWithParent(smallest);
+    }
+}
+
+template <typename T, typename Less>
+void IntrusivePriorityQueue<T, Less>::siftUp(IntrusiveHeapHook *node) {
+    while(node->parent != NULL && lessThan(node, node->parent)) {
+        PQ_COUNT(levels);
+        swapWithParent(node);
+    }
+}
+
+template <typename T, typename Less>
+void IntrusivePriorityQueue<T, Less>::swapWithParent(IntrusiveHeapHook *child) {
+    IntrusiveHeapHook *parent = child->parent;
+    IntrusiveHeapHook *grandparent = parent->parent;
+    IntrusiveHeapHook *sibling;
+    IntrusiveHeapHook *childLeft = child->left;
+    IntrusiveHeapHook *childRight = child->right;
+
+    /*
+     *  The child takes the parent's place, keeping the
+     *  parent's other child as its own, and the parent
+     *  takes over the child's children.
+     */
+    if(parent->left == child) {
+        sibling = parent->right;
+        child->left = parent;
+        child->right = sibling;
+    } else {
+        sibling = parent->left;
+        child->left = sibling;
+        child->right = parent;
+    }
+    if(sibling != NULL) sibling->parent = child;
+    child->parent = grandparent;
+    parent->parent = child;
+    parent->left = childLeft;
+    parent->right = childRight;
+    if(childLeft != NULL) childLeft->parent = parent;
+    if(childRight != NULL) childRight->parent = parent;
+
+    if(grandparent == NULL) {
+        root = child;
+    } else if(grandparent->left == parent) {
+        grandparent->left = child;
+    } else {
+        grandparent->right = child;
+    }
+}
+
+template <typename T, typename Less>
+void IntrusivePriorityQueue<T, Less>::unlinkAll(IntrusiveHeapHook *node) {
+    if(node == NULL) return;
+    unlinkAll(node->left);
+    unlinkAll(node->right);
+    node->left = NULL;
+    node->right = NULL;
+    node->parent = NULL;
+}
+
+#endif
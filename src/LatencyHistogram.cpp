@@ -0,0 +1,116 @@
+/*
+ *  File: LatencyHistogram.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the LatencyHistogram and
+ *  the latency report.
+ */
+
+#include "LatencyHistogram.h"
+#include <chrono>
+#include <cmath>      // for ceil
+#include <cstring>
+#include <iomanip>
+
+/*
+ *  How long nanosPerTick watches the cycle counter.
+ */
+static const int kCalibrationMS = 20;
+
+LatencyHistogram::LatencyHistogram() {
+    clear();
+}
+
+void LatencyHistogram::clear() {
+    memset(counts, 0, sizeof(counts));
+    total = 0;
+    largest = 0;
+}
+
+uint64_t LatencyHistogram::count() const {
+    return total;
+}
+
+uint64_t LatencyHistogram::maxTicks() const {
+    return largest;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for(int i = 0; i < kBucketCount; i++) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    if(other.largest > largest) largest = other.largest;
+}
+
+uint64_t LatencyHistogram::percentileTicks(double percentile) const {
+    if(total == 0) return 0;
+    uint64_t rank = (uint64_t) ceil(percentile / 100 * total);
+    if(rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for(int i = 0; i < kBucketCount; i++) {
+        seen += counts[i];
+        if(seen >= rank) {
+            uint64_t top = bucketTop(i);
+            return (top < largest) ? top : largest;
+        }
+    }
+    return largest;
+}
+
+double LatencyHistogram::nanosPerTick() {
+    static double calibrated = 0;
+    if(calibrated == 0) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        uint64_t startTicks = readCycleCounter();
+        chrono::steady_clock::time_point now;
+        do {
+            now = chrono::steady_clock::now();
+        } while(now - start < chrono::milliseconds(kCalibrationMS));
+        uint64_t ticks = readCycleCounter() - startTicks;
+        double nanos = chrono::duration_cast<chrono::nanoseconds>(now - start).count();
+        calibrated = (ticks > 0) ? nanos / ticks : 1;
+    }
+    return calibrated;
+}
+
+uint64_t LatencyHistogram::bucketTop(int index) {
+    if(index < kSubBuckets) return index;
+    int exponent = index / kSubBuckets + kSubBucketBits - 1;
+    uint64_t subBucket = index % kSubBuckets;
+    int shift = exponent - kSubBucketBits;
+    return ((kSubBuckets + subBucket + 1) << shift) - 1;
+}
+
+string latencyOpName(LatencyOp op) {
+    switch(op) {
+        case LATENCY_CLEAR: return "clear";
+        case LATENCY_DEQUEUE: return "dequeue";
+        case LATENCY_ENQUEUE: return "enqueue";
+        case LATENCY_IS_EMPTY: return "isEmpty";
+        case LATENCY_PEEK: return "peek";
+        case LATENCY_PEEK_PRIORITY: return "peekPriority";
+        case LATENCY_SIZE: return "size";
+        default: return "unknown";
+    }
+}
+
+void printLatencyReport(ostream& out, const LatencyProfile& profile) {
+    double scale = LatencyHistogram::nanosPerTick();
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+    out << left << setw(14) << "method" << right << setw(12) << "calls"
+        << setw(12) << "p50 ns" << setw(12) << "p99 ns"
+        << setw(12) << "p99.9 ns" << setw(12) << "max ns" << endl;
+    for(int i = 0; i < LATENCY_OP_COUNT; i++) {
+        const LatencyHistogram& histogram = profile.ops[i];
+        if(histogram.count() == 0) continue;
+        out << left << setw(14) << latencyOpName((LatencyOp) i) << right
+            << setw(12) << histogram.count() << fixed << setprecision(0)
+            << setw(12) << histogram.percentileTicks(50) * scale
+            << setw(12) << histogram.percentileTicks(99) * scale
+            << setw(12) << histogram.percentileTicks(99.9) * scale
+            << setw(12) << histogram.maxTicks() * scale << endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,228 @@
+/*
+ *  File: LatencyHistogram.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the LatencyHistogram, a log-bucketed
+ *  histogram of operation latencies in the style of HDR
+ *  histograms, together with the cycle counter it is fed
+ *  from and the per-operation profile kept by the
+ *  InstrumentedPriorityQueue.
+ */
+
+#ifndef _latencyhistogram_h
+#define _latencyhistogram_h
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+using namespace std;
+
+/*
+ *  Function: readCycleCounter
+ *  - - - - - - - - - - - - - - - - - -
+ *  Returns a fast, monotonic tick count: the time stamp
+ *  counter on x86, the virtual counter on ARM64, and
+ *  steady_clock nanoseconds elsewhere.
+ */
+inline uint64_t readCycleCounter() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r" (ticks));
+    return ticks;
+#else
+    return chrono::duration_cast<chrono::nanoseconds>(
+               chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/*
+ *  Class: LatencyHistogram
+ *  - - - - - - - - - - - - - - -
+ *  This class counts tick values in buckets whose width
+ *  grows with their magnitude: values below 16 are counted
+ *  exactly, and each later power of two is split into 16
+ *  sub-buckets, so every reported value is within 1/16 of
+ *  the true one. The whole 64-bit range fits in a fixed
+ *  array, so recording never allocates and costs a count
+ *  of leading zeros and an increment.
+ */
+class LatencyHistogram {
+public:
+    /*
+     *  Constructor: LatencyHistogram
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes an empty histogram.
+     */
+    LatencyHistogram();
+
+    /*
+     *  Method: clear
+     *  - - - - - - - - - - - - - - - - - -
+     *  Discards every recorded value.
+     */
+    void clear();
+
+    /*
+     *  Method: count
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the number of values recorded.
+     */
+    uint64_t count() const;
+
+    /*
+     *  Method: maxTicks
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the largest value recorded, exactly.
+     */
+    uint64_t maxTicks() const;
+
+    /*
+     *  Method: merge
+     *  Parameters: const LatencyHistogram& other
+     *  - - - - - - - - - - - - - - - - - -
+     *  Adds the values recorded in another histogram,
+     *  such as one kept by another thread.
+     */
+    void merge(const LatencyHistogram& other);
+
+    /*
+     *  Method: percentileTicks
+     *  Parameters: double percentile
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value below which the given percentage of
+     *  recorded values fall, reported as the top of its bucket.
+     *  Returns 0 if nothing has been recorded.
+     */
+    uint64_t percentileTicks(double percentile) const;
+
+    /*
+     *  Method: record
+     *  Parameters: uint64_t ticks
+     *  - - - - - - - - - - - - - - - - - -
+     *  Counts one value.
+     */
+    void record(uint64_t ticks) {
+        counts[bucketIndex(ticks)]++;
+        total++;
+        if(ticks > largest) largest = ticks;
+    }
+
+    /*
+     *  Method: nanosPerTick
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the length of one readCycleCounter tick in
+     *  nanoseconds, measured against steady_clock the first
+     *  time it is called.
+     */
+    static double nanosPerTick();
+
+private:
+    /*
+     *  Method: bucketIndex
+     *  Parameters: uint64_t ticks
+     *  - - - - - - - - - - - - - - - - - -
+     *  Maps a value to its bucket.
+     */
+    static int bucketIndex(uint64_t ticks) {
+        if(ticks < kSubBuckets) return (int) ticks;
+        int exponent = 63 - __builtin_clzll(ticks);
+        return (exponent - kSubBucketBits + 1) * kSubBuckets +
+               (int) ((ticks >> (exponent - kSubBucketBits)) & (kSubBuckets - 1));
+    }
+
+    /*
+     *  Method: bucketTop
+     *  Parameters: int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the largest value counted in the given bucket.
+     */
+    static uint64_t bucketTop(int index);
+
+    static const int kSubBucketBits = 4;
+    static const int kSubBuckets = 1 << kSubBucketBits;
+    static const int kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    uint64_t counts[kBucketCount];
+    uint64_t total;
+    uint64_t largest;
+};
+
+/*
+ *  Enum: LatencyOp
+ *  - - - - - - - - - - - - - - -
+ *  The public queue methods whose latency is profiled.
+ */
+enum LatencyOp {
+    LATENCY_CLEAR,
+    LATENCY_DEQUEUE,
+    LATENCY_ENQUEUE,
+    LATENCY_IS_EMPTY,
+    LATENCY_PEEK,
+    LATENCY_PEEK_PRIORITY,
+    LATENCY_SIZE,
+    LATENCY_OP_COUNT
+};
+
+/*
+ *  Function: latencyOpName
+ *  Parameters: LatencyOp op
+ *  - - - - - - - - - - - - - - - - - -
+ *  Returns the method name of an operation, such as "enqueue".
+ */
+string latencyOpName(LatencyOp op);
+
+/*
+ *  Struct: LatencyProfile
+ *  - - - - - - - - - - - - - - -
+ *  One histogram for each profiled method.
+ */
+struct LatencyProfile {
+    LatencyHistogram ops[LATENCY_OP_COUNT];
+
+    void clear() {
+        for(int i = 0; i < LATENCY_OP_COUNT; i++) {
+            ops[i].clear();
+        }
+    }
+};
+
+/*
+ *  Function: printLatencyReport
+ *  Parameters: ostream& out
+ *              const LatencyProfile& profile
+ *  - - - - - - - - - - - - - - - - - -
+ *  Writes a table of the call count and the p50, p99,
+ *  p99.9 and maximum latency in nanoseconds of each
+ *  method that has been called.
+ */
+void printLatencyReport(ostream& out, const LatencyProfile& profile);
+
+/*
+ *  Class: LatencyScope
+ *  - - - - - - - - - - - - - - -
+ *  Records the ticks between its construction and
+ *  destruction into a histogram, so a method's latency
+ *  is recorded however it returns.
+ */
+class LatencyScope {
+public:
+    LatencyScope(LatencyHistogram& histogram) : histogram(histogram) {
+        start = readCycleCounter();
+    }
+
+    ~LatencyScope() {
+        histogram.record(readCycleCounter() - start);
+    }
+
+private:
+    LatencyHistogram& histogram;
+    uint64_t start;
+};
+
+#endif
@@ -7,50 +7,71 @@
  */
 
 #include "LinkedPriorityQueue.h"
+#include <algorithm>  // for upper_bound
+#include <utility>    // for move
+
+LinkedPriorityQueue::LinkedPriorityQueue(LinkedListMode mode, MemoryResource *resource) {
+    this->mode = mode;
+    this->resource = resource;
+    policy = getTieBreakPolicy();
+    enqueueCount = 0;
+    blocks = NULL;
+    freeBlocks = NULL;
+    freeNodes = NULL;
+    if(mode == LINKED_NODE_PER_ENTRY) {
+        head = newObject<ListNode>(resource);
+        head->next = NULL;
+    }
+}
+
+LinkedPriorityQueue::LinkedPriorityQueue(MemoryResource *resource)
+    : LinkedPriorityQueue(LINKED_NODE_PER_ENTRY, resource) {
 
-LinkedPriorityQueue::LinkedPriorityQueue() {
-    head = new ListNode;
-    head->next = NULL;
 }
 
 LinkedPriorityQueue::~LinkedPriorityQueue() {
-    ListNode *node = head;
-    while(!node) {
-        ListNode *nextNode = node->next;
-        delete node;
-        node = nextNode;
-    }
+    clear();
+    deleteObject(resource, head);
 }
 
 void LinkedPriorityQueue::clear() {
-    ListNode *node = head->next;
-    while(!node) {
-        ListNode *nextNode = node->next;
-        delete node;
-        node = nextNode;
+    if(mode == LINKED_UNROLLED) {
+        while(blocks != NULL) {
+            UnrolledBlock *nextBlock = blocks->next;
+            deleteObject(resource, blocks);
+            blocks = nextBlock;
+        }
+    } else {
+        ListNode *node = head->next;
+        while(node != NULL) {
+            ListNode *nextNode = node->next;
+            deleteObject(resource, node);
+            node = nextNode;
+        }
+        head->next = NULL;
     }
-    head->next = NULL;
+    deleteFreeLists();
 }
 
 string LinkedPriorityQueue::dequeue() {
-    if(head->next == NULL) error("The queue is empty");
-    ListNode *toDequeue = head->next;
-    string value = toDequeue->value;
-    if(toDequeue->next != NULL) {
-        toDequeue->next->prev = head;
-        head->next = toDequeue->next;
-    } else {
-        head->next = NULL;
-    }
-    delete toDequeue;
+    string value;
+    if(!tryDequeue(value)) error("The queue is empty");
     return value;
 }
 
-void LinkedPriorityQueue::enqueue(string value, int priority) {
-    ListNode *insert = new ListNode;
-    insert->value = value;
-    insert->priority = priority;
+void LinkedPriorityQueue::enqueue(const string& value, int priority) {
+    enqueue(string(value), priority);
+}
+
+void LinkedPriorityQueue::enqueue(string&& value, int priority) {
+    if(mode == LINKED_UNROLLED) {
+        enqueueUnrolled(std::move(value), priority);
+        return;
+    }
+    ListNode *insert = newNode(std::move(value), priority);
+    PQ_COUNT(moves);
     for(ListNode *node = head->next; node != NULL; node = node->next) {
+        PQ_COUNT(levels);
         /*
          *  Since ListNode has built-in operators that
          *  determine equality, simply use the
@@ -76,23 +97,230 @@ void LinkedPriorityQueue::enqueue(string value, int priority) {
 }
 
 bool LinkedPriorityQueue::isEmpty() const {
+    if(mode == LINKED_UNROLLED) return blocks == NULL;
     return head->next == NULL;
 }
 
-string LinkedPriorityQueue::peek() const {
-    if(head->next == NULL) error("The queue is empty");
-    return head->next->value;
+void LinkedPriorityQueue::loadSnapshot(string path) {
+    PQSnapshotReader reader(path, SNAPSHOT_SORTED_LIST);
+    enqueueCount = reader.nextSequence();
+    clear();
+    if(mode == LINKED_UNROLLED) {
+        UnrolledBlock *tail = NULL;
+        for(int i = 0; i < reader.size(); i++) {
+            if(tail == NULL || tail->count == kBlockCapacity) {
+                UnrolledBlock *block = newBlock();
+                if(tail == NULL) {
+                    blocks = block;
+                } else {
+                    tail->next = block;
+                }
+                tail = block;
+            }
+            tail->entries[tail->count] = PQEntry(reader.value(i), reader.priority(i), policy, reader.sequence(i));
+            tail->count++;
+        }
+        return;
+    }
+    ListNode *tail = head;
+    for(int i = 0; i < reader.size(); i++) {
+        ListNode *node = newObject<ListNode>(resource, reader.value(i), reader.priority(i), (ListNode *) NULL, tail, policy,
+                                             reader.sequence(i));
+        tail->next = node;
+        tail = node;
+    }
+}
+
+const string& LinkedPriorityQueue::peek() const {
+    const string *value = tryPeek();
+    if(value == NULL) error("The queue is empty");
+    return *value;
 }
 
 int LinkedPriorityQueue::peekPriority() const {
-    if(head->next == NULL) error("The queue is empty");
-    return head->next->priority;
+    int priority = 0;
+    if(!tryPeekPriority(priority)) error("The queue is empty");
+    return priority;
+}
+
+void LinkedPriorityQueue::saveSnapshot(string path) const {
+    PQSnapshotWriter writer(SNAPSHOT_SORTED_LIST);
+    if(mode == LINKED_UNROLLED) {
+        for(UnrolledBlock *block = blocks; block != NULL; block = block->next) {
+            for(int i = block->begin; i < block->begin + block->count; i++) {
+                writer.add(block->entries[i].value, block->entries[i].priority, block->entries[i].sequence);
+            }
+        }
+    } else {
+        for(ListNode *node = head->next; node != NULL; node = node->next) {
+            writer.add(node->value, node->priority, node->sequence);
+        }
+    }
+    writer.save(path);
 }
 
 int LinkedPriorityQueue::size() const {
     int count = 0;
+    if(mode == LINKED_UNROLLED) {
+        for(UnrolledBlock *block = blocks; block != NULL; block = block->next) {
+            count += block->count;
+        }
+        return count;
+    }
     for(ListNode *node = head->next; node != NULL; node = node->next) {
         count++;
     }
     return count;
 }
+
+bool LinkedPriorityQueue::tryDequeue(string& value) {
+    if(mode == LINKED_UNROLLED) {
+        if(blocks == NULL) return false;
+        UnrolledBlock *block = blocks;
+        value = std::move(block->entries[block->begin].value);
+        block->begin++;
+        block->count--;
+        if(block->count == 0) {
+            blocks = block->next;
+            freeBlock(block);
+        }
+        return true;
+    }
+    ListNode *toDequeue = head->next;
+    if(toDequeue == NULL) return false;
+    value = std::move(toDequeue->value);
+    if(toDequeue->next != NULL) {
+        toDequeue->next->prev = head;
+        head->next = toDequeue->next;
+    } else {
+        head->next = NULL;
+    }
+    freeNode(toDequeue);
+    return true;
+}
+
+const string* LinkedPriorityQueue::tryPeek() const {
+    if(mode == LINKED_UNROLLED) {
+        if(blocks == NULL) return NULL;
+        return &blocks->entries[blocks->begin].value;
+    }
+    if(head->next == NULL) return NULL;
+    return &head->next->value;
+}
+
+bool LinkedPriorityQueue::tryPeekPriority(int& priority) const {
+    if(mode == LINKED_UNROLLED) {
+        if(blocks == NULL) return false;
+        priority = blocks->entries[blocks->begin].priority;
+        return true;
+    }
+    if(head->next == NULL) return false;
+    priority = head->next->priority;
+    return true;
+}
+
+void LinkedPriorityQueue::enqueueUnrolled(string&& value, int priority) {
+    PQEntry entry(std::move(value), priority, policy, enqueueCount++);
+    PQ_COUNT(moves);
+    if(blocks == NULL) blocks = newBlock();
+    UnrolledBlock *block = blocks;
+    while(block->next != NULL && !(entry < block->entries[block->begin + block->count - 1])) {
+        PQ_COUNT(levels);
+        block = block->next;
+    }
+    if(block->begin + block->count == kBlockCapacity) {
+        if(block->count < kBlockCapacity) {
+            /*
+             *  Dequeues have left room at the front; slide the
+             *  entries down into it.
+             */
+            for(int i = 0; i < block->count; i++) {
+                block->entries[i] = std::move(block->entries[block->begin + i]);
+                PQ_COUNT(moves);
+            }
+            block->begin = 0;
+        } else if(block->next == NULL && !(entry < block->entries[kBlockCapacity - 1])) {
+            /*
+             *  An entry past the end starts a new last block, so
+             *  entries enqueued in order fill their blocks.
+             */
+            block->next = newBlock();
+            block = block->next;
+        } else {
+            UnrolledBlock *upper = newBlock();
+            int half = kBlockCapacity / 2;
+            for(int i = half; i < kBlockCapacity; i++) {
+                upper->entries[i - half] = std::move(block->entries[i]);
+                PQ_COUNT(moves);
+            }
+            upper->count = kBlockCapacity - half;
+            block->count = half;
+            upper->next = block->next;
+            block->next = upper;
+            if(!(entry < block->entries[half - 1])) block = upper;
+        }
+    }
+    PQEntry *first = block->entries + block->begin;
+    PQEntry *last = first + block->count;
+    PQEntry *position = upper_bound(first, last, entry);
+    for(PQEntry *slot = last; slot != position; slot--) {
+        *slot = std::move(*(slot - 1));
+        PQ_COUNT(moves);
+    }
+    *position = std::move(entry);
+    PQ_COUNT(moves);
+    block->count++;
+}
+
+LinkedPriorityQueue::UnrolledBlock *LinkedPriorityQueue::newBlock() {
+    UnrolledBlock *block = freeBlocks;
+    if(block != NULL) {
+        freeBlocks = block->next;
+    } else {
+        block = newObject<UnrolledBlock>(resource);
+        PQ_COUNT(allocations);
+    }
+    block->next = NULL;
+    block->begin = 0;
+    block->count = 0;
+    return block;
+}
+
+ListNode *LinkedPriorityQueue::newNode(string&& value, int priority) {
+    if(freeNodes == NULL) {
+        PQ_COUNT(allocations);
+        return newObject<ListNode>(resource, std::move(value), priority, (ListNode *) NULL, (ListNode *) NULL, policy,
+                                         enqueueCount++);
+    }
+    ListNode *node = freeNodes;
+    freeNodes = node->next;
+    node->value = std::move(value);
+    node->priority = priority;
+    node->sequence = enqueueCount++;
+    node->next = NULL;
+    node->prev = NULL;
+    return node;
+}
+
+void LinkedPriorityQueue::freeBlock(UnrolledBlock *block) {
+    block->next = freeBlocks;
+    freeBlocks = block;
+}
+
+void LinkedPriorityQueue::freeNode(ListNode *node) {
+    node->next = freeNodes;
+    freeNodes = node;
+}
+
+void LinkedPriorityQueue::deleteFreeLists() {
+    while(freeBlocks != NULL) {
+        UnrolledBlock *nextBlock = freeBlocks->next;
+        deleteObject(resource, freeBlocks);
+        freeBlocks = nextBlock;
+    }
+    while(freeNodes != NULL) {
+        ListNode *nextNode = freeNodes->next;
+        deleteObject(resource, freeNodes);
+        freeNodes = nextNode;
+    }
+}
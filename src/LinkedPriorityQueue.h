@@ -12,11 +12,32 @@
 #include <cstddef>    // for NULL
 #include <iostream>
 #include <string>
+#include <utility>    // for forward
 #include "ListNode.h"
+#include "MemoryResource.h"
 #include "PQEntry.h"
+#include "PQSnapshot.h"
 #include "error.h"
 using namespace std;
 
+/*
+ *  Enum: LinkedListMode
+ *  - - - - - - - - - - - - - - -
+ *  How a LinkedPriorityQueue lays out its list:
+ *
+ *  LINKED_NODE_PER_ENTRY - one doubly-linked ListNode per
+ *                          entry
+ *  LINKED_UNROLLED       - singly-linked blocks that each hold
+ *                          a sorted array of up to 16 entries,
+ *                          so an enqueue walks one block per 16
+ *                          entries and compares only its last
+ *                          entry on the way
+ */
+enum LinkedListMode {
+    LINKED_NODE_PER_ENTRY,
+    LINKED_UNROLLED
+};
+
 /*
  *  Class: LinkedPriorityQueue
  *  - - - - - - - - - - - - - - -
@@ -24,19 +45,28 @@ using namespace std;
  *  that can return pre-prioritized values
  *  using its helper functions. It is designed for
  *  fast dequeueing in constant time, but is
- *  slower to enqueue in linear time.
+ *  slower to enqueue in linear time. Dequeued nodes
+ *  and blocks are kept on a free list for the next
+ *  enqueue, so steady churn does not reach the
+ *  allocator.
  */
 class LinkedPriorityQueue {
 public:
     /*
      *  Constructor: LinkedPriorityQueue
+     *  Parameters: LinkedListMode mode
+     *              MemoryResource *resource
      *  - - - - - - - - - - - - - - - - - -
      *  Initializes a new LinkedPriorityQueue. Since
      *  this class uses a LinkedList to maintain order,
      *  this initializes the ListNode struct referenced
-     *  by the private section's pointer.
+     *  by the private section's pointer, unless the list
+     *  is unrolled. Every node is allocated from the
+     *  given resource.
      */
-    LinkedPriorityQueue();
+    LinkedPriorityQueue(LinkedListMode mode = LINKED_NODE_PER_ENTRY,
+                        MemoryResource *resource = defaultMemoryResource());
+    explicit LinkedPriorityQueue(MemoryResource *resource);
     
     /*
      *  Destructor: ~LinkedPriorityQueue
@@ -53,7 +83,7 @@ public:
      *  Removes all items from LinkedPriorityQueue. Since
      *  this class uses a LinkedList, this requires
      *  each ListNode created to maintain order to be
-     *  deleted.
+     *  deleted, along with those on the free list.
      */    
     void clear();
 
@@ -64,7 +94,7 @@ public:
      *  PriorityQueue and also removes it from the queue.
      *  Since a LinkedList orders the items by highest priority descending,
      *  this simply needs to dequeue the item right after the
-     *  LinkedList's head.
+     *  LinkedList's head. Its value is moved out, not copied.
      */
     string dequeue();
 
@@ -79,9 +109,23 @@ public:
      *  each enqueued must loop through the entirety of the list, and
      *  if it finds its place in between two ListNodes, it must ensure
      *  to insert itself without losing the corresponding memory
-     *  addresses for each side of the chain.
+     *  addresses for each side of the chain. A value passed as
+     *  an rvalue is moved into its node rather than copied.
      */
-    void enqueue(string value, int priority);
+    void enqueue(const string& value, int priority);
+    void enqueue(string&& value, int priority);
+
+    /*
+     *  Method: emplace
+     *  Parameters: int priority
+     *              Args&&... args
+     *  - - - - - - - - - - - - - - - - - -
+     *  Enqueues a value constructed from args at the given
+     *  priority without copying it. The priority comes first
+     *  so that the value's constructor arguments can trail it.
+     */
+    template <typename... Args>
+    void emplace(int priority, Args&&... args);
 
     /*
      *  Method: isEmpty
@@ -92,6 +136,18 @@ public:
      */
     bool isEmpty() const;
 
+    /*
+     *  Method: loadSnapshot
+     *  Parameters: string path
+     *  - - - - - - - - - - - - - - - - - -
+     *  Replaces the contents of the PriorityQueue with those
+     *  of a snapshot written by saveSnapshot. The file is mapped
+     *  into memory and its records, already in list order, are
+     *  appended one after another without searching for
+     *  their place.
+     */
+    void loadSnapshot(string path);
+
     /*
      *  Method: peek
      *  - - - - - - - - - - - - - - - - - -
@@ -99,8 +155,9 @@ public:
      *  PriorityQueue without removing it.
      *  Since a LinkedList is employed, this is as simple as
      *  calling the key value from the first node after the Head.
+     *  The reference is good until the queue is next changed.
      */
-    string peek() const;
+    const string& peek() const;
     
     /*
      *  Method: peekPriority
@@ -112,6 +169,16 @@ public:
      */
     int peekPriority() const;
 
+    /*
+     *  Method: saveSnapshot
+     *  Parameters: string path
+     *  - - - - - - - - - - - - - - - - - -
+     *  Writes the contents of the PriorityQueue to a binary
+     *  snapshot at the given path, one record per ListNode
+     *  in list order.
+     */
+    void saveSnapshot(string path) const;
+
     /*
      *  Method: size
      *  - - - - - - - - - - - - - - - - - -
@@ -122,7 +189,102 @@ public:
      */
     int size() const;
 
+    /*
+     *  Method: tryDequeue
+     *  Parameters: string& value
+     *  - - - - - - - - - - - - - - - - - -
+     *  Moves the value of the highest priority item into value,
+     *  removes the item and returns true, or returns false if
+     *  the PriorityQueue is empty. It never throws, so a consumer
+     *  loop can drain the queue without calling isEmpty first.
+     */
+    bool tryDequeue(string& value);
+
+    /*
+     *  Method: tryPeek
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns a pointer to the value of the highest priority
+     *  item, or NULL if the PriorityQueue is empty, standing in
+     *  for the optional that C++11 lacks.
+     */
+    const string* tryPeek() const;
+
+    /*
+     *  Method: tryPeekPriority
+     *  Parameters: int& priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Stores the priority of the highest priority item in
+     *  priority and returns true, or returns false if the
+     *  PriorityQueue is empty.
+     */
+    bool tryPeekPriority(int& priority) const;
+
 private:
+    LinkedPriorityQueue(const LinkedPriorityQueue& other);
+    LinkedPriorityQueue& operator =(const LinkedPriorityQueue& other);
+
+    /*
+     *  Integer: kBlockCapacity
+     *  - - - - - - - - - - - - - -
+     *  Entries an unrolled block holds. A block spans
+     *  about a dozen cache lines, but a walk past it
+     *  touches only its header and its last entry.
+     */
+    static const int kBlockCapacity = 16;
+
+    /*
+     *  Struct: UnrolledBlock
+     *  - - - - - - - - - - - - - - - - - -
+     *  A node of the unrolled list: its entries in order in
+     *  entries[begin] through entries[begin + count - 1].
+     *  Dequeues advance begin, so the front block gives up
+     *  its entries without shifting the rest. A block in the
+     *  list is never empty.
+     */
+    struct UnrolledBlock {
+        UnrolledBlock *next;
+        int begin;
+        int count;
+        PQEntry entries[kBlockCapacity];
+    };
+
+    /*
+     *  Method: enqueueUnrolled
+     *  Parameters: string&& value
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Walks the blocks to the first whose last entry is
+     *  less urgent than the new one, or the last block, and
+     *  shifts the new entry into its place there, splitting
+     *  the block in two if it is full.
+     */
+    void enqueueUnrolled(string&& value, int priority);
+
+    /*
+     *  Methods: newBlock, newNode
+     *  - - - - - - - - - - - - - - - - - -
+     *  Take a block or node from its free list, or allocate
+     *  one from the resource if the list is empty.
+     */
+    UnrolledBlock *newBlock();
+    ListNode *newNode(string&& value, int priority);
+
+    /*
+     *  Methods: freeBlock, freeNode
+     *  - - - - - - - - - - - - - - - - - -
+     *  Push an unlinked block or node, whose values have
+     *  been moved out, onto its free list.
+     */
+    void freeBlock(UnrolledBlock *block);
+    void freeNode(ListNode *node);
+
+    /*
+     *  Method: deleteFreeLists
+     *  - - - - - - - - - - - - - - - - - -
+     *  Gives everything on the free lists back to the
+     *  resource.
+     */
+    void deleteFreeLists();
 
     /*
      *  ListNode Pointer: head
@@ -133,6 +295,70 @@ private:
      *  and initialized in the constructor.
      */
     ListNode *head = NULL;
+
+    /*
+     *  UnrolledBlock Pointer: blocks
+     *  - - - - - - - - - - - - -
+     *  The first block of an unrolled list, or NULL if the
+     *  list is empty or not unrolled.
+     */
+    UnrolledBlock *blocks;
+
+    /*
+     *  Pointers: freeBlocks, freeNodes
+     *  - - - - - - - - - - - - -
+     *  Blocks and nodes no longer in the list, linked
+     *  through next.
+     */
+    UnrolledBlock *freeBlocks;
+    ListNode *freeNodes;
+
+    /*
+     *  LinkedListMode: mode
+     *  - - - - - - - - - - - - -
+     *  Which of the two lists this queue keeps.
+     */
+    LinkedListMode mode;
+
+    /*
+     *  MemoryResource Pointer: resource
+     *  - - - - - - - - - - - - -
+     *  Where the nodes are allocated.
+     */
+    MemoryResource *resource;
+
+    /*
+     *  TieBreakPolicy: policy
+     *  - - - - - - - - - - - - -
+     *  The tie-break policy in effect when the queue
+     *  was constructed, stamped on each entry.
+     */
+    TieBreakPolicy policy;
+
+    /*
+     *  Integer: enqueueCount
+     *  - - - - - - - - - - - - -
+     *  The sequence the queue stamps on the next entry it
+     *  enqueues, so entries are numbered per queue.
+     */
+    unsigned long long enqueueCount;
+};
+
+/*
+ *  Class: UnrolledLinkedPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  A LinkedPriorityQueue in LINKED_UNROLLED mode,
+ *  for code that constructs its queues by type.
+ */
+class UnrolledLinkedPriorityQueue : public LinkedPriorityQueue {
+public:
+    explicit UnrolledLinkedPriorityQueue(MemoryResource *resource = defaultMemoryResource())
+        : LinkedPriorityQueue(LINKED_UNROLLED, resource) {}
 };
 
+template <typename... Args>
+void LinkedPriorityQueue::emplace(int priority, Args&&... args) {
+    enqueue(string(std::forward<Args>(args)...), priority);
+}
+
 #endif
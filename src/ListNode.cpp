@@ -1,22 +1,34 @@
+/*
+ * CS 106X Priority Queue
+ * This file contains the implementation of the ListNode structure.
+ * See ListNode.h for documentation of each member.
+ */
+
 #include "ListNode.h"
+#include <utility>    // for move
 
-ListNode::ListNode(string value, int priority, ListNode* next, ListNode* prev) {
-    this->value = value;
+ListNode::ListNode(string value, int priority, ListNode* next, ListNode* prev, TieBreakPolicy policy,
+                   unsigned long long sequence) {
+    this->value = std::move(value);
     this->priority = priority;
+    this->policy = policy;
+    this->sequence = sequence;
     this->next = next;
     this->prev = prev;
 }
 
 bool operator <(const ListNode& node1, const ListNode& node2) {
-    return node1.priority < node2.priority ||
-            (node1.priority == node2.priority && node1.value < node2.value);
+    PQ_COUNT(comparisons);
+    if (node1.priority != node2.priority) return node1.priority < node2.priority;
+    return breaksTieBefore(node1.value, node1.sequence, node2.value, node2.sequence, node1.policy);
 }
 
 bool operator <=(const ListNode& node1, const ListNode& node2) {
-    return node1 < node2 || node1 == node2;
+    return !(node2 < node1);
 }
 
 bool operator ==(const ListNode& node1, const ListNode& node2) {
+    PQ_COUNT(comparisons);
     return node1.priority == node2.priority && node1.value == node2.value;
 }
 
@@ -25,7 +37,7 @@ bool operator !=(const ListNode& node1, const ListNode& node2) {
 }
 
 bool operator >(const ListNode& node1, const ListNode& node2) {
-    return !(node1 <= node2);
+    return node2 < node1;
 }
 
 bool operator >=(const ListNode& node1, const ListNode& node2) {
@@ -13,8 +13,9 @@
  * is not the same as printing a pointer to a node, which would just print its
  * memory address as an integer.
  *
- * Please do not modify this provided file. Your turned-in files should work
- * with an unmodified version of all provided code files.
+ * This file began as provided course code and has since been extended:
+ * nodes carry an insertion sequence and break ties among equal priorities
+ * the way PQEntry does, and their comparisons can be counted.
  *
  * Version: Sat 2014/02/14
  * Author : Marty Stepp
@@ -32,10 +33,13 @@ struct ListNode {
 public:
     string value;
     int priority;
+    TieBreakPolicy policy;
+    unsigned long long sequence;
     ListNode* next;
     ListNode* prev;
 
-    ListNode(string value = "", int priority = 0, ListNode* next = NULL, ListNode* prev = NULL);
+    ListNode(string value = "", int priority = 0, ListNode* next = NULL, ListNode* prev = NULL,
+             TieBreakPolicy policy = getTieBreakPolicy(), unsigned long long sequence = 0);
 };
 
 bool operator <(const ListNode& node1, const ListNode& node2);
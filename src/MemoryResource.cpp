@@ -0,0 +1,192 @@
+/*
+ *  File: MemoryResource.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the memory resources.
+ */
+
+#include "MemoryResource.h"
+
+/*
+ *  Class: NewDeleteResource
+ *  - - - - - - - - - - - - - - -
+ *  The default resource. Operator new already returns
+ *  blocks aligned to kMaxAlignment.
+ */
+class NewDeleteResource : public MemoryResource {
+public:
+    void *allocate(size_t bytes, size_t) {
+        return ::operator new(bytes);
+    }
+
+    void deallocate(void *block, size_t, size_t) {
+        ::operator delete(block);
+    }
+};
+
+MemoryResource *defaultMemoryResource() {
+    static NewDeleteResource resource;
+    return &resource;
+}
+
+/*
+ *  Function: alignUp
+ *  Parameters: size_t value
+ *              size_t alignment
+ *  - - - - - - - - - - - - - - - - - -
+ *  Rounds value up to a multiple of alignment.
+ */
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+MonotonicBufferResource::MonotonicBufferResource(size_t initialSize, MemoryResource *upstream) {
+    this->upstream = upstream;
+    chunks = NULL;
+    current = NULL;
+    remaining = 0;
+    nextChunkSize = initialSize > sizeof(Chunk) ? initialSize : kDefaultChunkSize;
+}
+
+MonotonicBufferResource::~MonotonicBufferResource() {
+    release();
+}
+
+void *MonotonicBufferResource::allocate(size_t bytes, size_t alignment) {
+    size_t padding = alignUp((size_t) current, alignment) - (size_t) current;
+    if(current == NULL || padding + bytes > remaining) {
+        size_t headerBytes = alignUp(sizeof(Chunk), kMaxAlignment);
+        size_t chunkBytes = nextChunkSize;
+        while(chunkBytes < headerBytes + bytes) {
+            chunkBytes *= 2;
+        }
+        Chunk *chunk = static_cast<Chunk *>(upstream->allocate(chunkBytes, kMaxAlignment));
+        chunk->next = chunks;
+        chunk->bytes = chunkBytes;
+        chunks = chunk;
+        current = reinterpret_cast<char *>(chunk) + headerBytes;
+        remaining = chunkBytes - headerBytes;
+        nextChunkSize = chunkBytes * 2;
+        padding = 0;
+    }
+    void *block = current + padding;
+    current += padding + bytes;
+    remaining -= padding + bytes;
+    return block;
+}
+
+void MonotonicBufferResource::deallocate(void *, size_t, size_t) {
+
+}
+
+void MonotonicBufferResource::release() {
+    while(chunks != NULL) {
+        Chunk *chunk = chunks;
+        chunks = chunk->next;
+        upstream->deallocate(chunk, chunk->bytes, kMaxAlignment);
+    }
+    current = NULL;
+    remaining = 0;
+}
+
+PoolResource::PoolResource(MemoryResource *upstream) {
+    this->upstream = upstream;
+    for(int i = 0; i < kPoolCount; i++) {
+        freeLists[i] = NULL;
+        chunkBlocks[i] = kFirstChunkBlocks;
+    }
+    chunks = NULL;
+    largeBlocks = NULL;
+}
+
+PoolResource::~PoolResource() {
+    release();
+}
+
+void *PoolResource::allocate(size_t bytes, size_t) {
+    int index = poolIndex(bytes);
+    if(index == kPoolCount) {
+        /*
+         *  Large blocks are linked into a doubly-linked list
+         *  through a header, so deallocate can unlink one
+         *  without a search and release can find them all.
+         */
+        size_t blockBytes = kHeaderBytes + bytes;
+        Link *link = static_cast<Link *>(upstream->allocate(blockBytes, kMaxAlignment));
+        link->bytes = blockBytes;
+        link->previous = NULL;
+        link->next = largeBlocks;
+        if(largeBlocks != NULL) largeBlocks->previous = link;
+        largeBlocks = link;
+        return reinterpret_cast<char *>(link) + kHeaderBytes;
+    }
+    /*
+     *  Blocks sit at multiples of their power-of-two size
+     *  past an aligned header, so each is aligned to any
+     *  type that fits in it.
+     */
+    if(freeLists[index] == NULL) refill(index);
+    Link *block = freeLists[index];
+    freeLists[index] = block->next;
+    return block;
+}
+
+void PoolResource::deallocate(void *block, size_t bytes, size_t) {
+    if(block == NULL) return;
+    int index = poolIndex(bytes);
+    if(index == kPoolCount) {
+        Link *link = reinterpret_cast<Link *>(static_cast<char *>(block) - kHeaderBytes);
+        if(link->previous != NULL) {
+            link->previous->next = link->next;
+        } else {
+            largeBlocks = link->next;
+        }
+        if(link->next != NULL) link->next->previous = link->previous;
+        upstream->deallocate(link, link->bytes, kMaxAlignment);
+        return;
+    }
+    Link *link = static_cast<Link *>(block);
+    link->next = freeLists[index];
+    freeLists[index] = link;
+}
+
+void PoolResource::release() {
+    while(chunks != NULL) {
+        Link *chunk = chunks;
+        chunks = chunk->next;
+        upstream->deallocate(chunk, chunk->bytes, kMaxAlignment);
+    }
+    while(largeBlocks != NULL) {
+        Link *link = largeBlocks;
+        largeBlocks = link->next;
+        upstream->deallocate(link, link->bytes, kMaxAlignment);
+    }
+    for(int i = 0; i < kPoolCount; i++) {
+        freeLists[i] = NULL;
+        chunkBlocks[i] = kFirstChunkBlocks;
+    }
+}
+
+int PoolResource::poolIndex(size_t bytes) {
+    if(bytes > kLargestBlock) return kPoolCount;
+    int index = 0;
+    for(size_t blockBytes = kSmallestBlock; blockBytes < bytes; blockBytes *= 2) {
+        index++;
+    }
+    return index;
+}
+
+void PoolResource::refill(int index) {
+    size_t blockBytes = kSmallestBlock << index;
+    size_t blocks = chunkBlocks[index];
+    Link *chunk = static_cast<Link *>(upstream->allocate(kHeaderBytes + blocks * blockBytes, kMaxAlignment));
+    chunk->bytes = kHeaderBytes + blocks * blockBytes;
+    chunk->next = chunks;
+    chunks = chunk;
+    char *first = reinterpret_cast<char *>(chunk) + kHeaderBytes;
+    for(size_t i = blocks; i > 0; i--) {
+        Link *block = reinterpret_cast<Link *>(first + (i - 1) * blockBytes);
+        block->next = freeLists[index];
+        freeLists[index] = block;
+    }
+    if(blocks < kLastChunkBlocks) chunkBlocks[index] = blocks * 2;
+}
@@ -0,0 +1,334 @@
+/*
+ *  File: MemoryResource.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the memory resources the priority
+ *  queues draw their arrays and nodes from, so a caller
+ *  can give a queue an arena instead of the global heap.
+ */
+
+#ifndef _memoryresource_h
+#define _memoryresource_h
+
+#include <cstddef>
+#include <new>        // for placement new
+#include <type_traits> // for true_type
+#include <utility>    // for forward
+using namespace std;
+
+/*
+ *  Class: MemoryResource
+ *  - - - - - - - - - - - - - - -
+ *  The interface a queue allocates through: a source of
+ *  raw, aligned blocks that are handed back with the same
+ *  size and alignment they were requested with. A
+ *  resource must outlive every queue that uses it.
+ */
+class MemoryResource {
+public:
+    virtual ~MemoryResource() {}
+
+    /*
+     *  Methods: allocate, deallocate
+     *  Parameters: void *block
+     *              size_t bytes
+     *              size_t alignment
+     *  - - - - - - - - - - - - - - - - - -
+     *  Return a block of at least bytes bytes aligned to
+     *  alignment, which must be a power of two no greater
+     *  than kMaxAlignment, or give one back.
+     */
+    virtual void *allocate(size_t bytes, size_t alignment = kMaxAlignment) = 0;
+    virtual void deallocate(void *block, size_t bytes, size_t alignment = kMaxAlignment) = 0;
+
+    /*
+     *  Integer: kMaxAlignment
+     *  - - - - - - - - - - - - - -
+     *  The strictest alignment a resource supports.
+     */
+    static const size_t kMaxAlignment = alignof(max_align_t);
+};
+
+/*
+ *  Function: defaultMemoryResource
+ *  - - - - - - - - - - - - - - - - - -
+ *  Returns the resource that passes every request on
+ *  to operator new and operator delete, which queues use
+ *  unless they are given another.
+ */
+MemoryResource *defaultMemoryResource();
+
+/*
+ *  Class: MonotonicBufferResource
+ *  - - - - - - - - - - - - - - -
+ *  A bump allocator over chunks taken from an upstream
+ *  resource, each twice the size of the last. Deallocate
+ *  does nothing; the memory comes back all at once when
+ *  the resource is released or destroyed. It suits a
+ *  queue that lives for one request: the queue's own
+ *  frees cost nothing and teardown is a single release.
+ */
+class MonotonicBufferResource : public MemoryResource {
+public:
+    /*
+     *  Constructor: MonotonicBufferResource
+     *  Parameters: size_t initialSize
+     *              MemoryResource *upstream
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes a resource that takes nothing from
+     *  upstream until its first allocation.
+     */
+    MonotonicBufferResource(size_t initialSize = kDefaultChunkSize,
+                            MemoryResource *upstream = defaultMemoryResource());
+
+    /*
+     *  Destructor: ~MonotonicBufferResource
+     *  - - - - - - - - - - - - - - - - - -
+     *  Releases every chunk.
+     */
+    ~MonotonicBufferResource();
+
+    void *allocate(size_t bytes, size_t alignment = kMaxAlignment);
+    void deallocate(void *block, size_t bytes, size_t alignment = kMaxAlignment);
+
+    /*
+     *  Method: release
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns every chunk to upstream at once. Nothing
+     *  allocated from this resource may be used after.
+     */
+    void release();
+
+private:
+    MonotonicBufferResource(const MonotonicBufferResource& other);
+    MonotonicBufferResource& operator =(const MonotonicBufferResource& other);
+
+    /*
+     *  Struct: Chunk
+     *  - - - - - - - - - - - - - - - - - -
+     *  The header at the start of each chunk, linking it
+     *  to the chunk taken before it.
+     */
+    struct Chunk {
+        Chunk *next;
+        size_t bytes;
+    };
+
+    static const size_t kDefaultChunkSize = 4096;
+
+    MemoryResource *upstream;
+    Chunk *chunks;
+    char *current;
+    size_t remaining;
+    size_t nextChunkSize;
+};
+
+/*
+ *  Class: PoolResource
+ *  - - - - - - - - - - - - - - -
+ *  A resource that rounds small requests up to a power
+ *  of two from 8 to kLargestBlock bytes and serves each
+ *  size from its own free list, carved out of chunks
+ *  taken from upstream. Freed blocks are reused by the
+ *  next request of their size, so a long-lived queue that
+ *  churns nodes stops reaching upstream once it has grown
+ *  to its working size. Larger requests go to upstream
+ *  directly. Everything is returned when the resource is
+ *  released or destroyed. It is not thread-safe.
+ */
+class PoolResource : public MemoryResource {
+public:
+    /*
+     *  Constructor: PoolResource
+     *  Parameters: MemoryResource *upstream
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes a resource with every free list empty.
+     */
+    PoolResource(MemoryResource *upstream = defaultMemoryResource());
+
+    /*
+     *  Destructor: ~PoolResource
+     *  - - - - - - - - - - - - - - - - - -
+     *  Releases every chunk and large block.
+     */
+    ~PoolResource();
+
+    void *allocate(size_t bytes, size_t alignment = kMaxAlignment);
+    void deallocate(void *block, size_t bytes, size_t alignment = kMaxAlignment);
+
+    /*
+     *  Method: release
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns everything to upstream, whether or not
+     *  it was deallocated.
+     */
+    void release();
+
+private:
+    PoolResource(const PoolResource& other);
+    PoolResource& operator =(const PoolResource& other);
+
+    /*
+     *  Struct: Link
+     *  - - - - - - - - - - - - - - - - - -
+     *  The header of a chunk or large block, linking it
+     *  into its list, with the size taken from upstream.
+     *  A free block holds just the next pointer.
+     */
+    struct Link {
+        Link *next;
+        Link *previous;
+        size_t bytes;
+    };
+
+    /*
+     *  Method: poolIndex
+     *  Parameters: size_t bytes
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the size class for a request, or
+     *  kPoolCount if it is too large to pool.
+     */
+    static int poolIndex(size_t bytes);
+
+    /*
+     *  Method: refill
+     *  Parameters: int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Takes a chunk from upstream and threads its
+     *  blocks onto the free list of a size class.
+     */
+    void refill(int index);
+
+    static const int kPoolCount = 8;
+    static const size_t kSmallestBlock = 8;
+    static const size_t kLargestBlock = kSmallestBlock << (kPoolCount - 1);
+    static const size_t kFirstChunkBlocks = 16;
+    static const size_t kLastChunkBlocks = 1024;
+
+    /*
+     *  Size of a chunk or large block header, rounded up
+     *  so the blocks after it stay fully aligned.
+     */
+    static const size_t kHeaderBytes = (sizeof(Link) + kMaxAlignment - 1) / kMaxAlignment * kMaxAlignment;
+
+    MemoryResource *upstream;
+    Link *freeLists[kPoolCount];
+    size_t chunkBlocks[kPoolCount];
+    Link *chunks;
+    Link *largeBlocks;
+};
+
+/*
+ *  Class: ResourceAllocator
+ *  - - - - - - - - - - - - - - -
+ *  A standard allocator over a MemoryResource, so the
+ *  standard containers inside a queue draw from the same
+ *  resource as its nodes. Moving or swapping a container
+ *  carries its resource along; copying one does not.
+ */
+template <typename T>
+class ResourceAllocator {
+public:
+    typedef T value_type;
+    typedef true_type propagate_on_container_move_assignment;
+    typedef true_type propagate_on_container_swap;
+
+    template <typename U>
+    struct rebind {
+        typedef ResourceAllocator<U> other;
+    };
+
+    ResourceAllocator(MemoryResource *resource = defaultMemoryResource()) : memoryResource(resource) {}
+
+    template <typename U>
+    ResourceAllocator(const ResourceAllocator<U>& other) : memoryResource(other.resource()) {}
+
+    T *allocate(size_t count) {
+        return static_cast<T *>(memoryResource->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *block, size_t count) {
+        memoryResource->deallocate(block, count * sizeof(T), alignof(T));
+    }
+
+    MemoryResource *resource() const {
+        return memoryResource;
+    }
+
+private:
+    MemoryResource *memoryResource;
+};
+
+template <typename T, typename U>
+bool operator ==(const ResourceAllocator<T>& first, const ResourceAllocator<U>& second) {
+    return first.resource() == second.resource();
+}
+
+template <typename T, typename U>
+bool operator !=(const ResourceAllocator<T>& first, const ResourceAllocator<U>& second) {
+    return first.resource() != second.resource();
+}
+
+/*
+ *  Functions: newObject, deleteObject
+ *  Parameters: MemoryResource *resource
+ *              Args&&... args / T *object
+ *  - - - - - - - - - - - - - - - - - -
+ *  Construct an object in memory from the resource, or
+ *  destroy one and give its memory back. Deleting NULL
+ *  does nothing.
+ */
+template <typename T, typename... Args>
+T *newObject(MemoryResource *resource, Args&&... args) {
+    void *block = resource->allocate(sizeof(T), alignof(T));
+    try {
+        return new (block) T(std::forward<Args>(args)...);
+    } catch(...) {
+        resource->deallocate(block, sizeof(T), alignof(T));
+        throw;
+    }
+}
+
+template <typename T>
+void deleteObject(MemoryResource *resource, T *object) {
+    if(object == NULL) return;
+    object->~T();
+    resource->deallocate(object, sizeof(T), alignof(T));
+}
+
+/*
+ *  Functions: newArray, deleteArray
+ *  Parameters: MemoryResource *resource
+ *              size_t count / T *array, size_t count
+ *  - - - - - - - - - - - - - - - - - -
+ *  The array forms, default-constructing count
+ *  elements, or destroying them. The caller passes the
+ *  count back when deleting.
+ */
+template <typename T>
+T *newArray(MemoryResource *resource, size_t count) {
+    T *array = static_cast<T *>(resource->allocate(count * sizeof(T), alignof(T)));
+    size_t constructed = 0;
+    try {
+        for(; constructed < count; constructed++) {
+            new (array + constructed) T();
+        }
+    } catch(...) {
+        while(constructed > 0) {
+            array[--constructed].~T();
+        }
+        resource->deallocate(array, count * sizeof(T), alignof(T));
+        throw;
+    }
+    return array;
+}
+
+template <typename T>
+void deleteArray(MemoryResource *resource, T *array, size_t count) {
+    if(array == NULL) return;
+    for(size_t i = 0; i < count; i++) {
+        array[i].~T();
+    }
+    resource->deallocate(array, count * sizeof(T), alignof(T));
+}
+
+#endif
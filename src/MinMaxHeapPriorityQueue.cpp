@@ -0,0 +1,205 @@
+/*
+ *  File: MinMaxHeapPriorityQueue.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the MinMaxHeapPriorityQueue,
+ *  a double-ended priority queue kept in a min-max heap.
+ */
+
+#include "MinMaxHeapPriorityQueue.h"
+#include <utility>    // for move, swap
+
+MinMaxHeapPriorityQueue::MinMaxHeapPriorityQueue(int capacity, MemoryResource *resource) {
+    this->resource = resource;
+    policy = getTieBreakPolicy();
+    enqueueCount = 0;
+    queueCapacity = capacity + 1;
+    queue = newArray<PQEntry>(resource, queueCapacity);
+    PQ_COUNT(allocations);
+    queueSize = 0;
+}
+
+MinMaxHeapPriorityQueue::MinMaxHeapPriorityQueue(MemoryResource *resource)
+    : MinMaxHeapPriorityQueue(kInitialCapacity, resource) {
+
+}
+
+MinMaxHeapPriorityQueue::~MinMaxHeapPriorityQueue() {
+    deleteArray(resource, queue, queueCapacity);
+}
+
+void MinMaxHeapPriorityQueue::clear() {
+    for(int i = 1; i <= queueSize; i++) {
+        queue[i] = PQEntry();
+    }
+    queueSize = 0;
+}
+
+string MinMaxHeapPriorityQueue::dequeue() {
+    return dequeueMin();
+}
+
+string MinMaxHeapPriorityQueue::dequeueMin() {
+    if(queueSize == 0) error("The queue is empty");
+    return removeAt(1);
+}
+
+string MinMaxHeapPriorityQueue::dequeueMax() {
+    if(queueSize == 0) error("The queue is empty");
+    return removeAt(maxIndex());
+}
+
+void MinMaxHeapPriorityQueue::enqueue(string value, int priority) {
+    if(queueCapacity <= queueSize + 1) expandQueueCapacity();
+    queueSize++;
+    queue[queueSize] = PQEntry(std::move(value), priority, policy, enqueueCount++);
+    bubbleUp(queueSize);
+}
+
+bool MinMaxHeapPriorityQueue::isEmpty() const {
+    return queueSize == 0;
+}
+
+string MinMaxHeapPriorityQueue::peek() const {
+    return peekMin();
+}
+
+string MinMaxHeapPriorityQueue::peekMin() const {
+    if(queueSize == 0) error("The queue is empty");
+    return queue[1].value;
+}
+
+int MinMaxHeapPriorityQueue::peekPriority() const {
+    if(queueSize == 0) error("The queue is empty");
+    return queue[1].priority;
+}
+
+string MinMaxHeapPriorityQueue::peekMax() const {
+    if(queueSize == 0) error("The queue is empty");
+    return queue[maxIndex()].value;
+}
+
+int MinMaxHeapPriorityQueue::peekMaxPriority() const {
+    if(queueSize == 0) error("The queue is empty");
+    return queue[maxIndex()].priority;
+}
+
+string MinMaxHeapPriorityQueue::replaceMax(string value, int priority) {
+    if(queueSize == 0) error("The queue is empty");
+    int index = maxIndex();
+    string oldValue = std::move(queue[index].value);
+    queue[index] = PQEntry(std::move(value), priority, policy, enqueueCount++);
+    if(index != 1) {
+        /*
+         *  The new entry may be more urgent than the root;
+         *  if so the root takes its place on the max level.
+         */
+        if(queue[index] < queue[1]) std::swap(queue[index], queue[1]);
+        trickleDown(index);
+    }
+    return oldValue;
+}
+
+int MinMaxHeapPriorityQueue::size() const {
+    return queueSize;
+}
+
+bool MinMaxHeapPriorityQueue::tryDequeue(string& value) {
+    if(queueSize == 0) return false;
+    value = removeAt(1);
+    return true;
+}
+
+const string* MinMaxHeapPriorityQueue::tryPeek() const {
+    if(queueSize == 0) return NULL;
+    return &queue[1].value;
+}
+
+bool MinMaxHeapPriorityQueue::tryPeekPriority(int& priority) const {
+    if(queueSize == 0) return false;
+    priority = queue[1].priority;
+    return true;
+}
+
+void MinMaxHeapPriorityQueue::expandQueueCapacity() {
+    PQEntry *oldQueue = queue;
+    int oldCapacity = queueCapacity;
+    queueCapacity *= 2;
+    queue = newArray<PQEntry>(resource, queueCapacity);
+    PQ_COUNT(allocations);
+    for(int i = 1; i <= queueSize; i++) {
+        queue[i] = std::move(oldQueue[i]);
+    }
+    deleteArray(resource, oldQueue, oldCapacity);
+}
+
+bool MinMaxHeapPriorityQueue::isMinLevel(int index) const {
+    int level = 0;
+    while(index > 1) {
+        index /= 2;
+        level++;
+    }
+    return level % 2 == 0;
+}
+
+int MinMaxHeapPriorityQueue::maxIndex() const {
+    if(queueSize == 1) return 1;
+    if(queueSize == 2) return 2;
+    return queue[2] < queue[3] ? 3 : 2;
+}
+
+bool MinMaxHeapPriorityQueue::ordered(int first, int second, bool minLevel) const {
+    return minLevel ? queue[first] < queue[second] : queue[second] < queue[first];
+}
+
+string MinMaxHeapPriorityQueue::removeAt(int index) {
+    string value = std::move(queue[index].value);
+    if(index != queueSize) queue[index] = std::move(queue[queueSize]);
+    queue[queueSize] = PQEntry();
+    queueSize--;
+    if(index <= queueSize) trickleDown(index);
+    return value;
+}
+
+void MinMaxHeapPriorityQueue::trickleDown(int index) {
+    bool minLevel = isMinLevel(index);
+    while(2 * index <= queueSize) {
+        PQ_COUNT(levels);
+        /*
+         *  Find the most extreme of the children and grandchildren.
+         */
+        int extreme = 2 * index;
+        bool grandchild = false;
+        if(extreme + 1 <= queueSize && ordered(extreme + 1, extreme, minLevel)) extreme++;
+        for(int i = 4 * index; i < 4 * index + 4 && i <= queueSize; i++) {
+            if(ordered(i, extreme, minLevel)) {
+                extreme = i;
+                grandchild = true;
+            }
+        }
+        if(!ordered(extreme, index, minLevel)) return;
+        std::swap(queue[extreme], queue[index]);
+        if(!grandchild) return;
+        /*
+         *  The entry moved down two levels of its kind; it may now
+         *  belong on the other side of the parent between them.
+         */
+        if(ordered(extreme / 2, extreme, minLevel)) std::swap(queue[extreme], queue[extreme / 2]);
+        index = extreme;
+    }
+}
+
+void MinMaxHeapPriorityQueue::bubbleUp(int index) {
+    if(index == 1) return;
+    bool minLevel = isMinLevel(index);
+    int parent = index / 2;
+    if(ordered(index, parent, !minLevel)) {
+        std::swap(queue[parent], queue[index]);
+        index = parent;
+        minLevel = !minLevel;
+    }
+    while(index >= 4 && ordered(index, index / 4, minLevel)) {
+        PQ_COUNT(levels);
+        std::swap(queue[index], queue[index / 4]);
+        index /= 4;
+    }
+}
@@ -0,0 +1,272 @@
+/*
+ *  File: MinMaxHeapPriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the MinMaxHeapPriorityQueue,
+ *  a double-ended priority queue that can dequeue
+ *  either its most or its least urgent entry in
+ *  logarithmic time.
+ */
+
+#ifndef _minmaxheappriorityqueue_h
+#define _minmaxheappriorityqueue_h
+
+#include <iostream>
+#include <string>
+#include "MemoryResource.h"
+#include "PQEntry.h"
+#include "error.h"
+using namespace std;
+
+/*
+ *  Class: MinMaxHeapPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class keeps its entries in a min-max heap: a
+ *  binary tree in a flat, 1-based array, like the one
+ *  in HeapPriorityQueue, whose even levels are ordered
+ *  as a min-heap and odd levels as a max-heap. Every
+ *  entry on an even level is at most each of its
+ *  descendants and every entry on an odd level at
+ *  least each of them, so the most urgent entry is the
+ *  root and the least urgent is one of its children.
+ *  Entries are compared with the PQEntry operators, so
+ *  ties are broken by value as in the other queues.
+ */
+class MinMaxHeapPriorityQueue {
+public:
+    /*
+     *  Constructor: MinMaxHeapPriorityQueue
+     *  Parameters: int capacity
+     *              MemoryResource *resource
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes a new, empty MinMaxHeapPriorityQueue
+     *  and allocates its array from the resource with
+     *  room for the given number of entries, so a queue
+     *  that never holds more than that never reallocates.
+     */
+    MinMaxHeapPriorityQueue(int capacity = kInitialCapacity,
+                            MemoryResource *resource = defaultMemoryResource());
+    explicit MinMaxHeapPriorityQueue(MemoryResource *resource);
+
+    /*
+     *  Destructor: ~MinMaxHeapPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Frees the array.
+     */
+    ~MinMaxHeapPriorityQueue();
+
+    /*
+     *  Method: clear
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes all items from the PriorityQueue.
+     */
+    void clear();
+
+    /*
+     *  Methods: dequeue, dequeueMin
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value of the highest priority item in the
+     *  PriorityQueue and also removes it from the queue.
+     *  The last entry in the array takes its place at the
+     *  root and is trickled down the min levels.
+     */
+    string dequeue();
+    string dequeueMin();
+
+    /*
+     *  Method: dequeueMax
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value of the lowest priority item in the
+     *  PriorityQueue and also removes it from the queue.
+     *  The last entry in the array takes its place and is
+     *  trickled down the max levels.
+     */
+    string dequeueMax();
+
+    /*
+     *  Method: enqueue
+     *  Parameters: string value
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Adds a user-defined item to the PriorityQueue given
+     *  the item's key and its corresponding priority level.
+     *  The entry is appended to the array and moved up
+     *  either the min or the max levels above it.
+     */
+    void enqueue(string value, int priority);
+
+    /*
+     *  Method: isEmpty
+     *  - - - - - - - - - - - - - - - - - -
+     *  Determines whether the PriorityQueue is empty.
+     */
+    bool isEmpty() const;
+
+    /*
+     *  Methods: peek, peekMin, peekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Return the value or the priority of the highest
+     *  priority item in the PriorityQueue without removing it.
+     */
+    string peek() const;
+    string peekMin() const;
+    int peekPriority() const;
+
+    /*
+     *  Methods: peekMax, peekMaxPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Return the value or the priority of the lowest
+     *  priority item in the PriorityQueue without removing it.
+     */
+    string peekMax() const;
+    int peekMaxPriority() const;
+
+    /*
+     *  Method: replaceMax
+     *  Parameters: string value
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes the lowest priority item and adds the given
+     *  one in its place, returning the removed value. This
+     *  trickles the new entry down once, where dequeueMax
+     *  followed by enqueue would move two entries.
+     */
+    string replaceMax(string value, int priority);
+
+    /*
+     *  Method: size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the size of the PriorityQueue.
+     */
+    int size() const;
+
+    /*
+     *  Methods: tryDequeue, tryPeek, tryPeekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Work as dequeue, peek and peekPriority, but on an empty
+     *  queue return false or NULL instead of throwing. tryPeek
+     *  returns a pointer to the value, good until the queue is
+     *  next changed.
+     */
+    bool tryDequeue(string& value);
+    const string* tryPeek() const;
+    bool tryPeekPriority(int& priority) const;
+
+private:
+    MinMaxHeapPriorityQueue(const MinMaxHeapPriorityQueue& other);
+    MinMaxHeapPriorityQueue& operator =(const MinMaxHeapPriorityQueue& other);
+
+    /*
+     *  Method: expandQueueCapacity
+     *  - - - - - - - - - - - - - - - - - -
+     *  Doubles the capacity of the array.
+     */
+    void expandQueueCapacity();
+
+    /*
+     *  Method: isMinLevel
+     *  Parameters: int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns whether the given index is on an even,
+     *  min-ordered level of the tree.
+     */
+    bool isMinLevel(int index) const;
+
+    /*
+     *  Method: maxIndex
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the index of the lowest priority entry:
+     *  the larger child of the root, or the root itself
+     *  if it has none.
+     */
+    int maxIndex() const;
+
+    /*
+     *  Method: ordered
+     *  Parameters: int first
+     *              int second
+     *              bool minLevel
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns whether the entry at first belongs above
+     *  the one at second: on a min level, whether it is
+     *  smaller, and on a max level, whether it is larger.
+     */
+    bool ordered(int first, int second, bool minLevel) const;
+
+    /*
+     *  Method: removeAt
+     *  Parameters: int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes and returns the value at index, which is
+     *  the root or one of its children, by moving the last
+     *  entry into its place and trickling that down.
+     */
+    string removeAt(int index);
+
+    /*
+     *  Method: trickleDown
+     *  Parameters: int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Moves the entry at index down the levels of its
+     *  own kind, swapping it with its most extreme child
+     *  or grandchild until none belongs above it.
+     */
+    void trickleDown(int index);
+
+    /*
+     *  Method: bubbleUp
+     *  Parameters: int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Moves a newly appended entry up the tree. It first
+     *  swaps with its parent if that is on the other kind
+     *  of level and out of order, then climbs grandparent
+     *  by grandparent along the levels of its kind.
+     */
+    void bubbleUp(int index);
+
+    /*
+     *  Array: queue
+     *  - - - - - - - - - - - - - - - - - -
+     *  C-style array holding the tree from index 1.
+     */
+    PQEntry *queue;
+
+    /*
+     *  Integer: kInitialCapacity
+     *  - - - - - - - - - - - - - -
+     *  Entries the array holds by default.
+     */
+    static const int kInitialCapacity = 10;
+
+    /*
+     *  Integers: queueCapacity, queueSize
+     *  - - - - - - - - - - - - - -
+     *  Size of the array and number of entries in it.
+     */
+    int queueCapacity;
+    int queueSize;
+
+    /*
+     *  MemoryResource Pointer: resource
+     *  - - - - - - - - - - - - - -
+     *  Where the array is allocated.
+     */
+    MemoryResource *resource;
+
+    /*
+     *  TieBreakPolicy: policy
+     *  - - - - - - - - - - - - - -
+     *  The tie-break policy in effect when the queue
+     *  was constructed, stamped on each entry.
+     */
+    TieBreakPolicy policy;
+
+    /*
+     *  Integer: enqueueCount
+     *  - - - - - - - - - - - - - -
+     *  The sequence the queue stamps on the next entry it
+     *  enqueues, so entries are numbered per queue.
+     */
+    unsigned long long enqueueCount;
+};
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ *  File: OperationCounters.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the operation counters.
+ */
+
+#include "OperationCounters.h"
+
+#ifdef PQUEUE_COUNT_OPERATIONS
+
+thread_local OperationCounters operationCounters;
+
+void clearOperationCounters() {
+    operationCounters = OperationCounters();
+}
+
+void printOperationCounters(ostream& out, const OperationCounters& counters) {
+    out << "comparisons: " << counters.comparisons << endl;
+    out << "copies:      " << counters.copies << endl;
+    out << "moves:       " << counters.moves << endl;
+    out << "allocations: " << counters.allocations << endl;
+    out << "levels:      " << counters.levels << endl;
+}
+
+#endif
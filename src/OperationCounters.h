@@ -0,0 +1,72 @@
+/*
+ *  File: OperationCounters.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the operation counters, which
+ *  tally the algorithmic work the priority queues do.
+ *  They are compiled in only when PQUEUE_COUNT_OPERATIONS
+ *  is defined; otherwise the counting macro expands to
+ *  nothing and the queues are unchanged.
+ */
+
+#ifndef _operationcounters_h
+#define _operationcounters_h
+
+#ifdef PQUEUE_COUNT_OPERATIONS
+
+#include <iostream>
+using namespace std;
+
+/*
+ *  Struct: OperationCounters
+ *  - - - - - - - - - - - - - - -
+ *  The work counted since the counters were last cleared:
+ *
+ *  comparisons - entries compared to one another
+ *  copies      - entries copy-constructed or copy-assigned
+ *  moves       - entries move-constructed or move-assigned
+ *  allocations - nodes allocated and arrays grown
+ *  levels      - steps through the structure: heap levels
+ *                sifted, list nodes walked, binomial ranks
+ *                merged
+ */
+struct OperationCounters {
+    unsigned long long comparisons;
+    unsigned long long copies;
+    unsigned long long moves;
+    unsigned long long allocations;
+    unsigned long long levels;
+};
+
+/*
+ *  Variable: operationCounters
+ *  - - - - - - - - - - - - - - -
+ *  The calling thread's counters. Read them before and
+ *  after a call to find what that call cost.
+ */
+extern thread_local OperationCounters operationCounters;
+
+/*
+ *  Function: clearOperationCounters
+ *  - - - - - - - - - - - - - - - - - -
+ *  Resets the calling thread's counters to zero.
+ */
+void clearOperationCounters();
+
+/*
+ *  Function: printOperationCounters
+ *  Parameters: ostream& out
+ *              const OperationCounters& counters
+ *  - - - - - - - - - - - - - - - - - -
+ *  Writes each counter on its own line.
+ */
+void printOperationCounters(ostream& out, const OperationCounters& counters);
+
+#define PQ_COUNT(counter) (operationCounters.counter++)
+
+#else
+
+#define PQ_COUNT(counter) ((void) 0)
+
+#endif
+
+#endif
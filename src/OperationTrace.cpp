@@ -0,0 +1,227 @@
+/*
+ *  File: OperationTrace.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the trace writer and reader.
+ */
+
+#include "OperationTrace.h"
+#include <algorithm>  // for max
+#include <cstring>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ *  Magic bytes identifying a trace file and its format version.
+ */
+static const char kTraceMagic[8] = {'P', 'Q', 'T', 'R', 'A', 'C', 'E', '1'};
+
+/*
+ *  The longest delay a single record can hold.
+ */
+static const uint64_t kMaxDelayNanos = 0xffffffffULL;
+
+OperationTraceWriter::OperationTraceWriter(string path) {
+    this->path = path;
+    records = 0;
+    output.open(path.c_str(), ios::binary | ios::trunc);
+    if(!output) error("OperationTrace: cannot create " + path);
+    TraceHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kTraceMagic, sizeof(header.magic));
+    output.write((const char *) &header, sizeof(header));
+    last = chrono::steady_clock::now();
+}
+
+OperationTraceWriter::~OperationTraceWriter() {
+    if(!output.is_open()) return;
+    try {
+        close();
+    } catch(ErrorException&) {
+        /* A destructor must not throw; the trace is left incomplete. */
+    }
+}
+
+void OperationTraceWriter::append(TraceOp op, const string& value, int priority) {
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    uint64_t delay = chrono::duration_cast<chrono::nanoseconds>(now - last).count();
+    last = now;
+
+    TraceRecord record;
+    memset(&record, 0, sizeof(record));
+    while(delay > kMaxDelayNanos) {
+        record.op = TRACE_PAUSE;
+        record.delayNanos = kMaxDelayNanos;
+        output.write((const char *) &record, sizeof(record));
+        records++;
+        delay -= kMaxDelayNanos;
+    }
+    record.op = op;
+    record.priority = priority;
+    record.delayNanos = delay;
+    if(op == TRACE_ENQUEUE || op == TRACE_DEQUEUE || op == TRACE_PEEK) {
+        record.valueId = valueId(value);
+    }
+    output.write((const char *) &record, sizeof(record));
+    records++;
+}
+
+void OperationTraceWriter::close() {
+    TraceHeader header;
+    memcpy(header.magic, kTraceMagic, sizeof(header.magic));
+    header.recordCount = records;
+    header.valueCount = values.size();
+    header.tableOffset = sizeof(TraceHeader) + records * sizeof(TraceRecord);
+    for(int i = 0; i < values.size(); i++) {
+        uint32_t length = values[i].length();
+        output.write((const char *) &length, sizeof(length));
+        output.write(values[i].data(), length);
+    }
+    output.seekp(0);
+    output.write((const char *) &header, sizeof(header));
+    output.close();
+    if(!output) error("OperationTrace: cannot write " + path);
+}
+
+long long OperationTraceWriter::recordCount() const {
+    return records;
+}
+
+uint32_t OperationTraceWriter::valueId(const string& value) {
+    if(ids.containsKey(value)) return ids.get(value);
+    int id = values.size();
+    ids.put(value, id);
+    values.add(value);
+    return id;
+}
+
+OperationTraceReader::OperationTraceReader(string path) {
+    data = NULL;
+    length = 0;
+    mapped = false;
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) error("OperationTrace: cannot open " + path);
+    struct stat info;
+    if(fstat(fd, &info) != 0) {
+        ::close(fd);
+        error("OperationTrace: cannot stat " + path);
+    }
+    length = info.st_size;
+    if(length > 0) {
+        void *address = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(address == MAP_FAILED) {
+            ::close(fd);
+            error("OperationTrace: cannot map " + path);
+        }
+        data = (const char *) address;
+        mapped = true;
+        /*
+         *  A replay reads the records once, front to back.
+         */
+        madvise(address, length, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+#else
+    ifstream input(path.c_str(), ios::binary | ios::ate);
+    if(!input) error("OperationTrace: cannot open " + path);
+    length = input.tellg();
+    char *buffer = new char[length > 0 ? length : 1];
+    input.seekg(0);
+    input.read(buffer, length);
+    data = buffer;
+    if(!input) {
+        delete[] buffer;
+        error("OperationTrace: cannot read " + path);
+    }
+#endif
+    const TraceHeader *header = (const TraceHeader *) data;
+    bool valid = length >= sizeof(TraceHeader) &&
+            memcmp(header->magic, kTraceMagic, sizeof(header->magic)) == 0 &&
+            header->tableOffset != 0 &&
+            (length - sizeof(TraceHeader)) / sizeof(TraceRecord) >= header->recordCount &&
+            header->tableOffset == sizeof(TraceHeader) + header->recordCount * sizeof(TraceRecord);
+    if(!valid) {
+        release();
+        error("OperationTrace: " + path + " is not a complete trace");
+    }
+    count = header->recordCount;
+    records = (const TraceRecord *) (data + sizeof(TraceHeader));
+
+    const char *table = data + header->tableOffset;
+    const char *end = data + length;
+    for(uint64_t i = 0; i < header->valueCount; i++) {
+        uint32_t valueLength;
+        if(end - table < (ptrdiff_t) sizeof(valueLength)) break;
+        memcpy(&valueLength, table, sizeof(valueLength));
+        table += sizeof(valueLength);
+        if((uint64_t) (end - table) < valueLength) break;
+        values.add(string(table, valueLength));
+        table += valueLength;
+    }
+    if((uint64_t) values.size() != header->valueCount) {
+        release();
+        error("OperationTrace: " + path + " has a truncated value table");
+    }
+
+    operations = 0;
+    peak = 0;
+    int queued = 0;
+    for(long long i = 0; i < count; i++) {
+        const TraceRecord& record = records[i];
+        bool named = record.op == TRACE_ENQUEUE || record.op == TRACE_DEQUEUE || record.op == TRACE_PEEK;
+        bool known = record.op >= TRACE_CLEAR && record.op <= TRACE_PAUSE;
+        bool readsFront = record.op == TRACE_DEQUEUE || record.op == TRACE_PEEK ||
+                record.op == TRACE_PEEK_PRIORITY;
+        if(!known || (named && record.valueId >= (uint32_t) values.size()) || (readsFront && queued == 0)) {
+            release();
+            error("OperationTrace: " + path + " has an invalid record");
+        }
+        if(record.op != TRACE_PAUSE) operations++;
+        if(record.op == TRACE_ENQUEUE) {
+            queued++;
+        } else if(record.op == TRACE_DEQUEUE) {
+            queued--;
+        } else if(record.op == TRACE_CLEAR) {
+            queued = 0;
+        }
+        peak = max(peak, queued);
+    }
+}
+
+OperationTraceReader::~OperationTraceReader() {
+    release();
+}
+
+void OperationTraceReader::release() {
+    if(data == NULL) return;
+#ifndef _WIN32
+    if(mapped) munmap((void *) data, length);
+#else
+    delete[] data;
+#endif
+    data = NULL;
+}
+
+long long OperationTraceReader::operationCount() const {
+    return operations;
+}
+
+int OperationTraceReader::peakSize() const {
+    return peak;
+}
+
+const TraceRecord& OperationTraceReader::record(long long index) const {
+    return records[index];
+}
+
+long long OperationTraceReader::size() const {
+    return count;
+}
+
+const string& OperationTraceReader::value(uint32_t valueId) const {
+    return values[valueId];
+}
@@ -0,0 +1,239 @@
+/*
+ *  File: OperationTrace.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the binary trace format written by
+ *  the TracingPriorityQueue, along with a writer that
+ *  streams a trace to disk and a reader that maps one
+ *  back into memory for replay.
+ */
+
+#ifndef _operationtrace_h
+#define _operationtrace_h
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <stdint.h>
+#include "hashmap.h"
+#include "vector.h"
+#include "error.h"
+using namespace std;
+
+/*
+ *  Enum: TraceOp
+ *  - - - - - - - - - - - - - - -
+ *  The kinds of operation a trace record describes. Every
+ *  public method of a queue has its own op, so a replay
+ *  makes the same calls the traced program made. A
+ *  TRACE_PAUSE record stands for idle time too long to
+ *  fit in the delay of the record that follows it.
+ */
+enum TraceOp {
+    TRACE_CLEAR = 1,
+    TRACE_DEQUEUE,
+    TRACE_ENQUEUE,
+    TRACE_IS_EMPTY,
+    TRACE_PEEK,
+    TRACE_PEEK_PRIORITY,
+    TRACE_SIZE,
+    TRACE_PAUSE
+};
+
+/*
+ *  Struct: TraceRecord
+ *  - - - - - - - - - - - - - - -
+ *  One operation of a trace, 16 bytes long. Values are
+ *  stored once each in the value table at the end of the
+ *  file and named here by their index in it. An enqueue
+ *  holds the value and priority it was given, and a
+ *  dequeue, peek or peekPriority what it returned, so a
+ *  replay can tell when an engine answers differently.
+ *  delayNanos is the time since the previous record.
+ */
+struct TraceRecord {
+    uint8_t op;
+    uint8_t reserved[3];
+    int32_t priority;
+    uint32_t valueId;
+    uint32_t delayNanos;
+};
+
+/*
+ *  Struct: TraceHeader
+ *  - - - - - - - - - - - - - - -
+ *  Fixed header at the start of every trace, followed by
+ *  recordCount records and then the value table, which
+ *  holds valueCount values, each a 32-bit length followed
+ *  by its bytes. A trace that was never closed still has
+ *  a tableOffset of 0. All fields are in the host's byte
+ *  order.
+ */
+struct TraceHeader {
+    char magic[8];
+    uint64_t recordCount;
+    uint64_t valueCount;
+    uint64_t tableOffset;
+};
+
+/*
+ *  Class: OperationTraceWriter
+ *  - - - - - - - - - - - - - - -
+ *  Streams records to a trace file as operations happen,
+ *  giving each distinct value an id the first time it is
+ *  seen, and writes the value table when it is closed.
+ */
+class OperationTraceWriter {
+public:
+    /*
+     *  Constructor: OperationTraceWriter
+     *  Parameters: string path
+     *  - - - - - - - - - - - - - - - - - -
+     *  Creates or truncates the trace file at the given path.
+     *  Delays are measured from this moment.
+     */
+    OperationTraceWriter(string path);
+
+    /*
+     *  Destructor: ~OperationTraceWriter
+     *  - - - - - - - - - - - - - - - - - -
+     *  Closes the trace if close has not been called.
+     */
+    ~OperationTraceWriter();
+
+    /*
+     *  Method: append
+     *  Parameters: TraceOp op
+     *              const string& value
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Records an operation taking place now. The value is
+     *  only looked up for enqueues, dequeues and peeks.
+     */
+    void append(TraceOp op, const string& value = "", int priority = 0);
+
+    /*
+     *  Method: close
+     *  - - - - - - - - - - - - - - - - - -
+     *  Writes the value table and the final header, after
+     *  which the trace can be replayed.
+     */
+    void close();
+
+    /*
+     *  Method: recordCount
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the number of records written so far.
+     */
+    long long recordCount() const;
+
+private:
+    OperationTraceWriter(const OperationTraceWriter& other);
+    OperationTraceWriter& operator =(const OperationTraceWriter& other);
+
+    /*
+     *  Method: valueId
+     *  Parameters: const string& value
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the id of a value, assigning the next one
+     *  if the value has not been seen before.
+     */
+    uint32_t valueId(const string& value);
+
+    string path;
+    ofstream output;
+    HashMap<string, int> ids;
+    Vector<string> values;
+    long long records;
+    chrono::steady_clock::time_point last;
+};
+
+/*
+ *  Class: OperationTraceReader
+ *  - - - - - - - - - - - - - - -
+ *  Maps a trace file into memory and gives access to its
+ *  records in place, so that a replay reads them straight
+ *  from the page cache. The file stays mapped until the
+ *  reader is destroyed.
+ */
+class OperationTraceReader {
+public:
+    /*
+     *  Constructor: OperationTraceReader
+     *  Parameters: string path
+     *  - - - - - - - - - - - - - - - - - -
+     *  Maps the given file with mmap, or reads it into memory
+     *  where mmap is not available, loads its value table and
+     *  checks that every record can be replayed: its op is
+     *  known, its value id is in the table, and it never
+     *  peeks at or dequeues from an empty queue.
+     */
+    OperationTraceReader(string path);
+
+    /*
+     *  Destructor: ~OperationTraceReader
+     *  - - - - - - - - - - - - - - - - - -
+     *  Unmaps the trace file.
+     */
+    ~OperationTraceReader();
+
+    /*
+     *  Method: operationCount
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the number of records other than pauses.
+     */
+    long long operationCount() const;
+
+    /*
+     *  Method: peakSize
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the largest number of entries the traced
+     *  queue held at once.
+     */
+    int peakSize() const;
+
+    /*
+     *  Method: record
+     *  Parameters: long long index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the record at the given index.
+     */
+    const TraceRecord& record(long long index) const;
+
+    /*
+     *  Method: size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the number of records in the trace.
+     */
+    long long size() const;
+
+    /*
+     *  Method: value
+     *  Parameters: uint32_t valueId
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value with the given id.
+     */
+    const string& value(uint32_t valueId) const;
+
+private:
+    OperationTraceReader(const OperationTraceReader& other);
+    OperationTraceReader& operator =(const OperationTraceReader& other);
+
+    /*
+     *  Method: release
+     *  - - - - - - - - - - - - - - - - - -
+     *  Unmaps or frees the trace's bytes.
+     */
+    void release();
+
+    const char *data;
+    size_t length;
+    bool mapped;
+    const TraceRecord *records;
+    long long count;
+    long long operations;
+    int peak;
+    Vector<string> values;
+};
+
+#endif
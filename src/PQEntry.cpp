@@ -3,26 +3,97 @@
  * This file contains the implementation of the PQEntry structure.
  * See PQEntry.h for documentation of each member.
  *
- * Please do not modify this provided file. Your turned-in files should work
- * with an unmodified version of all provided code files.
+ * This file began as provided course code; see PQEntry.h for what has been
+ * added since.
  *
  * Version: Sat 2014/02/14
  * Author : Marty Stepp
  */
 
 #include "PQEntry.h"
+#include <atomic>
+#include <utility>    // for move
 
-PQEntry::PQEntry(string value, int priority) {
-    this->value = value;
-    this->priority = priority;
+/*
+ * The policy new queues take, and the policy of the innermost TieBreakScope
+ * on each thread (-1 outside any scope).
+ */
+static atomic<int> tieBreakPolicy(TIE_BREAK_LEXICOGRAPHIC);
+static thread_local int scopedPolicy = -1;
+
+void setTieBreakPolicy(TieBreakPolicy policy) {
+    tieBreakPolicy.store(policy);
+}
+
+TieBreakPolicy getTieBreakPolicy() {
+    if (scopedPolicy >= 0) return (TieBreakPolicy) scopedPolicy;
+    return (TieBreakPolicy) tieBreakPolicy.load();
+}
+
+TieBreakScope::TieBreakScope(TieBreakPolicy policy) {
+    savedPolicy = scopedPolicy;
+    scopedPolicy = policy;
+}
+
+TieBreakScope::~TieBreakScope() {
+    scopedPolicy = savedPolicy;
 }
 
+bool breaksTieBefore(const string& value1, unsigned long long sequence1,
+                     const string& value2, unsigned long long sequence2,
+                     TieBreakPolicy policy) {
+    switch (policy) {
+    case TIE_BREAK_FIFO:
+        return sequence1 < sequence2;
+    case TIE_BREAK_NONE:
+        return false;
+    default:
+        return value1 < value2;
+    }
+}
+
+PQEntry::PQEntry(string value, int priority, TieBreakPolicy policy, unsigned long long sequence)
+    : value(std::move(value)), priority(priority), policy(policy), sequence(sequence) {
+}
+
+#ifdef PQUEUE_COUNT_OPERATIONS
+PQEntry::PQEntry(const PQEntry& other)
+    : value(other.value), priority(other.priority), policy(other.policy), sequence(other.sequence) {
+    PQ_COUNT(copies);
+}
+
+PQEntry::PQEntry(PQEntry&& other) noexcept
+    : value(std::move(other.value)), priority(other.priority), policy(other.policy), sequence(other.sequence) {
+    PQ_COUNT(moves);
+}
+
+PQEntry& PQEntry::operator =(const PQEntry& other) {
+    value = other.value;
+    priority = other.priority;
+    policy = other.policy;
+    sequence = other.sequence;
+    PQ_COUNT(copies);
+    return *this;
+}
+
+PQEntry& PQEntry::operator =(PQEntry&& other) noexcept {
+    value = std::move(other.value);
+    priority = other.priority;
+    policy = other.policy;
+    sequence = other.sequence;
+    PQ_COUNT(moves);
+    return *this;
+}
+#endif
+
 bool operator <(const PQEntry& pqe1, const PQEntry& pqe2) {
-    return pqe1.priority < pqe2.priority ||
-            (pqe1.priority == pqe2.priority && pqe1.value < pqe2.value);
+    PQ_COUNT(comparisons);
+    if (pqe1.priority != pqe2.priority) return pqe1.priority < pqe2.priority;
+    return breaksTieBefore(pqe1.value, pqe1.sequence, pqe2.value, pqe2.sequence, pqe1.policy);
 }
 
 bool operator ==(const PQEntry& pqe1, const PQEntry& pqe2) {
+    PQ_COUNT(comparisons);
     return pqe1.priority == pqe2.priority && pqe1.value == pqe2.value;
 }
 
@@ -30,12 +101,16 @@ bool operator !=(const PQEntry& pqe1, const PQEntry& pqe2) {
     return !(pqe1 == pqe2);
 }
 
+/*
+ * The orderings are all defined by < so that they agree with it under every
+ * tie-break policy; == compares the contents and ignores the sequence.
+ */
 bool operator <=(const PQEntry& pqe1, const PQEntry& pqe2) {
-    return pqe1 < pqe2 || pqe1 == pqe2;
+    return !(pqe2 < pqe1);
 }
 
 bool operator >(const PQEntry& pqe1, const PQEntry& pqe2) {
-    return !(pqe1 <= pqe2);
+    return pqe2 < pqe1;
 }
 
 bool operator >=(const PQEntry& pqe1, const PQEntry& pqe2) {
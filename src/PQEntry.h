@@ -8,8 +8,10 @@
  * relational operators like <, >=, ==, !=.  They can also be printed to the
  * console using the << operator.
  *
- * Please do not modify this provided file. Your turned-in files should work
- * with an unmodified version of all provided code files.
+ * This file began as provided course code and has since been extended for
+ * the queues in this project: entries carry an insertion sequence that a
+ * tie-break policy can order equal priorities by, and their comparisons,
+ * copies and moves can be counted.
  *
  * Version: Sat 2014/02/14
  * Author : Marty Stepp
@@ -20,14 +22,89 @@
 
 #include <string>
 #include <iostream>
+#include "OperationCounters.h"
 using namespace std;
 
+/*
+ * How entries of equal priority are ordered, by every queue that compares
+ * PQEntry or ListNode objects:
+ *
+ * TIE_BREAK_LEXICOGRAPHIC - by value, the original behavior
+ * TIE_BREAK_FIFO          - by sequence, so equal priorities dequeue in the
+ *                           order they were enqueued, without comparing any
+ *                           strings
+ * TIE_BREAK_NONE          - not at all; equal priorities dequeue in whatever
+ *                           order the queue finds cheapest
+ */
+enum TieBreakPolicy {
+    TIE_BREAK_LEXICOGRAPHIC,
+    TIE_BREAK_FIFO,
+    TIE_BREAK_NONE
+};
+
+/*
+ * Sets and returns the tie-break policy that queues take when they are
+ * constructed. Each queue keeps the policy it was constructed with and
+ * stamps it on every entry it makes, so changing the policy never reorders
+ * a queue that already exists. Inside a TieBreakScope, getTieBreakPolicy
+ * returns the scope's policy on that thread instead.
+ */
+void setTieBreakPolicy(TieBreakPolicy policy);
+TieBreakPolicy getTieBreakPolicy();
+
+/*
+ * While a TieBreakScope is alive, queues constructed on its thread take its
+ * policy. A wrapper that builds its engine after its own construction opens
+ * one so the engine breaks ties the way the wrapper does.
+ */
+class TieBreakScope {
+public:
+    TieBreakScope(TieBreakPolicy policy);
+    ~TieBreakScope();
+
+private:
+    TieBreakScope(const TieBreakScope& other);
+    TieBreakScope& operator =(const TieBreakScope& other);
+
+    int savedPolicy;
+};
+
+/*
+ * Returns whether, under the given policy, an entry with value1 and
+ * sequence1 goes before one of equal priority with value2 and sequence2.
+ */
+bool breaksTieBefore(const string& value1, unsigned long long sequence1,
+                     const string& value2, unsigned long long sequence2,
+                     TieBreakPolicy policy);
+
 struct PQEntry {
 public:
     string value;
     int priority;
+    TieBreakPolicy policy;
+    unsigned long long sequence;
 
-    PQEntry(string value = "", int priority = 0);
+    /*
+     * Entries compared with each other should share a policy; the first
+     * entry's decides. The sequence is the insertion order within the
+     * entry's queue: each queue numbers the entries it enqueues from its
+     * own counter, so placeholders and copies never take a number.
+     */
+    PQEntry(string value = "", int priority = 0, TieBreakPolicy policy = getTieBreakPolicy(),
+            unsigned long long sequence = 0);
+
+#ifdef PQUEUE_COUNT_OPERATIONS
+    /*
+     * With operation counting on, copies and moves of an entry are
+     * counted; otherwise the compiler-generated versions are used.
+     * Moves are noexcept either way, so std::vector moves entries
+     * rather than copying them when it grows.
+     */
+    PQEntry(const PQEntry& other);
+    PQEntry(PQEntry&& other) noexcept;
+    PQEntry& operator =(const PQEntry& other);
+    PQEntry& operator =(PQEntry&& other) noexcept;
+#endif
 };
 
 bool operator <(const PQEntry& pqe1, const PQEntry& pqe2);
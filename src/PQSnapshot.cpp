@@ -0,0 +1,160 @@
+/*
+ *  File: PQSnapshot.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the snapshot writer and
+ *  reader shared by the priority queues.
+ */
+
+#include "PQSnapshot.h"
+#include "FileSync.h"
+#include <cstdio>     // for rename, remove
+#include <cstring>
+#include <fstream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ *  Magic bytes identifying a snapshot file and its format version.
+ */
+static const char kSnapshotMagic[8] = {'P', 'Q', 'S', 'N', 'A', 'P', '0', '3'};
+
+PQSnapshotWriter::PQSnapshotWriter(PQSnapshotLayout layout) {
+    this->layout = layout;
+}
+
+void PQSnapshotWriter::add(const string& value, int priority, unsigned long long sequence, int aux) {
+    PQSnapshotRecord record;
+    record.priority = priority;
+    record.aux = aux;
+    record.offset = blob.length();
+    record.length = value.length();
+    record.sequence = sequence;
+    records.add(record);
+    blob += value;
+}
+
+void PQSnapshotWriter::save(string path) const {
+    PQSnapshotHeader header;
+    memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.layout = layout;
+    header.count = records.size();
+    header.blobSize = blob.length();
+
+    string tempPath = path + ".tmp";
+    ofstream output(tempPath.c_str(), ios::binary | ios::trunc);
+    if(!output) error("PQSnapshot: cannot create " + tempPath);
+    output.write((const char *) &header, sizeof(header));
+    for(int i = 0; i < records.size(); i++) {
+        output.write((const char *) &records[i], sizeof(PQSnapshotRecord));
+    }
+    output.write(blob.data(), blob.length());
+    output.close();
+    if(!output) error("PQSnapshot: cannot write " + tempPath);
+    syncFile(tempPath);
+#ifdef _WIN32
+    remove(path.c_str());
+#endif
+    if(rename(tempPath.c_str(), path.c_str()) != 0) error("PQSnapshot: cannot replace " + path);
+    syncDirectory(path);
+}
+
+PQSnapshotReader::PQSnapshotReader(string path, PQSnapshotLayout layout) {
+    data = NULL;
+    length = 0;
+    mapped = false;
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) error("PQSnapshot: cannot open " + path);
+    struct stat info;
+    if(fstat(fd, &info) != 0) {
+        close(fd);
+        error("PQSnapshot: cannot stat " + path);
+    }
+    length = info.st_size;
+    if(length > 0) {
+        void *address = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(address == MAP_FAILED) {
+            close(fd);
+            error("PQSnapshot: cannot map " + path);
+        }
+        data = (const char *) address;
+        mapped = true;
+    }
+    close(fd);
+#else
+    ifstream input(path.c_str(), ios::binary | ios::ate);
+    if(!input) error("PQSnapshot: cannot open " + path);
+    length = input.tellg();
+    char *buffer = new char[length > 0 ? length : 1];
+    input.seekg(0);
+    input.read(buffer, length);
+    data = buffer;
+    if(!input) {
+        delete[] buffer;
+        error("PQSnapshot: cannot read " + path);
+    }
+#endif
+    const PQSnapshotHeader *header = (const PQSnapshotHeader *) data;
+    bool valid = length >= sizeof(PQSnapshotHeader) &&
+            memcmp(header->magic, kSnapshotMagic, sizeof(header->magic)) == 0 &&
+            (length - sizeof(PQSnapshotHeader)) / sizeof(PQSnapshotRecord) >= header->count &&
+            length - sizeof(PQSnapshotHeader) - header->count * sizeof(PQSnapshotRecord) >= header->blobSize;
+    if(!valid || header->layout != (uint32_t) layout) {
+        release();
+        error("PQSnapshot: " + path + " is not a snapshot of this kind of queue");
+    }
+    count = header->count;
+    records = (const PQSnapshotRecord *) (data + sizeof(PQSnapshotHeader));
+    blob = (const char *) (records + count);
+    blobSize = header->blobSize;
+}
+
+PQSnapshotReader::~PQSnapshotReader() {
+    release();
+}
+
+void PQSnapshotReader::release() {
+    if(data == NULL) return;
+#ifndef _WIN32
+    if(mapped) munmap((void *) data, length);
+#else
+    delete[] data;
+#endif
+    data = NULL;
+}
+
+int PQSnapshotReader::aux(int index) const {
+    return records[index].aux;
+}
+
+int PQSnapshotReader::priority(int index) const {
+    return records[index].priority;
+}
+
+unsigned long long PQSnapshotReader::sequence(int index) const {
+    return records[index].sequence;
+}
+
+string PQSnapshotReader::value(int index) const {
+    const PQSnapshotRecord& record = records[index];
+    if(record.offset > blobSize || record.length > blobSize - record.offset) {
+        error("PQSnapshot: value out of bounds");
+    }
+    return string(blob + record.offset, record.length);
+}
+
+int PQSnapshotReader::size() const {
+    return count;
+}
+
+unsigned long long PQSnapshotReader::nextSequence() const {
+    unsigned long long next = 0;
+    for(int i = 0; i < count; i++) {
+        if(records[i].sequence >= next) next = records[i].sequence + 1;
+    }
+    return next;
+}
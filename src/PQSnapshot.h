@@ -0,0 +1,193 @@
+/*
+ *  File: PQSnapshot.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the binary snapshot format
+ *  shared by the priority queues' saveSnapshot and
+ *  loadSnapshot methods, along with a writer that
+ *  builds a snapshot and a reader that maps one
+ *  back into memory.
+ */
+
+#ifndef _pqsnapshot_h
+#define _pqsnapshot_h
+
+#include <cstddef>
+#include <string>
+#include <stdint.h>
+#include "vector.h"
+#include "error.h"
+using namespace std;
+
+/*
+ *  Enum: PQSnapshotLayout
+ *  - - - - - - - - - - - - - - -
+ *  Identifies which queue's in-memory layout the
+ *  records of a snapshot mirror, so one queue
+ *  never restores another's snapshot:
+ *
+ *  SNAPSHOT_HEAP_ARRAY       - heap array in index order
+ *  SNAPSHOT_BINOMIAL_TREES   - root slots, each followed by
+ *                              its tree in preorder
+ *  SNAPSHOT_SORTED_LIST      - linked list in list order
+ *  SNAPSHOT_UNSORTED_VECTOR  - vector in index order
+ */
+enum PQSnapshotLayout {
+    SNAPSHOT_HEAP_ARRAY = 1,
+    SNAPSHOT_BINOMIAL_TREES,
+    SNAPSHOT_SORTED_LIST,
+    SNAPSHOT_UNSORTED_VECTOR
+};
+
+/*
+ *  Struct: PQSnapshotRecord
+ *  - - - - - - - - - - - - - - -
+ *  One entry of a snapshot. The value lives in the
+ *  string blob at the end of the file, at the given
+ *  offset and length, which are 64-bit so a blob past
+ *  4 GiB is read back correctly. The sequence is the
+ *  entry's insertion sequence, so FIFO ties survive a
+ *  restore.
+ *  The meaning of aux depends on the layout; the
+ *  binomial layout uses it for the number of children
+ *  of a node, or -1 for an empty root slot.
+ */
+struct PQSnapshotRecord {
+    int32_t priority;
+    int32_t aux;
+    uint64_t offset;
+    uint64_t length;
+    uint64_t sequence;
+};
+
+/*
+ *  Struct: PQSnapshotHeader
+ *  - - - - - - - - - - - - - - -
+ *  Fixed header at the start of every snapshot, followed
+ *  by count records and then blobSize bytes of strings.
+ *  All fields are in the host's byte order.
+ */
+struct PQSnapshotHeader {
+    char magic[8];
+    uint32_t layout;
+    uint32_t count;
+    uint64_t blobSize;
+};
+
+/*
+ *  Class: PQSnapshotWriter
+ *  - - - - - - - - - - - - - - -
+ *  Collects records and their values, then writes
+ *  them out as a snapshot file.
+ */
+class PQSnapshotWriter {
+public:
+    /*
+     *  Constructor: PQSnapshotWriter
+     *  Parameters: PQSnapshotLayout layout
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes an empty snapshot of the given layout.
+     */
+    PQSnapshotWriter(PQSnapshotLayout layout);
+
+    /*
+     *  Method: add
+     *  Parameters: const string& value
+     *              int priority
+     *              unsigned long long sequence
+     *              int aux
+     *  - - - - - - - - - - - - - - - - - -
+     *  Appends a record, copying its value into the blob.
+     */
+    void add(const string& value, int priority, unsigned long long sequence, int aux = 0);
+
+    /*
+     *  Method: save
+     *  Parameters: string path
+     *  - - - - - - - - - - - - - - - - - -
+     *  Writes the snapshot to a temporary file beside the
+     *  given path and renames it into place, so a crash
+     *  part way through never leaves a torn snapshot.
+     */
+    void save(string path) const;
+
+private:
+    PQSnapshotLayout layout;
+    Vector<PQSnapshotRecord> records;
+    string blob;
+};
+
+/*
+ *  Class: PQSnapshotReader
+ *  - - - - - - - - - - - - - - -
+ *  Maps a snapshot file into memory and gives access
+ *  to its records in place. The file stays mapped
+ *  until the reader is destroyed.
+ */
+class PQSnapshotReader {
+public:
+    /*
+     *  Constructor: PQSnapshotReader
+     *  Parameters: string path
+     *              PQSnapshotLayout layout
+     *  - - - - - - - - - - - - - - - - - -
+     *  Maps the given file with mmap, or reads it into
+     *  memory where mmap is not available, and checks
+     *  its header against the expected layout.
+     */
+    PQSnapshotReader(string path, PQSnapshotLayout layout);
+
+    /*
+     *  Destructor: ~PQSnapshotReader
+     *  - - - - - - - - - - - - - - - - - -
+     *  Unmaps the snapshot file.
+     */
+    ~PQSnapshotReader();
+
+    /*
+     *  Methods: aux, priority, sequence, value
+     *  Parameters: int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Return the fields of the record at the given index.
+     */
+    int aux(int index) const;
+    int priority(int index) const;
+    unsigned long long sequence(int index) const;
+    string value(int index) const;
+
+    /*
+     *  Method: size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the number of records in the snapshot.
+     */
+    int size() const;
+
+    /*
+     *  Method: nextSequence
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns one past the largest sequence in the snapshot,
+     *  where the restoring queue resumes its own counter so
+     *  entries enqueued after the restore follow the restored ones.
+     */
+    unsigned long long nextSequence() const;
+
+private:
+    PQSnapshotReader(const PQSnapshotReader& other);
+    PQSnapshotReader& operator =(const PQSnapshotReader& other);
+
+    /*
+     *  Method: release
+     *  - - - - - - - - - - - - - - - - - -
+     *  Unmaps or frees the snapshot's bytes.
+     */
+    void release();
+
+    const char *data;
+    size_t length;
+    bool mapped;
+    const PQSnapshotRecord *records;
+    const char *blob;
+    uint64_t blobSize;
+    int count;
+};
+
+#endif
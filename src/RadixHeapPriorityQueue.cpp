@@ -0,0 +1,129 @@
+/*
+ *  File: RadixHeapPriorityQueue.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the RadixHeapPriorityQueue,
+ *  a bucket queue for monotone workloads.
+ */
+
+#include "RadixHeapPriorityQueue.h"
+#include <algorithm>  // for push_heap, pop_heap, make_heap
+#include <functional> // for greater
+#include <utility>    // for move
+
+RadixHeapPriorityQueue::RadixHeapPriorityQueue() {
+    frontKey = 0;
+    queueSize = 0;
+    policy = getTieBreakPolicy();
+    enqueueCount = 0;
+}
+
+RadixHeapPriorityQueue::~RadixHeapPriorityQueue() {
+
+}
+
+bool RadixHeapPriorityQueue::accepts(int priority) const {
+    return queueSize == 0 || toKey(priority) >= frontKey;
+}
+
+void RadixHeapPriorityQueue::clear() {
+    for(int i = 0; i < kBucketCount; i++) {
+        buckets[i].clear();
+    }
+    queueSize = 0;
+}
+
+string RadixHeapPriorityQueue::dequeue() {
+    string value;
+    if(!tryDequeue(value)) error("The queue is empty");
+    return value;
+}
+
+void RadixHeapPriorityQueue::enqueue(string value, int priority) {
+    uint32_t key = toKey(priority);
+    if(queueSize == 0) {
+        frontKey = 0;
+    } else if(key < frontKey) {
+        error("RadixHeapPriorityQueue: priority is below one already dequeued");
+    }
+    int bucket = bucketFor(key);
+    buckets[bucket].push_back(PQEntry(std::move(value), priority, policy, enqueueCount++));
+    if(bucket == 0) push_heap(buckets[0].begin(), buckets[0].end(), greater<PQEntry>());
+    queueSize++;
+}
+
+bool RadixHeapPriorityQueue::isEmpty() const {
+    return queueSize == 0;
+}
+
+string RadixHeapPriorityQueue::peek() const {
+    const string *value = tryPeek();
+    if(value == NULL) error("The queue is empty");
+    return *value;
+}
+
+int RadixHeapPriorityQueue::peekPriority() const {
+    int priority = 0;
+    if(!tryPeekPriority(priority)) error("The queue is empty");
+    return priority;
+}
+
+int RadixHeapPriorityQueue::size() const {
+    return queueSize;
+}
+
+bool RadixHeapPriorityQueue::tryDequeue(string& value) {
+    if(queueSize == 0) return false;
+    if(buckets[0].empty()) refill();
+    vector<PQEntry>& front = buckets[0];
+    pop_heap(front.begin(), front.end(), greater<PQEntry>());
+    value = std::move(front.back().value);
+    front.pop_back();
+    queueSize--;
+    return true;
+}
+
+const string* RadixHeapPriorityQueue::tryPeek() const {
+    if(queueSize == 0) return NULL;
+    if(buckets[0].empty()) refill();
+    return &buckets[0].front().value;
+}
+
+bool RadixHeapPriorityQueue::tryPeekPriority(int& priority) const {
+    if(queueSize == 0) return false;
+    if(buckets[0].empty()) refill();
+    priority = buckets[0].front().priority;
+    return true;
+}
+
+int RadixHeapPriorityQueue::bucketFor(uint32_t key) const {
+    if(key == frontKey) return 0;
+    return 32 - __builtin_clz(key ^ frontKey);
+}
+
+void RadixHeapPriorityQueue::refill() const {
+    int source = 1;
+    while(buckets[source].empty()) {
+        source++;
+    }
+    vector<PQEntry> entries;
+    entries.swap(buckets[source]);
+    frontKey = toKey(entries[0].priority);
+    for(size_t i = 1; i < entries.size(); i++) {
+        PQ_COUNT(comparisons);
+        frontKey = min(frontKey, toKey(entries[i].priority));
+    }
+    /*
+     *  Every entry of the source bucket shares the bits above
+     *  its index with the new front key, so each one lands
+     *  in a lower bucket.
+     */
+    for(size_t i = 0; i < entries.size(); i++) {
+        PQ_COUNT(levels);
+        buckets[bucketFor(toKey(entries[i].priority))].push_back(entries[i]);
+    }
+    make_heap(buckets[0].begin(), buckets[0].end(), greater<PQEntry>());
+}
+
+uint32_t RadixHeapPriorityQueue::toKey(int priority) {
+    return (uint32_t) priority ^ 0x80000000u;
+}
@@ -0,0 +1,207 @@
+/*
+ *  File: RadixHeapPriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the RadixHeapPriorityQueue, a
+ *  bucket queue for monotone workloads such as timers
+ *  and event simulations, where nothing is enqueued
+ *  ahead of the entry most recently dequeued.
+ */
+
+#ifndef _radixheappriorityqueue_h
+#define _radixheappriorityqueue_h
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "PQEntry.h"
+#include "error.h"
+using namespace std;
+
+/*
+ *  Class: RadixHeapPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class files each entry into one of 33 buckets by
+ *  the highest bit in which its priority differs from the
+ *  priority last dequeued, so enqueueing is a constant-time
+ *  append. When the front bucket runs out, the next
+ *  non-empty bucket is redistributed into the buckets
+ *  below it, the first time the front is needed; each entry moves down at most 32
+ *  times in its life, so dequeueing costs amortized
+ *  O(log C) for a priority range of C with no comparisons
+ *  between most entries at all. Entries with the front
+ *  priority are kept in a small heap ordered by value,
+ *  so ties break the same way as in the other queues.
+ *
+ *  The price is that the priorities must be monotone:
+ *  enqueueing a priority below that of an entry already
+ *  dequeued or peeked at signals an error, unless the
+ *  queue is empty.
+ */
+class RadixHeapPriorityQueue {
+public:
+    /*
+     *  Constructor: RadixHeapPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes a new, empty RadixHeapPriorityQueue.
+     */
+    RadixHeapPriorityQueue();
+
+    /*
+     *  Destructor: ~RadixHeapPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Frees the buckets.
+     */
+    ~RadixHeapPriorityQueue();
+
+    /*
+     *  Method: accepts
+     *  Parameters: int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns whether an entry of the given priority can
+     *  be enqueued without breaking monotonicity.
+     */
+    bool accepts(int priority) const;
+
+    /*
+     *  Method: clear
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes all items from the PriorityQueue.
+     */
+    void clear();
+
+    /*
+     *  Method: dequeue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value of the highest priority item in the
+     *  PriorityQueue and also removes it from the queue.
+     */
+    string dequeue();
+
+    /*
+     *  Method: enqueue
+     *  Parameters: string value
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Adds a user-defined item to the PriorityQueue given
+     *  the item's key and its corresponding priority level.
+     *  Signals an error if the priority is lower than the
+     *  front priority and the queue is not empty.
+     */
+    void enqueue(string value, int priority);
+
+    /*
+     *  Method: isEmpty
+     *  - - - - - - - - - - - - - - - - - -
+     *  Determines whether the PriorityQueue is empty.
+     */
+    bool isEmpty() const;
+
+    /*
+     *  Method: peek
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value of the highest priority item in the
+     *  PriorityQueue without removing it.
+     */
+    string peek() const;
+
+    /*
+     *  Method: peekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the priority of the highest priority item in the
+     *  PriorityQueue without removing it.
+     */
+    int peekPriority() const;
+
+    /*
+     *  Method: size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the size of the PriorityQueue.
+     */
+    int size() const;
+
+    /*
+     *  Methods: tryDequeue, tryPeek, tryPeekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Work as dequeue, peek and peekPriority, but on an empty
+     *  queue return false or NULL instead of throwing. tryPeek
+     *  returns a pointer to the value, good until the queue is
+     *  next changed.
+     */
+    bool tryDequeue(string& value);
+    const string* tryPeek() const;
+    bool tryPeekPriority(int& priority) const;
+
+private:
+    /*
+     *  Method: bucketFor
+     *  Parameters: uint32_t key
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the bucket of a key: 0 if it equals the
+     *  front key, otherwise one more than the index of the
+     *  highest bit in which the two differ.
+     */
+    int bucketFor(uint32_t key) const;
+
+    /*
+     *  Method: refill
+     *  - - - - - - - - - - - - - - - - - -
+     *  Moves the smallest key of the first non-empty bucket
+     *  to the front and redistributes that bucket, so that
+     *  the front bucket holds the most urgent entries. It
+     *  only reorganizes the queue, so peeks may call it.
+     */
+    void refill() const;
+
+    /*
+     *  Method: toKey
+     *  Parameters: int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Maps a priority to an unsigned key of the same order.
+     */
+    static uint32_t toKey(int priority);
+
+    static const int kBucketCount = 33;
+
+    /*
+     *  Array: buckets
+     *  - - - - - - - - - - - - - - - - - -
+     *  The buckets of entries. Bucket 0 is a min-heap of
+     *  entries all sharing the front priority; the others
+     *  are unordered.
+     */
+    mutable vector<PQEntry> buckets[kBucketCount];
+
+    /*
+     *  Integer: frontKey
+     *  - - - - - - - - - - - - - -
+     *  The key that bucket 0 holds: that of the entry last
+     *  dequeued or peeked at, which no entry is below.
+     */
+    mutable uint32_t frontKey;
+
+    /*
+     *  Integer: queueSize
+     *  - - - - - - - - - - - - - -
+     *  Current number of entries in the buckets.
+     */
+    int queueSize;
+
+    /*
+     *  TieBreakPolicy: policy
+     *  - - - - - - - - - - - - - -
+     *  The tie-break policy in effect when the queue
+     *  was constructed, stamped on each entry.
+     */
+    TieBreakPolicy policy;
+
+    /*
+     *  Integer: enqueueCount
+     *  - - - - - - - - - - - - - -
+     *  The sequence the queue stamps on the next entry it
+     *  enqueues, so entries are numbered per queue.
+     */
+    unsigned long long enqueueCount;
+};
+
+#endif
@@ -0,0 +1,365 @@
+/*
+ *  File: SharedMemoryPriorityQueue.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the SharedMemoryPriorityQueue,
+ *  a binary heap of slot indices laid out in a POSIX
+ *  shared-memory segment.
+ */
+
+#include "SharedMemoryPriorityQueue.h"
+
+#ifndef _WIN32
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ *  Written into the segment header once the creating
+ *  process has finished initializing the segment.
+ */
+static const uint32_t kSegmentMagic = 0x50514d53;
+
+/*
+ *  Null link used by the slot free list.
+ */
+static const int kNoSlot = -1;
+
+/*
+ *  Robust mutexes arrived with POSIX.1-2008. PTHREAD_MUTEX_ROBUST
+ *  is an enumerator rather than a macro, so the version is
+ *  tested instead of the name.
+ */
+#if defined(_POSIX_THREADS) && _POSIX_VERSION >= 200809L
+#define kRobustMutexes 1
+#else
+#define kRobustMutexes 0
+#endif
+
+/*
+ *  Struct: SharedSegment
+ *  - - - - - - - - - - - - - -
+ *  Header at the start of the segment. The slot array and
+ *  the heap follow it, at offsets from the segment start.
+ */
+struct SharedMemoryPriorityQueue::SharedSegment {
+    volatile uint32_t magic;
+    pthread_mutex_t mutex;
+    int32_t capacity;
+    int32_t size;
+    int32_t freeList;
+    uint64_t slotsOffset;
+    uint64_t heapOffset;
+};
+
+/*
+ *  Struct: SharedSlot
+ *  - - - - - - - - - - - - - -
+ *  A value and its priority, stored inline. A slot is
+ *  marked in use only after its value has been written,
+ *  and unmarked before it is freed, so repair can
+ *  trust the mark.
+ */
+struct SharedMemoryPriorityQueue::SharedSlot {
+    int32_t priority;
+    int32_t length;
+    int32_t nextFree;
+    int32_t inUse;
+    char value[kMaxValueLength];
+};
+
+/*
+ *  Class: SegmentLock
+ *  - - - - - - - - - - - - - -
+ *  Holds the segment's mutex for the lifetime of the object,
+ *  repairing the queue if the previous owner died holding it.
+ */
+class SharedMemoryPriorityQueue::SegmentLock {
+public:
+    SegmentLock(const SharedMemoryPriorityQueue *queue) {
+        mutex = &queue->segment->mutex;
+        int result = pthread_mutex_lock(mutex);
+#if kRobustMutexes
+        if(result == EOWNERDEAD) {
+            const_cast<SharedMemoryPriorityQueue *>(queue)->repair();
+            pthread_mutex_consistent(mutex);
+            result = 0;
+        }
+#endif
+        if(result != 0) error("SharedMemoryPriorityQueue: cannot lock the segment");
+    }
+
+    ~SegmentLock() {
+        pthread_mutex_unlock(mutex);
+    }
+
+private:
+    pthread_mutex_t *mutex;
+};
+
+SharedMemoryPriorityQueue::SharedMemoryPriorityQueue(string name, int capacity) {
+    if(capacity < 1) error("SharedMemoryPriorityQueue: capacity must be positive");
+    this->name = name;
+    size_t slotsOffset = (sizeof(SharedSegment) + 63) / 64 * 64;
+    size_t heapOffset = slotsOffset + (size_t) capacity * sizeof(SharedSlot);
+    size_t length = heapOffset + (size_t) capacity * sizeof(int32_t);
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    bool creator = fd >= 0;
+    if(creator) {
+        if(ftruncate(fd, length) != 0) {
+            close(fd);
+            shm_unlink(name.c_str());
+            error("SharedMemoryPriorityQueue: cannot size segment " + name);
+        }
+    } else {
+        if(errno != EEXIST) error("SharedMemoryPriorityQueue: cannot create segment " + name);
+        fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if(fd < 0) error("SharedMemoryPriorityQueue: cannot open segment " + name);
+        /*
+         *  Wait for the creator to size and initialize the segment.
+         */
+        struct stat info;
+        for(int attempt = 0; ; attempt++) {
+            if(fstat(fd, &info) != 0 || attempt == 1000) {
+                close(fd);
+                error("SharedMemoryPriorityQueue: segment " + name + " was never initialized");
+            }
+            if((size_t) info.st_size >= sizeof(SharedSegment)) break;
+            usleep(1000);
+        }
+        length = info.st_size;
+    }
+
+    void *address = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(address == MAP_FAILED) error("SharedMemoryPriorityQueue: cannot map segment " + name);
+    segment = (SharedSegment *) address;
+    mappedLength = length;
+
+    if(creator) {
+        pthread_mutexattr_t attributes;
+        pthread_mutexattr_init(&attributes);
+        pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+#if kRobustMutexes
+        pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+#endif
+        pthread_mutex_init(&segment->mutex, &attributes);
+        pthread_mutexattr_destroy(&attributes);
+        segment->capacity = capacity;
+        segment->size = 0;
+        segment->slotsOffset = slotsOffset;
+        segment->heapOffset = heapOffset;
+        SharedSlot *slot = slots();
+        for(int i = 0; i < capacity; i++) {
+            slot[i].inUse = 0;
+            slot[i].nextFree = (i + 1 < capacity) ? i + 1 : kNoSlot;
+        }
+        segment->freeList = 0;
+        __sync_synchronize();
+        segment->magic = kSegmentMagic;
+    } else {
+        for(int attempt = 0; segment->magic != kSegmentMagic; attempt++) {
+            if(attempt == 1000) {
+                munmap(address, length);
+                error("SharedMemoryPriorityQueue: segment " + name + " was never initialized");
+            }
+            usleep(1000);
+        }
+        __sync_synchronize();
+    }
+}
+
+SharedMemoryPriorityQueue::~SharedMemoryPriorityQueue() {
+    munmap((void *) segment, mappedLength);
+}
+
+int SharedMemoryPriorityQueue::capacity() const {
+    return segment->capacity;
+}
+
+void SharedMemoryPriorityQueue::clear() {
+    SegmentLock lock(this);
+    SharedSlot *slot = slots();
+    for(int i = 0; i < segment->capacity; i++) {
+        slot[i].inUse = 0;
+    }
+    repair();
+}
+
+string SharedMemoryPriorityQueue::dequeue() {
+    string value;
+    if(!tryDequeue(value)) error("The queue is empty");
+    return value;
+}
+
+void SharedMemoryPriorityQueue::enqueue(string value, int priority) {
+    if(value.length() > (size_t) kMaxValueLength) {
+        error("SharedMemoryPriorityQueue: value is longer than the slot size");
+    }
+    SegmentLock lock(this);
+    if(segment->freeList == kNoSlot) error("SharedMemoryPriorityQueue: the queue is full");
+    int index = segment->freeList;
+    SharedSlot& slot = slots()[index];
+    segment->freeList = slot.nextFree;
+    slot.priority = priority;
+    slot.length = value.length();
+    memcpy(slot.value, value.data(), value.length());
+    slot.inUse = 1;
+    heap()[segment->size] = index;
+    segment->size++;
+    percolateUp(segment->size - 1);
+}
+
+bool SharedMemoryPriorityQueue::isEmpty() const {
+    return size() == 0;
+}
+
+string SharedMemoryPriorityQueue::peek() const {
+    const string *value = tryPeek();
+    if(value == NULL) error("The queue is empty");
+    return *value;
+}
+
+int SharedMemoryPriorityQueue::peekPriority() const {
+    int priority = 0;
+    if(!tryPeekPriority(priority)) error("The queue is empty");
+    return priority;
+}
+
+int SharedMemoryPriorityQueue::size() const {
+    SegmentLock lock(this);
+    return segment->size;
+}
+
+bool SharedMemoryPriorityQueue::tryDequeue(string& value) {
+    SegmentLock lock(this);
+    if(segment->size == 0) return false;
+    int *order = heap();
+    SharedSlot& top = slots()[order[0]];
+    value.assign(top.value, top.length);
+    top.inUse = 0;
+    top.nextFree = segment->freeList;
+    segment->freeList = order[0];
+    segment->size--;
+    if(segment->size > 0) {
+        order[0] = order[segment->size];
+        trickleDown(0);
+    }
+    return true;
+}
+
+const string* SharedMemoryPriorityQueue::tryPeek() const {
+    SegmentLock lock(this);
+    if(segment->size == 0) return NULL;
+    const SharedSlot& top = slots()[heap()[0]];
+    peeked.assign(top.value, top.length);
+    return &peeked;
+}
+
+bool SharedMemoryPriorityQueue::tryPeekPriority(int& priority) const {
+    SegmentLock lock(this);
+    if(segment->size == 0) return false;
+    priority = slots()[heap()[0]].priority;
+    return true;
+}
+
+void SharedMemoryPriorityQueue::unlink(string name) {
+    shm_unlink(name.c_str());
+}
+
+SharedMemoryPriorityQueue::SharedSlot *SharedMemoryPriorityQueue::slots() const {
+    return (SharedSlot *) ((char *) segment + segment->slotsOffset);
+}
+
+int *SharedMemoryPriorityQueue::heap() const {
+    return (int *) ((char *) segment + segment->heapOffset);
+}
+
+bool SharedMemoryPriorityQueue::lessThan(int slot1, int slot2) const {
+    const SharedSlot& a = slots()[slot1];
+    const SharedSlot& b = slots()[slot2];
+    if(a.priority != b.priority) return a.priority < b.priority;
+    int common = (a.length < b.length) ? a.length : b.length;
+    int result = memcmp(a.value, b.value, common);
+    return result < 0 || (result == 0 && a.length < b.length);
+}
+
+void SharedMemoryPriorityQueue::percolateUp(int index) {
+    int *order = heap();
+    int child = order[index];
+    while(index > 0) {
+        int parentIndex = (index - 1) / 2;
+        if(!lessThan(child, order[parentIndex])) break;
+        order[index] = order[parentIndex];
+        index = parentIndex;
+    }
+    order[index] = child;
+}
+
+void SharedMemoryPriorityQueue::trickleDown(int index) {
+    int *order = heap();
+    int count = segment->size;
+    int node = order[index];
+    while(true) {
+        int childIndex = 2 * index + 1;
+        if(childIndex >= count) break;
+        if(childIndex + 1 < count && lessThan(order[childIndex + 1], order[childIndex])) childIndex++;
+        if(!lessThan(order[childIndex], node)) break;
+        order[index] = order[childIndex];
+        index = childIndex;
+    }
+    order[index] = node;
+}
+
+void SharedMemoryPriorityQueue::repair() {
+    SharedSlot *slot = slots();
+    int *order = heap();
+    segment->size = 0;
+    segment->freeList = kNoSlot;
+    for(int i = segment->capacity - 1; i >= 0; i--) {
+        if(slot[i].inUse) {
+            order[segment->size++] = i;
+        } else {
+            slot[i].nextFree = segment->freeList;
+            segment->freeList = i;
+        }
+    }
+    for(int i = segment->size / 2 - 1; i >= 0; i--) {
+        trickleDown(i);
+    }
+}
+
+#else
+
+/*
+ *  POSIX shared memory is not available, so the
+ *  queue reports an error as soon as it is created.
+ */
+
+SharedMemoryPriorityQueue::SharedMemoryPriorityQueue(string, int) {
+    segment = NULL;
+    mappedLength = 0;
+    error("SharedMemoryPriorityQueue: shared memory is not supported on this platform");
+}
+
+SharedMemoryPriorityQueue::~SharedMemoryPriorityQueue() {}
+int SharedMemoryPriorityQueue::capacity() const { return 0; }
+void SharedMemoryPriorityQueue::clear() {}
+string SharedMemoryPriorityQueue::dequeue() { return ""; }
+void SharedMemoryPriorityQueue::enqueue(string, int) {}
+bool SharedMemoryPriorityQueue::isEmpty() const { return true; }
+string SharedMemoryPriorityQueue::peek() const { return ""; }
+int SharedMemoryPriorityQueue::peekPriority() const { return 0; }
+int SharedMemoryPriorityQueue::size() const { return 0; }
+bool SharedMemoryPriorityQueue::tryDequeue(string&) { return false; }
+const string* SharedMemoryPriorityQueue::tryPeek() const { return NULL; }
+bool SharedMemoryPriorityQueue::tryPeekPriority(int&) const { return false; }
+void SharedMemoryPriorityQueue::unlink(string) {}
+
+#endif
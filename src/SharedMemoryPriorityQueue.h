@@ -0,0 +1,214 @@
+/*
+ *  File: SharedMemoryPriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the SharedMemoryPriorityQueue,
+ *  a binary heap laid out in a POSIX shared-memory
+ *  segment so that several processes on one host
+ *  can enqueue and dequeue from the same queue.
+ */
+
+#ifndef _sharedmemorypriorityqueue_h
+#define _sharedmemorypriorityqueue_h
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include "error.h"
+using namespace std;
+
+/*
+ *  Class: SharedMemoryPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class offers the same operations as the
+ *  HeapPriorityQueue, but keeps its state in a named
+ *  shared-memory segment rather than in the process.
+ *  The segment holds a header, a fixed array of value
+ *  slots and a heap of 32-bit slot indices; everything
+ *  is addressed by offset, since each process maps the
+ *  segment at a different address. Values are stored
+ *  inline in their slot, so their length is bounded by
+ *  kMaxValueLength. Every operation holds a robust,
+ *  process-shared mutex, and a process that dies while
+ *  holding it leaves the heap to be rebuilt from the
+ *  slots by the next process to lock it.
+ */
+class SharedMemoryPriorityQueue {
+public:
+    /*
+     *  Constructor: SharedMemoryPriorityQueue
+     *  Parameters: string name
+     *              int capacity
+     *  - - - - - - - - - - - - - - - - - -
+     *  Attaches to the shared-memory segment with the given
+     *  name, such as "/jobs". If no such segment exists, it is
+     *  created with room for capacity entries; otherwise the
+     *  capacity chosen by its creator is used.
+     */
+    SharedMemoryPriorityQueue(string name, int capacity = kDefaultCapacity);
+
+    /*
+     *  Destructor: ~SharedMemoryPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Detaches from the segment. The segment and its entries
+     *  remain until removed with unlink.
+     */
+    ~SharedMemoryPriorityQueue();
+
+    /*
+     *  Method: capacity
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the number of entries the segment can hold.
+     */
+    int capacity() const;
+
+    /*
+     *  Method: clear
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes all items from the shared queue.
+     */
+    void clear();
+
+    /*
+     *  Method: dequeue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value of the highest priority item in the
+     *  PriorityQueue and also removes it from the queue.
+     *  The last slot index in the heap replaces the root and
+     *  trickles down, and the removed slot is freed.
+     */
+    string dequeue();
+
+    /*
+     *  Method: enqueue
+     *  Parameters: string value
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Adds a user-defined item to the PriorityQueue given
+     *  the item's key and its corresponding priority level.
+     *  The value is copied into a free slot whose index then
+     *  percolates up the heap. Signals an error if the value
+     *  is longer than kMaxValueLength or the segment is full.
+     */
+    void enqueue(string value, int priority);
+
+    /*
+     *  Method: isEmpty
+     *  - - - - - - - - - - - - - - - - - -
+     *  Determines whether the PriorityQueue is empty.
+     */
+    bool isEmpty() const;
+
+    /*
+     *  Method: peek
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value of the highest priority item in the
+     *  PriorityQueue without removing it.
+     */
+    string peek() const;
+
+    /*
+     *  Method: peekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the priority of the highest priority item in the
+     *  PriorityQueue without removing it.
+     */
+    int peekPriority() const;
+
+    /*
+     *  Method: size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the size of the PriorityQueue.
+     */
+    int size() const;
+
+    /*
+     *  Methods: tryDequeue, tryPeek, tryPeekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Work as dequeue, peek and peekPriority, but on an empty
+     *  queue return false or NULL instead of throwing. Another
+     *  process can empty the queue between a call to isEmpty
+     *  and a dequeue, so tryDequeue is the safe way for several
+     *  consumers to drain it. tryPeek copies the value out of
+     *  the segment and returns a pointer to the copy, good
+     *  until the next tryPeek on this object.
+     */
+    bool tryDequeue(string& value);
+    const string* tryPeek() const;
+    bool tryPeekPriority(int& priority) const;
+
+    /*
+     *  Method: unlink
+     *  Parameters: string name
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes the named segment. Processes still attached
+     *  keep using it until they detach.
+     */
+    static void unlink(string name);
+
+    /*
+     *  Integer: kMaxValueLength
+     *  - - - - - - - - - - - - - -
+     *  Longest value that fits inline in a slot.
+     */
+    static const int kMaxValueLength = 112;
+
+private:
+    struct SharedSegment;
+    struct SharedSlot;
+    class SegmentLock;
+
+    SharedMemoryPriorityQueue(const SharedMemoryPriorityQueue& other);
+    SharedMemoryPriorityQueue& operator =(const SharedMemoryPriorityQueue& other);
+
+    /*
+     *  Methods: slots, heap
+     *  - - - - - - - - - - - - - - - - - -
+     *  Return this process's addresses of the slot array
+     *  and the heap, found by offset from the segment.
+     */
+    SharedSlot *slots() const;
+    int *heap() const;
+
+    /*
+     *  Method: lessThan
+     *  Parameters: int slot1
+     *              int slot2
+     *  - - - - - - - - - - - - - - - - - -
+     *  Compares two slots by priority and then by value,
+     *  matching the ordering of PQEntry.
+     */
+    bool lessThan(int slot1, int slot2) const;
+
+    /*
+     *  Methods: percolateUp, trickleDown
+     *  Parameters: int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Restore the heap order after the slot index at the
+     *  given heap position has been added or replaced.
+     */
+    void percolateUp(int index);
+    void trickleDown(int index);
+
+    /*
+     *  Method: repair
+     *  - - - - - - - - - - - - - - - - - -
+     *  Rebuilds the free list and the heap from the slots that
+     *  are marked in use. Called with the mutex held after its
+     *  previous owner died part way through an operation.
+     */
+    void repair();
+
+    /*
+     *  Integer: kDefaultCapacity
+     *  - - - - - - - - - - - - - -
+     *  Capacity of a newly created segment.
+     */
+    static const int kDefaultCapacity = 1 << 16;
+
+    string name;
+    SharedSegment *segment;
+    size_t mappedLength;
+    mutable string peeked;
+};
+
+#endif
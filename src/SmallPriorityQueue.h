@@ -0,0 +1,242 @@
+/*
+ *  File: SmallPriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the SmallPriorityQueue, which
+ *  keeps the first few entries of any of the priority
+ *  queues inline, so that small queues never touch
+ *  the heap allocator.
+ */
+
+#ifndef _smallpriorityqueue_h
+#define _smallpriorityqueue_h
+
+#include <string>
+#include <utility>    // for move
+#include "PQEntry.h"
+#include "OperationCounters.h"
+#include "error.h"
+using namespace std;
+
+/*
+ *  Class: SmallPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class stores up to N entries in an array inside
+ *  the object itself, sorted from lowest to highest
+ *  priority so the most urgent entry is at the end, and
+ *  only spills to a queue of type PQueue once an enqueue
+ *  would exceed N. The engine is allocated on the first
+ *  spill and kept for reuse; while spilled every call
+ *  goes to it, and once it empties the inline array
+ *  takes over again. The engine is built under the
+ *  tie-break policy this queue was constructed with.
+ *
+ *  Constructing, filling and draining a queue that never
+ *  holds more than N entries therefore makes no heap
+ *  allocations for the queue itself, as long as its
+ *  values are short enough for the string's own inline
+ *  buffer. For N of 16 the inline array spans a handful
+ *  of cache lines and an enqueue shifts at most N moves.
+ */
+template <typename PQueue, int N = 16>
+class SmallPriorityQueue {
+public:
+    /*
+     *  Constructor: SmallPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes an empty queue without allocating.
+     */
+    SmallPriorityQueue();
+
+    /*
+     *  Destructor: ~SmallPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Frees the engine, if the queue ever spilled.
+     */
+    ~SmallPriorityQueue();
+
+    /*
+     *  Methods: clear, dequeue, enqueue, isEmpty,
+     *           peek, peekPriority, size,
+     *           tryDequeue, tryPeek, tryPeekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Work on the inline array, or forward to the
+     *  engine while the queue is spilled.
+     */
+    void clear();
+    string dequeue();
+    void enqueue(string value, int priority);
+    bool isEmpty() const;
+    const string& peek() const;
+    int peekPriority() const;
+    int size() const;
+    bool tryDequeue(string& value);
+    const string* tryPeek() const;
+    bool tryPeekPriority(int& priority) const;
+
+    /*
+     *  Method: isSpilled
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns whether the entries are currently in the engine.
+     */
+    bool isSpilled() const;
+
+private:
+    SmallPriorityQueue(const SmallPriorityQueue& other);
+    SmallPriorityQueue& operator =(const SmallPriorityQueue& other);
+
+    /*
+     *  Method: spill
+     *  - - - - - - - - - - - - - - - - - -
+     *  Moves the inline entries into the engine,
+     *  allocating it if this is the first spill.
+     */
+    void spill();
+
+    PQEntry inlineEntries[N];
+    int inlineCount;
+    PQueue *engine;
+    bool spilled;
+    TieBreakPolicy policy;
+    unsigned long long enqueueCount;
+};
+
+/* Implementation section */
+
+template <typename PQueue, int N>
+SmallPriorityQueue<PQueue, N>::SmallPriorityQueue() {
+    inlineCount = 0;
+    engine = NULL;
+    spilled = false;
+    policy = getTieBreakPolicy();
+    enqueueCount = 0;
+}
+
+template <typename PQueue, int N>
+SmallPriorityQueue<PQueue, N>::~SmallPriorityQueue() {
+    delete engine;
+}
+
+template <typename PQueue, int N>
+void SmallPriorityQueue<PQueue, N>::clear() {
+    for(int i = 0; i < inlineCount; i++) {
+        inlineEntries[i] = PQEntry();
+    }
+    inlineCount = 0;
+    if(engine != NULL) engine->clear();
+    spilled = false;
+}
+
+template <typename PQueue, int N>
+string SmallPriorityQueue<PQueue, N>::dequeue() {
+    if(spilled) {
+        string value = engine->dequeue();
+        if(engine->isEmpty()) spilled = false;
+        return value;
+    }
+    if(inlineCount == 0) error("The queue is empty");
+    inlineCount--;
+    string value = std::move(inlineEntries[inlineCount].value);
+    inlineEntries[inlineCount].value.clear();
+    return value;
+}
+
+template <typename PQueue, int N>
+void SmallPriorityQueue<PQueue, N>::enqueue(string value, int priority) {
+    if(!spilled && inlineCount == N) spill();
+    if(spilled) {
+        engine->enqueue(std::move(value), priority);
+        return;
+    }
+    /*
+     *  Walk down from the most urgent end, moving each entry
+     *  more urgent than the new one up a slot, and drop the
+     *  new one in the gap.
+     */
+    PQEntry newEntry(std::move(value), priority, policy, enqueueCount++);
+    int index = inlineCount;
+    while(index > 0 && inlineEntries[index - 1] < newEntry) {
+        inlineEntries[index] = std::move(inlineEntries[index - 1]);
+        index--;
+    }
+    inlineEntries[index] = std::move(newEntry);
+    inlineCount++;
+}
+
+template <typename PQueue, int N>
+bool SmallPriorityQueue<PQueue, N>::isEmpty() const {
+    return spilled ? engine->isEmpty() : inlineCount == 0;
+}
+
+template <typename PQueue, int N>
+const string& SmallPriorityQueue<PQueue, N>::peek() const {
+    const string *value = tryPeek();
+    if(value == NULL) error("The queue is empty");
+    return *value;
+}
+
+template <typename PQueue, int N>
+int SmallPriorityQueue<PQueue, N>::peekPriority() const {
+    if(spilled) return engine->peekPriority();
+    if(inlineCount == 0) error("The queue is empty");
+    return inlineEntries[inlineCount - 1].priority;
+}
+
+template <typename PQueue, int N>
+int SmallPriorityQueue<PQueue, N>::size() const {
+    return spilled ? engine->size() : inlineCount;
+}
+
+template <typename PQueue, int N>
+bool SmallPriorityQueue<PQueue, N>::tryDequeue(string& value) {
+    if(spilled) {
+        engine->tryDequeue(value);
+        if(engine->isEmpty()) spilled = false;
+        return true;
+    }
+    if(inlineCount == 0) return false;
+    inlineCount--;
+    value = std::move(inlineEntries[inlineCount].value);
+    inlineEntries[inlineCount].value.clear();
+    return true;
+}
+
+template <typename PQueue, int N>
+const string* SmallPriorityQueue<PQueue, N>::tryPeek() const {
+    if(spilled) return engine->tryPeek();
+    if(inlineCount == 0) return NULL;
+    return &inlineEntries[inlineCount - 1].value;
+}
+
+template <typename PQueue, int N>
+bool SmallPriorityQueue<PQueue, N>::tryPeekPriority(int& priority) const {
+    if(spilled) return engine->tryPeekPriority(priority);
+    if(inlineCount == 0) return false;
+    priority = inlineEntries[inlineCount - 1].priority;
+    return true;
+}
+
+template <typename PQueue, int N>
+bool SmallPriorityQueue<PQueue, N>::isSpilled() const {
+    return spilled;
+}
+
+template <typename PQueue, int N>
+void SmallPriorityQueue<PQueue, N>::spill() {
+    if(engine == NULL) {
+        TieBreakScope scope(policy);
+        engine = new PQueue;
+        PQ_COUNT(allocations);
+    }
+    /*
+     *  Enqueue the most urgent entries first, which is
+     *  the cheap order for the sorted engines.
+     */
+    for(int i = inlineCount - 1; i >= 0; i--) {
+        engine->enqueue(std::move(inlineEntries[i].value), inlineEntries[i].priority);
+        inlineEntries[i] = PQEntry();
+    }
+    inlineCount = 0;
+    spilled = true;
+}
+
+#endif
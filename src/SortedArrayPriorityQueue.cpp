@@ -0,0 +1,86 @@
+/*
+ *  File: SortedArrayPriorityQueue.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the SortedArrayPriorityQueue,
+ *  which keeps its entries in one sorted array.
+ */
+
+#include "SortedArrayPriorityQueue.h"
+#include <utility>    // for move
+
+SortedArrayPriorityQueue::SortedArrayPriorityQueue() {
+    policy = getTieBreakPolicy();
+    enqueueCount = 0;
+}
+
+SortedArrayPriorityQueue::~SortedArrayPriorityQueue() {
+
+}
+
+void SortedArrayPriorityQueue::clear() {
+    sortedEntries.clear();
+}
+
+string SortedArrayPriorityQueue::dequeue() {
+    string value;
+    if(!tryDequeue(value)) error("The queue is empty");
+    return value;
+}
+
+void SortedArrayPriorityQueue::enqueue(string value, int priority) {
+    PQEntry newEntry(std::move(value), priority, policy, enqueueCount++);
+    /*
+     *  Find the first entry more urgent than the new one;
+     *  the new entry goes just before it.
+     */
+    int low = 0;
+    int high = sortedEntries.size();
+    while(low < high) {
+        int middle = (low + high) / 2;
+        if(sortedEntries[middle] < newEntry) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    sortedEntries.insert(low, newEntry);
+}
+
+bool SortedArrayPriorityQueue::isEmpty() const {
+    return sortedEntries.isEmpty();
+}
+
+string SortedArrayPriorityQueue::peek() const {
+    const string *value = tryPeek();
+    if(value == NULL) error("The queue is empty");
+    return *value;
+}
+
+int SortedArrayPriorityQueue::peekPriority() const {
+    int priority = 0;
+    if(!tryPeekPriority(priority)) error("The queue is empty");
+    return priority;
+}
+
+int SortedArrayPriorityQueue::size() const {
+    return sortedEntries.size();
+}
+
+bool SortedArrayPriorityQueue::tryDequeue(string& value) {
+    if(sortedEntries.isEmpty()) return false;
+    int last = sortedEntries.size() - 1;
+    value = std::move(sortedEntries[last].value);
+    sortedEntries.remove(last);
+    return true;
+}
+
+const string* SortedArrayPriorityQueue::tryPeek() const {
+    if(sortedEntries.isEmpty()) return NULL;
+    return &sortedEntries[sortedEntries.size() - 1].value;
+}
+
+bool SortedArrayPriorityQueue::tryPeekPriority(int& priority) const {
+    if(sortedEntries.isEmpty()) return false;
+    priority = sortedEntries[sortedEntries.size() - 1].priority;
+    return true;
+}
@@ -0,0 +1,141 @@
+/*
+ *  File: SortedArrayPriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the SortedArrayPriorityQueue,
+ *  which keeps its entries in one sorted array. It
+ *  is the fastest queue while there are only a few
+ *  dozen entries, or while a queue is mostly drained.
+ */
+
+#ifndef _sortedarraypriorityqueue_h
+#define _sortedarraypriorityqueue_h
+
+#include <iostream>
+#include <string>
+#include "vector.h"
+#include "PQEntry.h"
+#include "error.h"
+using namespace std;
+
+/*
+ *  Class: SortedArrayPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class maintains its entries in a Vector sorted
+ *  from lowest to highest priority, so the most urgent
+ *  entry is always at the end. Dequeueing and peeking
+ *  take constant time; enqueueing binary searches for
+ *  the entry's place and shifts the entries after it,
+ *  which is linear but, for small queues, cheaper than
+ *  a heap's scattered swaps.
+ */
+class SortedArrayPriorityQueue {
+public:
+    /*
+     *  Constructor: SortedArrayPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes a new, empty SortedArrayPriorityQueue.
+     */
+    SortedArrayPriorityQueue();
+
+    /*
+     *  Destructor: ~SortedArrayPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Frees any heap storage allocated by the Vector.
+     */
+    ~SortedArrayPriorityQueue();
+
+    /*
+     *  Method: clear
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes all items from the PriorityQueue.
+     */
+    void clear();
+
+    /*
+     *  Method: dequeue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value of the highest priority item in the
+     *  PriorityQueue and also removes it from the queue,
+     *  by taking it off the end of the array.
+     */
+    string dequeue();
+
+    /*
+     *  Method: enqueue
+     *  Parameters: string value
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Adds a user-defined item to the PriorityQueue given
+     *  the item's key and its corresponding priority level,
+     *  inserting it where it keeps the array sorted.
+     */
+    void enqueue(string value, int priority);
+
+    /*
+     *  Method: isEmpty
+     *  - - - - - - - - - - - - - - - - - -
+     *  Determines whether the PriorityQueue is empty.
+     */
+    bool isEmpty() const;
+
+    /*
+     *  Method: peek
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the value of the highest priority item in the
+     *  PriorityQueue without removing it.
+     */
+    string peek() const;
+
+    /*
+     *  Method: peekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the priority of the highest priority item in the
+     *  PriorityQueue without removing it.
+     */
+    int peekPriority() const;
+
+    /*
+     *  Method: size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the size of the PriorityQueue.
+     */
+    int size() const;
+
+    /*
+     *  Methods: tryDequeue, tryPeek, tryPeekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Work as dequeue, peek and peekPriority, but on an empty
+     *  queue return false or NULL instead of throwing. tryPeek
+     *  returns a pointer to the value, good until the queue is
+     *  next changed.
+     */
+    bool tryDequeue(string& value);
+    const string* tryPeek() const;
+    bool tryPeekPriority(int& priority) const;
+
+private:
+    /*
+     *  Vector: sortedEntries
+     *  - - - - - - - - - - - - - - - - - -
+     *  The entries, from lowest to highest priority.
+     */
+    Vector<PQEntry> sortedEntries;
+
+    /*
+     *  TieBreakPolicy: policy
+     *  - - - - - - - - - - - - - - - - - -
+     *  The tie-break policy in effect when the queue
+     *  was constructed, stamped on each entry.
+     */
+    TieBreakPolicy policy;
+
+    /*
+     *  Integer: enqueueCount
+     *  - - - - - - - - - - - - - - - - - -
+     *  The sequence the queue stamps on the next entry it
+     *  enqueues, so entries are numbered per queue.
+     */
+    unsigned long long enqueueCount;
+};
+
+#endif
@@ -0,0 +1,231 @@
+/*
+ *  File: TimingWheelPriorityQueue.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the TimingWheelPriorityQueue,
+ *  which allows for scheduling and cancelling in
+ *  constant time since entries are hashed into
+ *  the slots of a hierarchical timing wheel.
+ */
+
+#include "TimingWheelPriorityQueue.h"
+#include <algorithm>
+
+TimingWheelPriorityQueue::TimingWheelPriorityQueue(long (*clock)()) {
+    this->clock = clock;
+    currentTick = clock();
+    freeList = kNoNode;
+    count = 0;
+    for(int i = 0; i <= kDueSlot; i++) {
+        slotHeads[i] = kNoNode;
+    }
+    for(int level = 0; level <= kLevels; level++) {
+        levelCounts[level] = 0;
+    }
+}
+
+TimingWheelPriorityQueue::~TimingWheelPriorityQueue() {
+
+}
+
+Vector<string> TimingWheelPriorityQueue::advance() {
+    return advanceTo(clock());
+}
+
+Vector<string> TimingWheelPriorityQueue::advanceTo(long nowMS) {
+    Vector<string> expired;
+    long long now = nowMS;
+    /*
+     *  Entries on the due list expired before every slot
+     *  of the wheel, so they are handed back first.
+     */
+    if(slotHeads[kDueSlot] != kNoNode) fireSlot(kDueSlot, expired);
+    while(currentTick <= now) {
+        if(count == 0) {
+            currentTick = now + 1;
+            break;
+        }
+        if((currentTick & kSlotMask) == 0) cascade();
+        int level = lowestOccupiedLevel();
+        if(level == 0) {
+            int slot = (int) (currentTick & kSlotMask);
+            if(slotHeads[slot] != kNoNode) fireSlot(slot, expired);
+            currentTick++;
+        } else {
+            /*
+             *  Nothing can expire before the next boundary of the
+             *  lowest occupied level, so jump straight to it.
+             */
+            int shift = kSlotBits * min(level, kLevels - 1);
+            long long boundary = ((currentTick >> shift) + 1) << shift;
+            currentTick = min(boundary, now + 1);
+        }
+    }
+    return expired;
+}
+
+bool TimingWheelPriorityQueue::cancel(TimerId id) {
+    int index = (int) (id & 0xffffffffLL);
+    int generation = (int) (id >> 32);
+    if(index < 0 || index >= nodes.size()) return false;
+    if(nodes[index].slot == kNoNode || nodes[index].generation != generation) return false;
+    unlink(index);
+    releaseNode(index);
+    return true;
+}
+
+void TimingWheelPriorityQueue::clear() {
+    for(int slot = 0; slot <= kDueSlot; slot++) {
+        while(slotHeads[slot] != kNoNode) {
+            int index = slotHeads[slot];
+            unlink(index);
+            releaseNode(index);
+        }
+    }
+}
+
+long TimingWheelPriorityQueue::currentTime() const {
+    return (long) (currentTick - 1);
+}
+
+bool TimingWheelPriorityQueue::isEmpty() const {
+    return count == 0;
+}
+
+TimingWheelPriorityQueue::TimerId TimingWheelPriorityQueue::schedule(string value, long expiryMS) {
+    int index;
+    if(freeList != kNoNode) {
+        index = freeList;
+        freeList = nodes[index].next;
+    } else {
+        TimerNode newNode;
+        newNode.generation = 0;
+        nodes.add(newNode);
+        index = nodes.size() - 1;
+    }
+    TimerNode& node = nodes[index];
+    node.value = value;
+    node.expiry = expiryMS;
+    place(index);
+    return ((TimerId) node.generation << 32) | index;
+}
+
+int TimingWheelPriorityQueue::size() const {
+    return count;
+}
+
+void TimingWheelPriorityQueue::cascade() {
+    for(int level = 1; level < kLevels; level++) {
+        int shift = kSlotBits * level;
+        if((currentTick & ((1LL << shift) - 1)) != 0) return;
+        int slot = level * kSlotsPerLevel + (int) ((currentTick >> shift) & kSlotMask);
+        while(slotHeads[slot] != kNoNode) {
+            int index = slotHeads[slot];
+            unlink(index);
+            place(index);
+        }
+    }
+    /*
+     *  The top level has turned over a slot, so entries
+     *  waiting beyond its reach may now fit in the wheel.
+     */
+    int overflow = slotHeads[kOverflowSlot];
+    slotHeads[kOverflowSlot] = kNoNode;
+    count -= levelCounts[kLevels];
+    levelCounts[kLevels] = 0;
+    while(overflow != kNoNode) {
+        int next = nodes[overflow].next;
+        place(overflow);
+        overflow = next;
+    }
+}
+
+/*
+ *  Orders timer nodes by expiry and then by value,
+ *  matching the ordering of PQEntry.
+ */
+struct TimerNodeLess {
+    TimerNodeLess(const Vector<string>& values, const Vector<long long>& expiries)
+        : values(values), expiries(expiries) {}
+    bool operator ()(int a, int b) const {
+        return expiries[a] < expiries[b] ||
+                (expiries[a] == expiries[b] && values[a] < values[b]);
+    }
+    const Vector<string>& values;
+    const Vector<long long>& expiries;
+};
+
+void TimingWheelPriorityQueue::fireSlot(int slot, Vector<string>& expired) {
+    Vector<string> values;
+    Vector<long long> expiries;
+    while(slotHeads[slot] != kNoNode) {
+        int index = slotHeads[slot];
+        values.add(nodes[index].value);
+        expiries.add(nodes[index].expiry);
+        unlink(index);
+        releaseNode(index);
+    }
+    Vector<int> order;
+    for(int i = 0; i < values.size(); i++) {
+        order.add(i);
+    }
+    if(order.size() > 1) sort(order.begin(), order.end(), TimerNodeLess(values, expiries));
+    for(int i = 0; i < order.size(); i++) {
+        expired.add(values[order[i]]);
+    }
+}
+
+void TimingWheelPriorityQueue::place(int index) {
+    TimerNode& node = nodes[index];
+    int slot = kDueSlot;
+    if(node.expiry >= currentTick) {
+        long long delta = node.expiry - currentTick;
+        int level = 0;
+        while(level < kLevels && (delta >> (kSlotBits * (level + 1))) != 0) {
+            level++;
+        }
+        slot = kOverflowSlot;
+        if(level < kLevels) {
+            slot = level * kSlotsPerLevel + (int) ((node.expiry >> (kSlotBits * level)) & kSlotMask);
+        }
+        levelCounts[level]++;
+    }
+    node.slot = slot;
+    node.prev = kNoNode;
+    node.next = slotHeads[slot];
+    if(node.next != kNoNode) nodes[node.next].prev = index;
+    slotHeads[slot] = index;
+    count++;
+}
+
+void TimingWheelPriorityQueue::unlink(int index) {
+    TimerNode& node = nodes[index];
+    if(node.prev != kNoNode) {
+        nodes[node.prev].next = node.next;
+    } else {
+        slotHeads[node.slot] = node.next;
+    }
+    if(node.next != kNoNode) nodes[node.next].prev = node.prev;
+    if(node.slot != kDueSlot) {
+        int level = (node.slot == kOverflowSlot) ? kLevels : node.slot / kSlotsPerLevel;
+        levelCounts[level]--;
+    }
+    count--;
+    node.slot = kNoNode;
+}
+
+void TimingWheelPriorityQueue::releaseNode(int index) {
+    TimerNode& node = nodes[index];
+    node.value = "";
+    node.slot = kNoNode;
+    node.generation++;
+    node.next = freeList;
+    freeList = index;
+}
+
+int TimingWheelPriorityQueue::lowestOccupiedLevel() const {
+    int level = 0;
+    while(level < kLevels && levelCounts[level] == 0) {
+        level++;
+    }
+    return level;
+}
@@ -0,0 +1,297 @@
+/*
+ *  File: TimingWheelPriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the TimingWheelPriorityQueue,
+ *  which orders entries by an expiry time in
+ *  milliseconds and allows for scheduling and
+ *  cancelling in constant time since entries are
+ *  hashed into the slots of a hierarchical timing wheel.
+ */
+
+#ifndef _timingwheelpriorityqueue_h
+#define _timingwheelpriorityqueue_h
+
+#include <iostream>
+#include <string>
+#include "timer.h"
+#include "vector.h"
+#include "error.h"
+using namespace std;
+
+/*
+ *  Class: TimingWheelPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class maintains a set of values, each due
+ *  at an expiry time, and hands them back once the
+ *  wheel's clock has passed that time. Each level of
+ *  the wheel covers 256 times the span of the level
+ *  below it, so an entry is placed in a slot in
+ *  constant time and only moves down a level when
+ *  the clock reaches the span its slot covers.
+ */
+class TimingWheelPriorityQueue {
+public:
+    /*
+     *  Type: TimerId
+     *  - - - - - - - - - - - - - - - - - -
+     *  Handle returned by schedule and accepted by cancel.
+     *  It combines the index of the entry's node with a
+     *  generation count, so a handle whose entry has
+     *  already fired or been cancelled is never mistaken
+     *  for the entry that later reuses the node.
+     */
+    typedef long long TimerId;
+
+    /*
+     *  Constructor: TimingWheelPriorityQueue
+     *  Parameters: long (*clock)()
+     *  - - - - - - - - - - - - - - - - - -
+     *  Initializes a new TimingWheelPriorityQueue whose
+     *  wheel starts at the time reported by the given clock.
+     *  The clock is also used by advance, and defaults
+     *  to Timer::currentTimeMS.
+     */
+    TimingWheelPriorityQueue(long (*clock)() = Timer::currentTimeMS);
+
+    /*
+     *  Destructor: ~TimingWheelPriorityQueue
+     *  - - - - - - - - - - - - - - - - - -
+     *  Frees any heap storage allocated by TimingWheelPriorityQueue,
+     *  which is held by the Vector of timer nodes.
+     */
+    ~TimingWheelPriorityQueue();
+
+    /*
+     *  Method: advance
+     *  - - - - - - - - - - - - - - - - - -
+     *  Moves the wheel forward to the time reported by
+     *  its clock. See advanceTo.
+     */
+    Vector<string> advance();
+
+    /*
+     *  Method: advanceTo
+     *  Parameters: long nowMS
+     *  - - - - - - - - - - - - - - - - - -
+     *  Moves the wheel forward to the given time, removing
+     *  and returning the values of every entry whose expiry
+     *  is at or before it, starting with any that were
+     *  scheduled at or before currentTime after the wheel
+     *  had already been advanced past it. Values are
+     *  returned in expiry order,
+     *  and entries that expire in the same millisecond are
+     *  ordered by value, as with PQEntry. Stretches of time
+     *  without any entries in the lower levels of the wheel
+     *  are skipped over a whole slot span at a time.
+     */
+    Vector<string> advanceTo(long nowMS);
+
+    /*
+     *  Method: cancel
+     *  Parameters: TimerId id
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes the entry with the given handle in constant
+     *  time by unlinking it from its slot. Returns false if the
+     *  entry has already expired or been cancelled.
+     */
+    bool cancel(TimerId id);
+
+    /*
+     *  Method: clear
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes all entries from the TimingWheelPriorityQueue
+     *  without moving its clock.
+     */
+    void clear();
+
+    /*
+     *  Method: currentTime
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the time up to which the wheel has been advanced.
+     */
+    long currentTime() const;
+
+    /*
+     *  Method: isEmpty
+     *  - - - - - - - - - - - - - - - - - -
+     *  Determines whether any entries are still scheduled.
+     */
+    bool isEmpty() const;
+
+    /*
+     *  Method: schedule
+     *  Parameters: string value
+     *              long expiryMS
+     *  - - - - - - - - - - - - - - - - - -
+     *  Adds a value that expires at the given time and returns
+     *  a handle that can be passed to cancel. The entry is linked
+     *  into the slot of the lowest level whose span reaches its
+     *  expiry, which takes constant time. Expiry times that have
+     *  already passed are handed back by the next advance.
+     */
+    TimerId schedule(string value, long expiryMS);
+
+    /*
+     *  Method: size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the number of entries still scheduled.
+     */
+    int size() const;
+
+private:
+    struct TimerNode {
+        string value;
+        long long expiry;
+        int next;
+        int prev;
+        int slot;
+        int generation;
+    };
+
+    /*
+     *  Method: cascade
+     *  - - - - - - - - - - - - - - - - - -
+     *  Called whenever the clock crosses a slot boundary of the
+     *  lowest level. Empties the slot of each higher level whose
+     *  span begins at the current time, placing its entries
+     *  again relative to the new time so they move down the wheel.
+     */
+    void cascade();
+
+    /*
+     *  Method: fireSlot
+     *  Parameters: int slot
+     *              Vector<string>& expired
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes every entry in a slot of the lowest level,
+     *  appending their values to expired in PQEntry order.
+     */
+    void fireSlot(int slot, Vector<string>& expired);
+
+    /*
+     *  Method: place
+     *  Parameters: int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Links the node at the given index into the slot
+     *  that covers its expiry relative to the current time,
+     *  or into the due list if that time has already passed.
+     */
+    void place(int index);
+
+    /*
+     *  Method: unlink
+     *  Parameters: int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Removes the node at the given index from its slot's list.
+     */
+    void unlink(int index);
+
+    /*
+     *  Method: releaseNode
+     *  Parameters: int index
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns a node that has been unlinked to the free list,
+     *  invalidating any handles that still refer to it.
+     */
+    void releaseNode(int index);
+
+    /*
+     *  Method: lowestOccupiedLevel
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the lowest level of the wheel holding any
+     *  entries, or kLevels if only the overflow list does.
+     */
+    int lowestOccupiedLevel() const;
+
+    /*
+     *  Integers: kSlotBits, kSlotsPerLevel, kSlotMask, kLevels
+     *  - - - - - - - - - - - - - -
+     *  Shape of the wheel: four levels of 256 slots, each
+     *  covering 256 times the span of the level below, for
+     *  a total reach of 2^32 milliseconds. Entries beyond
+     *  that wait in an overflow list.
+     */
+    static const int kSlotBits = 8;
+    static const int kSlotsPerLevel = 1 << kSlotBits;
+    static const int kSlotMask = kSlotsPerLevel - 1;
+    static const int kLevels = 4;
+
+    /*
+     *  Integer: kOverflowSlot
+     *  - - - - - - - - - - - - - -
+     *  Index of the overflow list among the slot heads.
+     */
+    static const int kOverflowSlot = kLevels * kSlotsPerLevel;
+
+    /*
+     *  Integer: kDueSlot
+     *  - - - - - - - - - - - - - -
+     *  Index of the list of entries scheduled at or before
+     *  the current time, which the next advance hands back
+     *  before it moves the wheel.
+     */
+    static const int kDueSlot = kOverflowSlot + 1;
+
+    /*
+     *  Integer: kNoNode
+     *  - - - - - - - - - - - - - -
+     *  Null link used by the node lists.
+     */
+    static const int kNoNode = -1;
+
+    /*
+     *  Function Pointer: clock
+     *  - - - - - - - - - - - - - -
+     *  Clock source used by advance and the constructor.
+     */
+    long (*clock)();
+
+    /*
+     *  Long: currentTick
+     *  - - - - - - - - - - - - - -
+     *  The next millisecond the wheel has yet to process.
+     */
+    long long currentTick;
+
+    /*
+     *  Vector: nodes
+     *  - - - - - - - -
+     *  Pool of timer nodes. Slots link nodes by index,
+     *  so the pool may grow without invalidating links.
+     */
+    Vector<TimerNode> nodes;
+
+    /*
+     *  Integer: freeList
+     *  - - - - - - - - - - - - - -
+     *  Index of the first unused node in the pool.
+     */
+    int freeList;
+
+    /*
+     *  Array: slotHeads
+     *  - - - - - - - - - - - - - -
+     *  Index of the first node in each slot of each
+     *  level, followed by the heads of the overflow list
+     *  and of the due list.
+     */
+    int slotHeads[kDueSlot + 1];
+
+    /*
+     *  Array: levelCounts
+     *  - - - - - - - - - - - - - -
+     *  Number of entries in each level, with the
+     *  overflow list counted as level kLevels. Entries
+     *  on the due list are counted only in count.
+     */
+    int levelCounts[kLevels + 1];
+
+    /*
+     *  Integer: count
+     *  - - - - - - - - - - - - - -
+     *  Number of entries currently scheduled.
+     */
+    int count;
+};
+
+#endif
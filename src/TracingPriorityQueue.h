@@ -0,0 +1,179 @@
+/*
+ *  File: TracingPriorityQueue.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the TracingPriorityQueue, which
+ *  wraps any of the priority queues and records every
+ *  call in a trace file that the benchmark can replay.
+ */
+
+#ifndef _tracingpriorityqueue_h
+#define _tracingpriorityqueue_h
+
+#include <string>
+#include <utility>    // for move
+#include "OperationTrace.h"
+using namespace std;
+
+/*
+ *  Class: TracingPriorityQueue
+ *  - - - - - - - - - - - - - - -
+ *  This class forwards each public method to a queue of
+ *  type PQueue and appends a record of the call, with the
+ *  time since the previous call, to an OperationTraceWriter.
+ *  Calls that signal an error are not recorded, so every
+ *  trace replays without errors.
+ *
+ *  Running a program with its queue wrapped for a while
+ *  captures its real traffic; pqueue-bench --replay then
+ *  drives any engine with the same calls, either as fast
+ *  as it can or at the pace they were recorded.
+ */
+template <typename PQueue>
+class TracingPriorityQueue {
+public:
+    /*
+     *  Constructor: TracingPriorityQueue
+     *  Parameters: string tracePath
+     *  - - - - - - - - - - - - - - - - - -
+     *  Starts an empty queue recording to the given file.
+     */
+    TracingPriorityQueue(string tracePath);
+
+    /*
+     *  Methods: clear, dequeue, enqueue, isEmpty,
+     *           peek, peekPriority, size
+     *  - - - - - - - - - - - - - - - - - -
+     *  Forward to the queue and record the call. An rvalue
+     *  value is moved into the queue once tracing has stopped;
+     *  until then it is needed for the record.
+     */
+    void clear();
+    string dequeue();
+    void enqueue(const string& value, int priority);
+    void enqueue(string&& value, int priority);
+    bool isEmpty() const;
+    string peek() const;
+    int peekPriority() const;
+    int size() const;
+
+    /*
+     *  Methods: tryDequeue, tryPeek, tryPeekPriority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Forward to the queue's try* methods. A call that succeeds
+     *  is recorded as the dequeue, peek or peekPriority it stands
+     *  for; one that finds the queue empty is recorded as an
+     *  isEmpty call, so the trace still replays without errors.
+     */
+    bool tryDequeue(string& value);
+    const string* tryPeek() const;
+    bool tryPeekPriority(int& priority) const;
+
+    /*
+     *  Method: closeTrace
+     *  - - - - - - - - - - - - - - - - - -
+     *  Finishes the trace so it can be replayed while the
+     *  queue is still in use. Calls made afterwards are not
+     *  recorded. The destructor closes the trace otherwise.
+     */
+    void closeTrace();
+
+private:
+    TracingPriorityQueue(const TracingPriorityQueue& other);
+    TracingPriorityQueue& operator =(const TracingPriorityQueue& other);
+
+    PQueue queue;
+    mutable OperationTraceWriter trace;
+    bool tracing;
+};
+
+/* Implementation section */
+
+template <typename PQueue>
+TracingPriorityQueue<PQueue>::TracingPriorityQueue(string tracePath) : trace(tracePath) {
+    tracing = true;
+}
+
+template <typename PQueue>
+void TracingPriorityQueue<PQueue>::clear() {
+    queue.clear();
+    if(tracing) trace.append(TRACE_CLEAR);
+}
+
+template <typename PQueue>
+string TracingPriorityQueue<PQueue>::dequeue() {
+    string value = queue.dequeue();
+    if(tracing) trace.append(TRACE_DEQUEUE, value);
+    return value;
+}
+
+template <typename PQueue>
+void TracingPriorityQueue<PQueue>::enqueue(const string& value, int priority) {
+    queue.enqueue(value, priority);
+    if(tracing) trace.append(TRACE_ENQUEUE, value, priority);
+}
+
+template <typename PQueue>
+void TracingPriorityQueue<PQueue>::enqueue(string&& value, int priority) {
+    if(!tracing) {
+        queue.enqueue(std::move(value), priority);
+        return;
+    }
+    enqueue(static_cast<const string&>(value), priority);
+}
+
+template <typename PQueue>
+bool TracingPriorityQueue<PQueue>::isEmpty() const {
+    bool empty = queue.isEmpty();
+    if(tracing) trace.append(TRACE_IS_EMPTY);
+    return empty;
+}
+
+template <typename PQueue>
+string TracingPriorityQueue<PQueue>::peek() const {
+    string value = queue.peek();
+    if(tracing) trace.append(TRACE_PEEK, value);
+    return value;
+}
+
+template <typename PQueue>
+int TracingPriorityQueue<PQueue>::peekPriority() const {
+    int priority = queue.peekPriority();
+    if(tracing) trace.append(TRACE_PEEK_PRIORITY, "", priority);
+    return priority;
+}
+
+template <typename PQueue>
+int TracingPriorityQueue<PQueue>::size() const {
+    int count = queue.size();
+    if(tracing) trace.append(TRACE_SIZE);
+    return count;
+}
+
+template <typename PQueue>
+bool TracingPriorityQueue<PQueue>::tryDequeue(string& value) {
+    bool found = queue.tryDequeue(value);
+    if(tracing) trace.append(found ? TRACE_DEQUEUE : TRACE_IS_EMPTY, found ? value : "");
+    return found;
+}
+
+template <typename PQueue>
+const string* TracingPriorityQueue<PQueue>::tryPeek() const {
+    const string *value = queue.tryPeek();
+    if(tracing) trace.append(value != NULL ? TRACE_PEEK : TRACE_IS_EMPTY, value != NULL ? *value : "");
+    return value;
+}
+
+template <typename PQueue>
+bool TracingPriorityQueue<PQueue>::tryPeekPriority(int& priority) const {
+    bool found = queue.tryPeekPriority(priority);
+    if(tracing) trace.append(found ? TRACE_PEEK_PRIORITY : TRACE_IS_EMPTY, "", found ? priority : 0);
+    return found;
+}
+
+template <typename PQueue>
+void TracingPriorityQueue<PQueue>::closeTrace() {
+    if(tracing) trace.close();
+    tracing = false;
+}
+
+#endif
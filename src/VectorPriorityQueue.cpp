@@ -7,9 +7,12 @@
  */
 
 #include "VectorPriorityQueue.h"
+#include <utility>    // for move
 
-VectorPriorityQueue::VectorPriorityQueue() {
-
+VectorPriorityQueue::VectorPriorityQueue(MemoryResource *resource)
+    : unsortedVector(ResourceAllocator<PQEntry>(resource)) {
+    policy = getTieBreakPolicy();
+    enqueueCount = 0;
 }
 
 VectorPriorityQueue::~VectorPriorityQueue() {
@@ -21,59 +24,94 @@ void VectorPriorityQueue::clear() {
 }
 
 string VectorPriorityQueue::dequeue() {
-    if(unsortedVector.size() == 0) error("The queue is empty");
-    int urgPriorityIndex = returnUrgentPriorityIndex();
-    string value = unsortedVector[urgPriorityIndex].value;
-    unsortedVector.remove(urgPriorityIndex);
+    string value;
+    if(!tryDequeue(value)) error("The queue is empty");
     return value;
 }
 
-void VectorPriorityQueue::enqueue(string value, int priority) {
-    PQEntry e = {value, priority};
-    unsortedVector.add(e);
+void VectorPriorityQueue::enqueue(const string& value, int priority) {
+    enqueue(string(value), priority);
+}
+
+void VectorPriorityQueue::enqueue(string&& value, int priority) {
+    unsortedVector.push_back(PQEntry(std::move(value), priority, policy, enqueueCount++));
 }
 
 bool VectorPriorityQueue::isEmpty() const {
-    return unsortedVector.isEmpty();
+    return unsortedVector.empty();
 }
 
-string VectorPriorityQueue::peek() const {
-    if(unsortedVector.size() == 0) error("The queue is empty ");
-    int urgPriorityIndex = returnUrgentPriorityIndex();
-    string value = unsortedVector[urgPriorityIndex].value;
-    return value;
+void VectorPriorityQueue::loadSnapshot(string path) {
+    PQSnapshotReader reader(path, SNAPSHOT_UNSORTED_VECTOR);
+    enqueueCount = reader.nextSequence();
+    unsortedVector.clear();
+    for(int i = 0; i < reader.size(); i++) {
+        unsortedVector.push_back(PQEntry(reader.value(i), reader.priority(i), policy, reader.sequence(i)));
+    }
+}
+
+const string& VectorPriorityQueue::peek() const {
+    const string *value = tryPeek();
+    if(value == NULL) error("The queue is empty ");
+    return *value;
 }
 
 
 int VectorPriorityQueue::peekPriority() const {
-    if(unsortedVector.size() == 0) error("The queue is empty ");
-    int urgPriorityIndex = returnUrgentPriorityIndex();
-    int urgPriority = unsortedVector[urgPriorityIndex].priority;
+    int urgPriority = 0;
+    if(!tryPeekPriority(urgPriority)) error("The queue is empty ");
     return urgPriority;
 }
 
+void VectorPriorityQueue::saveSnapshot(string path) const {
+    PQSnapshotWriter writer(SNAPSHOT_UNSORTED_VECTOR);
+    for(int i = 0; i < (int) unsortedVector.size(); i++) {
+        writer.add(unsortedVector[i].value, unsortedVector[i].priority, unsortedVector[i].sequence);
+    }
+    writer.save(path);
+}
+
 int VectorPriorityQueue::size() const {
     return unsortedVector.size();
 }
 
+bool VectorPriorityQueue::tryDequeue(string& value) {
+    if(unsortedVector.empty()) return false;
+    int urgPriorityIndex = returnUrgentPriorityIndex();
+    value = std::move(unsortedVector[urgPriorityIndex].value);
+    /*
+     *  The vector is unordered, so the last entry can fill
+     *  the hole instead of shifting everything after it.
+     */
+    if(urgPriorityIndex != (int) unsortedVector.size() - 1) {
+        unsortedVector[urgPriorityIndex] = std::move(unsortedVector.back());
+    }
+    unsortedVector.pop_back();
+    return true;
+}
+
+const string* VectorPriorityQueue::tryPeek() const {
+    if(unsortedVector.empty()) return NULL;
+    return &unsortedVector[returnUrgentPriorityIndex()].value;
+}
+
+bool VectorPriorityQueue::tryPeekPriority(int& priority) const {
+    if(unsortedVector.empty()) return false;
+    priority = unsortedVector[returnUrgentPriorityIndex()].priority;
+    return true;
+}
+
 int VectorPriorityQueue::returnUrgentPriorityIndex() const {
     int urgPriorityIndex = 0;
-    for(int i = 0; i < unsortedVector.size(); i++) {
-        if(i != urgPriorityIndex) {
-            int urgPriority = unsortedVector[urgPriorityIndex].priority;
-            int currPriority = unsortedVector[i].priority;
-            /*
-             *  Since each VectorPriorityQueue item is a PQEntry,
-             *  we can use the built-in operators for equality
-             *  to compare one PQEntry to another.
-             */
-            if(urgPriority > currPriority) {
-                urgPriorityIndex = i;
-            } else if(urgPriority == currPriority) {
-                string urgPriorityValue = unsortedVector[urgPriorityIndex].value;
-                string currPriorityValue = unsortedVector[i].value;
-                if(urgPriorityValue > currPriorityValue) urgPriorityIndex = i;
-            }
+    for(int i = 0; i < (int) unsortedVector.size(); i++) {
+        /*
+         *  Since each VectorPriorityQueue item is a PQEntry,
+         *  we can use the built-in operators for equality
+         *  to compare one PQEntry to another, which also
+         *  breaks ties by the current tie-break policy.
+         */
+        if(i != urgPriorityIndex && unsortedVector[i] < unsortedVector[urgPriorityIndex]) {
+            urgPriorityIndex = i;
         }
     }
     return urgPriorityIndex;
@@ -11,8 +11,11 @@
 
 #include <iostream>
 #include <string>
-#include "vector.h"
+#include <utility>    // for forward
+#include <vector>
+#include "MemoryResource.h"
 #include "PQEntry.h"
+#include "PQSnapshot.h"
 #include "error.h"
 using namespace std;
 
@@ -29,12 +32,14 @@ class VectorPriorityQueue {
 public:
     /*
      *  Constructor: VectorPriorityQueue
+     *  Parameters: MemoryResource *resource
      *  - - - - - - - - - - - - - - - - - -
      *  'Initializes' a new VectorPriorityQueue. Since
-     *  this class uses the Vector library, this doesn't
-     *  do much.
+     *  this class uses the standard vector, this doesn't
+     *  do much beyond pointing its allocator at the
+     *  given resource.
      */
-    VectorPriorityQueue();
+    explicit VectorPriorityQueue(MemoryResource *resource = defaultMemoryResource());
 
     /*
      *  Destructor: ~VectorPriorityQueue
@@ -47,7 +52,7 @@ public:
      *  Method: clear
      *  - - - - - - - - - - - - - - - - - -
      *  Removes all items from VectorPriorityQueue. Since
-     *  this class uses the Vector library, this simply
+     *  this class uses the standard vector, this simply
      *  leverages the clear() function from that class
      *  to carry out the same job.
      */
@@ -62,6 +67,8 @@ public:
      *  to loop through the associated values and find the one
      *  with the highest priority, returning its index to 
      *  to the calling function for use in the PriorityQueue.
+     *  The value is moved out, and the last item is moved
+     *  into its slot, so no string is copied.
      */
     string dequeue();
 
@@ -73,11 +80,24 @@ public:
      *  Adds a user-defined item to the PriorityQueue given
      *  the item's key and its corresponding priority level, which is
      *  used for retrieval. Since this queue does not respect
-     *  order upon enqueueing, this function simply uses the
-     *  Vector library's add function to store the value at 
-     *  the end of the queue.
+     *  order upon enqueueing, this function simply appends
+     *  the value at the end of the queue. A value passed as
+     *  an rvalue is moved in rather than copied.
      */
-    void enqueue(string value, int priority);
+    void enqueue(const string& value, int priority);
+    void enqueue(string&& value, int priority);
+
+    /*
+     *  Method: emplace
+     *  Parameters: int priority
+     *              Args&&... args
+     *  - - - - - - - - - - - - - - - - - -
+     *  Enqueues a value constructed from args at the given
+     *  priority without copying it. The priority comes first
+     *  so that the value's constructor arguments can trail it.
+     */
+    template <typename... Args>
+    void emplace(int priority, Args&&... args);
 
     /*
      *  Method: isEmpty
@@ -91,6 +111,17 @@ public:
      */
     bool isEmpty() const;
 
+    /*
+     *  Method: loadSnapshot
+     *  Parameters: string path
+     *  - - - - - - - - - - - - - - - - - -
+     *  Replaces the contents of the PriorityQueue with those
+     *  of a snapshot written by saveSnapshot. The file is mapped
+     *  into memory and its records are added to the Vector
+     *  in their saved order.
+     */
+    void loadSnapshot(string path);
+
     /*
      *  Method: peek
      *  - - - - - - - - - - - - - - - - - -
@@ -100,8 +131,9 @@ public:
      *  to loop through the associated values and find the one
      *  with the highest priority, returning its index to 
      *  to the calling function for use in the PriorityQueue.
+     *  The reference is good until the queue is next changed.
      */
-    string peek() const;
+    const string& peek() const;
 
     /*
      *  Method: peekPriority
@@ -115,16 +147,55 @@ public:
      */    
     int peekPriority() const;
 
+    /*
+     *  Method: saveSnapshot
+     *  Parameters: string path
+     *  - - - - - - - - - - - - - - - - - -
+     *  Writes the contents of the PriorityQueue to a binary
+     *  snapshot at the given path, one record per PQEntry
+     *  in Vector order.
+     */
+    void saveSnapshot(string path) const;
+
     /*
      *  Method: size
      *  - - - - - - - - - - - - - - - - - -
      *  Returns the size of the PriorityQueue.
-     *  Leveraging the Vector library means this
-     *  function can just call on the size function
-     *  in that library.
+     *  Leveraging the standard vector means this
+     *  function can just call on its size function.
      */ 
     int size() const;
 
+    /*
+     *  Method: tryDequeue
+     *  Parameters: string& value
+     *  - - - - - - - - - - - - - - - - - -
+     *  Moves the value of the highest priority item into value,
+     *  removes the item and returns true, or returns false if
+     *  the PriorityQueue is empty. It never throws, so a consumer
+     *  loop can drain the queue without calling isEmpty first.
+     */
+    bool tryDequeue(string& value);
+
+    /*
+     *  Method: tryPeek
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns a pointer to the value of the highest priority
+     *  item, or NULL if the PriorityQueue is empty, standing in
+     *  for the optional that C++11 lacks.
+     */
+    const string* tryPeek() const;
+
+    /*
+     *  Method: tryPeekPriority
+     *  Parameters: int& priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Stores the priority of the highest priority item in
+     *  priority and returns true, or returns false if the
+     *  PriorityQueue is empty.
+     */
+    bool tryPeekPriority(int& priority) const;
+
 private:
 
     /*
@@ -143,9 +214,33 @@ private:
      *  - - - - - - - - - - - - -
      *  The data type for the PriorityQueue that houses
      *  the specific struct uses for the queue's items.
-     *  A vector is used for fast enqueueing.
+     *  A vector is used for fast enqueueing, and the
+     *  standard one so that entries are moved, not
+     *  copied, when it grows, into arrays from the
+     *  queue's resource.
+     */
+    vector<PQEntry, ResourceAllocator<PQEntry> > unsortedVector;
+
+    /*
+     *  TieBreakPolicy: policy
+     *  - - - - - - - - - - - - -
+     *  The tie-break policy in effect when the queue
+     *  was constructed, stamped on each entry.
+     */
+    TieBreakPolicy policy;
+
+    /*
+     *  Integer: enqueueCount
+     *  - - - - - - - - - - - - -
+     *  The sequence the queue stamps on the next entry it
+     *  enqueues, so entries are numbered per queue.
      */
-    Vector<PQEntry> unsortedVector;
+    unsigned long long enqueueCount;
 };
 
+template <typename... Args>
+void VectorPriorityQueue::emplace(int priority, Args&&... args) {
+    enqueue(string(std::forward<Args>(args)...), priority);
+}
+
 #endif
@@ -0,0 +1,153 @@
+/*
+ *  File: WriteAheadLog.cpp
+ *  - - - - - - - - - - - - - - -
+ *  This file implements the WriteAheadLog and its reader.
+ */
+
+#include "WriteAheadLog.h"
+#include <cstring>
+#include <fcntl.h>
+#include "timer.h"
+#ifdef _WIN32
+#include <io.h>
+#define fsync _commit
+#define ftruncate _chsize_s
+#else
+#include <unistd.h>
+#endif
+
+/*
+ *  Size of the fixed part of a record: payload length and checksum,
+ *  followed in the payload by the op byte and the priority.
+ */
+static const int kRecordHeaderSize = 8;
+static const int kPayloadHeaderSize = 5;
+
+/*
+ *  Largest payload a reader will accept, so a corrupt
+ *  length field cannot trigger a huge allocation.
+ */
+static const uint32_t kMaxPayloadSize = 1 << 30;
+
+/*
+ *  FNV-1a hash of a record's payload, used to detect torn records.
+ */
+static uint32_t checksum(const char *data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for(size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char) data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+WriteAheadLog::WriteAheadLog(string path, int groupCommitSize, long syncIntervalMS) {
+    this->path = path;
+    commitSize = groupCommitSize;
+    this->syncIntervalMS = syncIntervalMS;
+#ifdef _WIN32
+    fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, 0644);
+#else
+    fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+    if(fd < 0) error("WriteAheadLog: cannot open " + path);
+    pendingRecords = 0;
+    records = 0;
+    lastCommitMS = Timer::currentTimeMS();
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    commit();
+    close(fd);
+}
+
+void WriteAheadLog::append(WriteAheadLogOp op, const string& value, int priority) {
+    uint32_t payloadLength = kPayloadHeaderSize + value.length();
+    size_t start = pending.length();
+    pending.resize(start + kRecordHeaderSize + payloadLength);
+    char *record = &pending[start];
+    char *payload = record + kRecordHeaderSize;
+    payload[0] = (char) op;
+    memcpy(payload + 1, &priority, sizeof(priority));
+    memcpy(payload + kPayloadHeaderSize, value.data(), value.length());
+    uint32_t sum = checksum(payload, payloadLength);
+    memcpy(record, &payloadLength, sizeof(payloadLength));
+    memcpy(record + 4, &sum, sizeof(sum));
+    pendingRecords++;
+    records++;
+    if(pendingRecords >= commitSize ||
+            Timer::currentTimeMS() - lastCommitMS >= syncIntervalMS) {
+        commit();
+    }
+}
+
+void WriteAheadLog::commit() {
+    if(pendingRecords > 0) {
+        const char *data = pending.data();
+        size_t remaining = pending.length();
+        while(remaining > 0) {
+            int written = write(fd, data, remaining);
+            if(written <= 0) error("WriteAheadLog: cannot write " + path);
+            data += written;
+            remaining -= written;
+        }
+        if(fsync(fd) != 0) error("WriteAheadLog: cannot sync " + path);
+        pending.clear();
+        pendingRecords = 0;
+    }
+    lastCommitMS = Timer::currentTimeMS();
+}
+
+void WriteAheadLog::truncate(long long length, int keptRecords) {
+    pending.clear();
+    pendingRecords = 0;
+    if(ftruncate(fd, length) != 0) error("WriteAheadLog: cannot truncate " + path);
+    if(fsync(fd) != 0) error("WriteAheadLog: cannot sync " + path);
+    records = keptRecords;
+}
+
+int WriteAheadLog::groupCommitSize() const {
+    return commitSize;
+}
+
+long WriteAheadLog::syncInterval() const {
+    return syncIntervalMS;
+}
+
+int WriteAheadLog::recordCount() const {
+    return records;
+}
+
+WriteAheadLogReader::WriteAheadLogReader(string path) {
+    input.open(path.c_str(), ios::binary);
+    offset = 0;
+    records = 0;
+}
+
+bool WriteAheadLogReader::next(WriteAheadLogOp& op, string& value, int& priority) {
+    if(!input.is_open()) return false;
+    uint32_t payloadLength;
+    uint32_t sum;
+    input.read((char *) &payloadLength, sizeof(payloadLength));
+    input.read((char *) &sum, sizeof(sum));
+    if(!input || payloadLength < (uint32_t) kPayloadHeaderSize || payloadLength > kMaxPayloadSize) {
+        return false;
+    }
+    string payload(payloadLength, '\0');
+    input.read(&payload[0], payloadLength);
+    if(!input || checksum(payload.data(), payloadLength) != sum) return false;
+    op = (WriteAheadLogOp) payload[0];
+    memcpy(&priority, payload.data() + 1, sizeof(priority));
+    value = payload.substr(kPayloadHeaderSize);
+    offset += kRecordHeaderSize + payloadLength;
+    records++;
+    return true;
+}
+
+long long WriteAheadLogReader::validLength() const {
+    return offset;
+}
+
+int WriteAheadLogReader::recordCount() const {
+    return records;
+}
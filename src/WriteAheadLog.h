@@ -0,0 +1,176 @@
+/*
+ *  File: WriteAheadLog.h
+ *  - - - - - - - - - - - - - - -
+ *  This file exports the WriteAheadLog, an append-only
+ *  file of queue operations that is flushed to disk
+ *  in groups, along with a reader used to replay it.
+ */
+
+#ifndef _writeaheadlog_h
+#define _writeaheadlog_h
+
+#include <fstream>
+#include <string>
+#include <stdint.h>
+#include "error.h"
+using namespace std;
+
+/*
+ *  Enum: WriteAheadLogOp
+ *  - - - - - - - - - - - - - - -
+ *  The kinds of operation a log record describes.
+ */
+enum WriteAheadLogOp {
+    WAL_ENQUEUE = 1,
+    WAL_DEQUEUE,
+    WAL_CLEAR
+};
+
+/*
+ *  Class: WriteAheadLog
+ *  - - - - - - - - - - - - - - -
+ *  This class appends operation records to a log file.
+ *  Records are gathered in memory and written and synced
+ *  together once enough of them are pending or enough
+ *  time has passed since the last sync, so the cost of
+ *  each fsync is shared by a whole group of operations.
+ *  The log has no timer of its own: the time is checked
+ *  only when a record is appended, so a group left
+ *  pending by a quiet caller stays unsynced until the
+ *  next append, commit, or destruction.
+ *  Each record carries its length and a checksum, so a
+ *  record torn by a crash is detected and ignored.
+ */
+class WriteAheadLog {
+public:
+    /*
+     *  Constructor: WriteAheadLog
+     *  Parameters: string path
+     *              int groupCommitSize
+     *              long syncIntervalMS
+     *  - - - - - - - - - - - - - - - - - -
+     *  Opens the log at the given path for appending, creating
+     *  it if needed. A group is committed once groupCommitSize
+     *  records are pending, or when a record is appended at
+     *  least syncIntervalMS after the last commit. The interval
+     *  is not enforced between appends.
+     */
+    WriteAheadLog(string path, int groupCommitSize, long syncIntervalMS);
+
+    /*
+     *  Destructor: ~WriteAheadLog
+     *  - - - - - - - - - - - - - - - - - -
+     *  Commits any pending records and closes the log.
+     */
+    ~WriteAheadLog();
+
+    /*
+     *  Method: append
+     *  Parameters: WriteAheadLogOp op
+     *              const string& value
+     *              int priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Adds a record to the pending group, committing the
+     *  group if it is now full or due.
+     */
+    void append(WriteAheadLogOp op, const string& value = "", int priority = 0);
+
+    /*
+     *  Method: commit
+     *  - - - - - - - - - - - - - - - - - -
+     *  Writes all pending records and syncs the log to disk.
+     */
+    void commit();
+
+    /*
+     *  Method: truncate
+     *  Parameters: long long length
+     *              int keptRecords
+     *  - - - - - - - - - - - - - - - - - -
+     *  Discards pending records and cuts the log back to the
+     *  given length, such as 0 after a checkpoint or the end
+     *  of the last intact record after recovery. The record
+     *  count restarts from keptRecords, the number of records
+     *  left in the log.
+     */
+    void truncate(long long length = 0, int keptRecords = 0);
+
+    /*
+     *  Methods: groupCommitSize, syncInterval
+     *  - - - - - - - - - - - - - - - - - -
+     *  Return the group commit settings given to the constructor.
+     */
+    int groupCommitSize() const;
+    long syncInterval() const;
+
+    /*
+     *  Method: recordCount
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the number of records in the log: those
+     *  kept by the last truncate plus those appended since.
+     */
+    int recordCount() const;
+
+private:
+    WriteAheadLog(const WriteAheadLog& other);
+    WriteAheadLog& operator =(const WriteAheadLog& other);
+
+    string path;
+    int fd;
+    string pending;
+    int pendingRecords;
+    int commitSize;
+    long syncIntervalMS;
+    long lastCommitMS;
+    int records;
+};
+
+/*
+ *  Class: WriteAheadLogReader
+ *  - - - - - - - - - - - - - - -
+ *  Reads back the records of a log in order, stopping at
+ *  the end of the file or at the first torn record.
+ */
+class WriteAheadLogReader {
+public:
+    /*
+     *  Constructor: WriteAheadLogReader
+     *  Parameters: string path
+     *  - - - - - - - - - - - - - - - - - -
+     *  Opens the log at the given path. A missing log is
+     *  treated as an empty one.
+     */
+    WriteAheadLogReader(string path);
+
+    /*
+     *  Method: next
+     *  Parameters: WriteAheadLogOp& op
+     *              string& value
+     *              int& priority
+     *  - - - - - - - - - - - - - - - - - -
+     *  Reads the next intact record into the given variables.
+     *  Returns false once there are no more intact records.
+     */
+    bool next(WriteAheadLogOp& op, string& value, int& priority);
+
+    /*
+     *  Method: validLength
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the offset just past the last intact record read.
+     */
+    long long validLength() const;
+
+    /*
+     *  Method: recordCount
+     *  - - - - - - - - - - - - - - - - - -
+     *  Returns the number of intact records read so far.
+     */
+    int recordCount() const;
+
+private:
+    ifstream input;
+    long long offset;
+    int records;
+};
+
+#endif
@@ -8,7 +8,23 @@
 #include "VectorPriorityQueue.h"
 #include "LinkedPriorityQueue.h"
 #include "HeapPriorityQueue.h"
+#include "IndirectHeapPriorityQueue.h"
 #include "BinomialHeapPriorityQueue.h"
+#include "SortedArrayPriorityQueue.h"
+#include "RadixHeapPriorityQueue.h"
+#include "AdaptivePriorityQueue.h"
+#include "MinMaxHeapPriorityQueue.h"
+#include "BoundedPriorityQueue.h"
+#include "GroupedPriorityQueue.h"
+#include "TimingWheelPriorityQueue.h"
+#include "ExternalPriorityQueue.h"
+#include "DurablePriorityQueue.h"
+#include "SharedMemoryPriorityQueue.h"
+#include "InstrumentedPriorityQueue.h"
+#include "TracingPriorityQueue.h"
+#include "SmallPriorityQueue.h"
+#include "IntrusivePriorityQueue.h"
+#include "MemoryResource.h"
 #include "random.h"
 #include "simpio.h"
 #include "vector.h"
@@ -18,8 +34,17 @@
 #include <iostream>
 #include <string>
 #include <sstream>    // For istringstream
+#include <fstream>    // For ofstream
+#include <cstdio>     // For remove
 #include <algorithm>  // For sort, reverse
 #include <functional> // For greater
+#include <utility>    // For move
+#include <set>        // For multiset
+#ifndef _WIN32
+#include <csignal>    // For kill, SIGKILL
+#include <sys/wait.h> // For waitpid
+#include <unistd.h>   // For fork, usleep, _exit
+#endif
 
 using namespace std;
 
@@ -992,24 +1017,1696 @@ template <typename PQueue>
     endTest("My Very Own Tests");
 }
 
+/* Function: snapshotTests
+ * ------------------------------------------------------------------
+ * Tests saveSnapshot() and loadSnapshot() on a priority queue type
+ * that supports them.
+ */
+template <typename PQueue>
+    void snapshotTests() {
+    beginTest("Snapshot Tests");
+
+    const string snapshotPath = "pqueue-test.snapshot";
+
+    try {
+        /* A restored queue should hand back exactly what the saved queue would. */
+        {
+            logInfo("Saving and restoring 1000 random strings after some dequeues.");
+            PQueue queue;
+            for (int i = 0; i < 1000; i++) {
+                string s = randomNumberString();
+                queue.enqueue(s, stringToInteger(s));
+                if (i % 7 == 0) queue.dequeue();
+            }
+            queue.saveSnapshot(snapshotPath);
+
+            PQueue restored;
+            restored.enqueue("Leftover", 1);
+            restored.loadSnapshot(snapshotPath);
+            checkCondition(restored.size() == queue.size(), "Restored queue should have the saved size.");
+
+            bool isCorrect = true;
+            while (!queue.isEmpty()) {
+                if (restored.peekPriority() != queue.peekPriority() ||
+                        restored.dequeue() != queue.dequeue()) {
+                    isCorrect = false;
+                    break;
+                }
+            }
+            checkCondition(isCorrect, "Restored queue should dequeue in the saved order.");
+            checkCondition(restored.isEmpty(), "Restored queue should not keep its old contents.");
+        }
+
+        /* Empty queues and values with unusual characters should survive a round trip. */
+        {
+            logInfo("Saving and restoring an empty queue and unusual values.");
+            PQueue queue;
+            queue.saveSnapshot(snapshotPath);
+            PQueue restored;
+            restored.loadSnapshot(snapshotPath);
+            checkCondition(restored.isEmpty(), "Restored empty queue should be empty.");
+
+            queue.enqueue(string("nul\0byte", 8), -5);
+            queue.enqueue("", 7);
+            queue.saveSnapshot(snapshotPath);
+            restored.loadSnapshot(snapshotPath);
+            checkCondition(restored.dequeue() == string("nul\0byte", 8), "Embedded NUL should survive.");
+            checkCondition(restored.dequeue() == "", "Empty value should survive.");
+        }
+
+        /* Under FIFO, equal priorities should keep their order through a restore. */
+        {
+            logInfo("Saving and restoring 200 random strings at 3 priorities, FIFO.");
+            setTieBreakPolicy(TIE_BREAK_FIFO);
+            PQueue queue;
+            PQueue restored;
+            setTieBreakPolicy(TIE_BREAK_LEXICOGRAPHIC);
+            Vector<Vector<string> > enqueued(3);
+            for (int i = 0; i < 200; i++) {
+                string s = randomNumberString();
+                int priority = randomInteger(0, 2);
+                enqueued[priority].add(s);
+                queue.enqueue(s, priority);
+                if (i % 5 == 0) {
+                    enqueued[queue.peekPriority()].remove(0);
+                    queue.dequeue();
+                }
+            }
+            queue.saveSnapshot(snapshotPath);
+            restored.loadSnapshot(snapshotPath);
+            restored.enqueue("0", 0);
+            enqueued[0].add("0");
+            bool isCorrect = true;
+            for (int priority = 0; priority < 3; priority++) {
+                for (int i = 0; i < enqueued[priority].size(); i++) {
+                    if (restored.peekPriority() != priority || restored.dequeue() != enqueued[priority][i]) {
+                        isCorrect = false;
+                    }
+                }
+            }
+            checkCondition(isCorrect, "Restored ties should dequeue in FIFO order, before later entries.");
+        }
+
+        /* Files that are not snapshots should be rejected. */
+        {
+            logInfo("Loading a file that is not a snapshot.");
+            ofstream garbage(snapshotPath.c_str());
+            garbage << "not a snapshot" << endl;
+            garbage.close();
+
+            PQueue queue;
+            bool rejected = false;
+            try {
+                queue.loadSnapshot(snapshotPath);
+            } catch (ErrorException&) {
+                rejected = true;
+            }
+            checkCondition(rejected, "Loading a garbage file should report an error.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+    remove(snapshotPath.c_str());
+
+    endTest("Snapshot Tests");
+}
+
+/* Function: durableTests
+ * ------------------------------------------------------------------
+ * Tests that a DurablePriorityQueue wrapped around the given queue
+ * type recovers its contents when it is reopened.
+ */
+template <typename PQueue>
+    void durableTests() {
+    beginTest("Durable Tests");
+
+    const string basePath = "pqueue-test-durable";
+
+    try {
+        /* Reopening the queue should recover it from its checkpoints and log. */
+        {
+            logInfo("Enqueuing 1000 random strings with a checkpoint every 64 records.");
+            PQueue expected;
+            {
+                DurablePriorityQueue<PQueue> queue(basePath, 16, 1000, 64);
+                queue.clear();
+                for (int i = 0; i < 1000; i++) {
+                    string s = randomNumberString();
+                    queue.enqueue(s, stringToInteger(s));
+                    expected.enqueue(s, stringToInteger(s));
+                    if (i % 5 == 0) {
+                        queue.dequeue();
+                        expected.dequeue();
+                    }
+                }
+            }
+
+            logInfo("Reopening the queue.");
+            DurablePriorityQueue<PQueue> reopened(basePath, 16, 1000, 64);
+            checkCondition(reopened.size() == expected.size(), "Reopened queue should have its old size.");
+            bool isCorrect = true;
+            while (!expected.isEmpty()) {
+                if (reopened.dequeue() != expected.dequeue()) {
+                    isCorrect = false;
+                    break;
+                }
+            }
+            checkCondition(isCorrect, "Reopened queue should dequeue its old contents in order.");
+        }
+
+        /* A record torn by a crash should be ignored and overwritten. */
+        {
+            logInfo("Reopening a queue whose log ends in a torn record.");
+            {
+                DurablePriorityQueue<PQueue> queue(basePath, 1, 1000, 1 << 20);
+                queue.clear();
+                queue.enqueue("B", 2);
+                queue.enqueue("A", 1);
+            }
+            ifstream manifest((basePath + ".manifest").c_str());
+            int generation = 0;
+            manifest >> generation;
+            ofstream log((basePath + ".wal." + integerToString(generation)).c_str(), ios::app | ios::binary);
+            log << "torn";
+            log.close();
+
+            {
+                DurablePriorityQueue<PQueue> queue(basePath, 1, 1000, 1 << 20);
+                checkCondition(queue.size() == 2, "Torn record should be ignored.");
+                queue.enqueue("C", 3);
+            }
+            DurablePriorityQueue<PQueue> queue(basePath, 1, 1000, 1 << 20);
+            checkCondition(queue.size() == 3, "Records after a torn record should be recovered.");
+            checkCondition(queue.dequeue() == "A" && queue.dequeue() == "B" && queue.dequeue() == "C",
+                           "Recovered queue should dequeue in order.");
+            queue.checkpoint();
+        }
+
+        /* Records replayed on reopening should count toward the next checkpoint. */
+        {
+            logInfo("Reopening a queue after every 40 records with a checkpoint every 64.");
+            int firstGeneration = 0;
+            {
+                DurablePriorityQueue<PQueue> queue(basePath, 16, 1000, 64);
+                queue.checkpoint();
+                ifstream manifest((basePath + ".manifest").c_str());
+                manifest >> firstGeneration;
+            }
+            for (int session = 0; session < 2; session++) {
+                DurablePriorityQueue<PQueue> queue(basePath, 16, 1000, 64);
+                for (int i = 0; i < 40; i++) {
+                    queue.enqueue(integerToString(i), i);
+                }
+            }
+            ifstream manifest((basePath + ".manifest").c_str());
+            int generation = 0;
+            manifest >> generation;
+            checkCondition(generation > firstGeneration, "A checkpoint should be taken across reopens.");
+            DurablePriorityQueue<PQueue> queue(basePath, 16, 1000, 64);
+            checkCondition(queue.size() == 80, "Reopened queue should keep all 80 entries.");
+        }
+
+        /* Replay should remove the entries that were dequeued, not just as many. */
+        {
+            logInfo("Reopening a FIFO queue of equal priorities after a checkpoint.");
+            setTieBreakPolicy(TIE_BREAK_FIFO);
+            {
+                DurablePriorityQueue<PQueue> queue(basePath, 1, 1000, 1 << 20);
+                queue.clear();
+                for (int i = 0; i < 20; i++) {
+                    queue.enqueue(integerToString(19 - i), 1);
+                }
+                queue.dequeue();
+                queue.checkpoint();
+                for (int i = 0; i < 5; i++) {
+                    queue.dequeue();
+                }
+            }
+            DurablePriorityQueue<PQueue> queue(basePath, 1, 1000, 1 << 20);
+            bool isCorrect = queue.size() == 14;
+            for (int i = 6; i < 20; i++) {
+                if (queue.isEmpty() || queue.dequeue() != integerToString(19 - i)) isCorrect = false;
+            }
+            checkCondition(isCorrect, "Recovered FIFO queue should keep its remaining ties in order.");
+            queue.checkpoint();
+        }
+
+        {
+            logInfo("Reopening a queue of equal priorities with no tie-breaking.");
+            setTieBreakPolicy(TIE_BREAK_NONE);
+            multiset<string> expected;
+            {
+                DurablePriorityQueue<PQueue> queue(basePath, 1, 1000, 1 << 20);
+                queue.clear();
+                for (int i = 0; i < 20; i++) {
+                    queue.enqueue(integerToString(i), i % 2);
+                    expected.insert(integerToString(i));
+                }
+                queue.checkpoint();
+                for (int i = 0; i < 7; i++) {
+                    expected.erase(expected.find(queue.dequeue()));
+                }
+            }
+            DurablePriorityQueue<PQueue> queue(basePath, 1, 1000, 1 << 20);
+            multiset<string> recovered;
+            while (!queue.isEmpty()) {
+                recovered.insert(queue.dequeue());
+            }
+            checkCondition(recovered == expected, "Recovered queue should hold exactly the entries not dequeued.");
+            queue.checkpoint();
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+    setTieBreakPolicy(TIE_BREAK_LEXICOGRAPHIC);
+
+    ifstream manifest((basePath + ".manifest").c_str());
+    int generation = 0;
+    manifest >> generation;
+    manifest.close();
+    remove((basePath + ".manifest").c_str());
+    remove((basePath + ".checkpoint." + integerToString(generation)).c_str());
+    remove((basePath + ".wal." + integerToString(generation)).c_str());
+
+    endTest("Durable Tests");
+}
+
+/* Function: traceTests
+ * ------------------------------------------------------------------
+ * Tests that a TracingPriorityQueue wrapped around the given queue
+ * type records every call, and that the trace reads back intact.
+ */
+template <typename PQueue>
+    void traceTests() {
+    beginTest("Trace Tests");
+
+    const string tracePath = "pqueue-test.trace";
+
+    try {
+        /* Each call should be recorded with what it was given or returned. */
+        {
+            logInfo("Tracing 1000 random strings with some dequeues and peeks.");
+            Vector<string> dequeued;
+            int calls = 0;
+            int peak = 0;
+            {
+                TracingPriorityQueue<PQueue> queue(tracePath);
+                for (int i = 0; i < 1000; i++) {
+                    string s = randomNumberString();
+                    queue.enqueue(s, stringToInteger(s));
+                    calls++;
+                    peak = max(peak, i + 1 - dequeued.size());
+                    if (i % 3 == 0) {
+                        queue.peekPriority();
+                        dequeued.add(queue.dequeue());
+                        calls += 2;
+                    }
+                }
+                queue.size();
+                queue.peek();
+                queue.clear();
+                queue.isEmpty();
+                calls += 4;
+            }
+
+            OperationTraceReader trace(tracePath);
+            checkCondition(trace.operationCount() == calls, "Trace should hold every call.");
+            checkCondition(trace.record(0).op == TRACE_ENQUEUE, "First call should be an enqueue.");
+            checkCondition(trace.record(trace.size() - 1).op == TRACE_IS_EMPTY,
+                           "Last call should be isEmpty.");
+
+            bool isCorrect = true;
+            int next = 0;
+            for (long long i = 0; i < trace.size(); i++) {
+                const TraceRecord& record = trace.record(i);
+                if (record.op == TRACE_ENQUEUE &&
+                        stringToInteger(trace.value(record.valueId)) != record.priority) {
+                    isCorrect = false;
+                }
+                if (record.op == TRACE_DEQUEUE && trace.value(record.valueId) != dequeued[next++]) {
+                    isCorrect = false;
+                }
+            }
+            checkCondition(isCorrect, "Recorded values and priorities should match the calls.");
+            checkCondition(trace.peakSize() == peak, "Peak size should be tracked.");
+        }
+
+        /* The try* calls should be recorded as the calls they stand for. */
+        {
+            logInfo("Tracing try* calls on an empty and a non-empty queue.");
+            {
+                TracingPriorityQueue<PQueue> queue(tracePath);
+                string value;
+                int priority;
+                queue.tryDequeue(value);
+                queue.enqueue(string("a"), 1);
+                queue.tryPeek();
+                queue.tryPeekPriority(priority);
+                queue.tryDequeue(value);
+            }
+            OperationTraceReader trace(tracePath);
+            TraceOp expected[] = {TRACE_IS_EMPTY, TRACE_ENQUEUE, TRACE_PEEK, TRACE_PEEK_PRIORITY, TRACE_DEQUEUE};
+            bool isCorrect = trace.size() == 5;
+            for (int i = 0; isCorrect && i < 5; i++) {
+                if (trace.record(i).op != expected[i]) isCorrect = false;
+            }
+            checkCondition(isCorrect, "Try calls should be traced as isEmpty, peek, peekPriority and dequeue.");
+            checkCondition(trace.value(trace.record(4).valueId) == "a", "The dequeued value should be recorded.");
+        }
+
+        /* Files that are not complete traces should be rejected. */
+        {
+            logInfo("Reading a file that is not a trace.");
+            ofstream garbage(tracePath.c_str());
+            garbage << "not a trace" << endl;
+            garbage.close();
+
+            bool rejected = false;
+            try {
+                OperationTraceReader trace(tracePath);
+            } catch (ErrorException&) {
+                rejected = true;
+            }
+            checkCondition(rejected, "Reading a garbage file should report an error.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+    remove(tracePath.c_str());
+
+    endTest("Trace Tests");
+}
+
+/* Function: drainsInOrder
+ * ------------------------------------------------------------------
+ * Dequeues everything from a queue and reports whether it came out
+ * in priority order.
+ */
+template <typename PQueue>
+    bool drainsInOrder(PQueue& queue) {
+    int last = 0;
+    bool first = true;
+    while (!queue.isEmpty()) {
+        int priority = queue.peekPriority();
+        queue.dequeue();
+        if (!first && priority < last) return false;
+        first = false;
+        last = priority;
+    }
+    return true;
+}
+
+/* Function: smallBufferTests
+ * ------------------------------------------------------------------
+ * Tests that a SmallPriorityQueue wrapped around the given queue
+ * type keeps small queues inline, spills once it is full, and keeps
+ * its entries in order across the change.
+ */
+template <typename PQueue>
+    void smallBufferTests() {
+    beginTest("Small Buffer Tests");
+
+    try {
+        /* Up to 16 entries should stay inline and dequeue in order. */
+        {
+            logInfo("Enqueueing 16 random strings.");
+            SmallPriorityQueue<PQueue> queue;
+#ifdef PQUEUE_COUNT_OPERATIONS
+            clearOperationCounters();
+#endif
+            Vector<int> priorities;
+            for (int i = 0; i < 16; i++) {
+                int priority = randomInteger(-100, 100);
+                priorities.add(priority);
+                queue.enqueue(integerToString(priority), priority);
+            }
+            checkCondition(!queue.isSpilled(), "16 entries should stay inline.");
+            checkCondition(queue.size() == 16, "Size should be 16.");
+            sort(priorities.begin(), priorities.end());
+            bool isCorrect = true;
+            for (int i = 0; i < priorities.size(); i++) {
+                if (queue.peekPriority() != priorities[i] ||
+                        queue.dequeue() != integerToString(priorities[i])) {
+                    isCorrect = false;
+                }
+            }
+            checkCondition(isCorrect, "Inline entries should dequeue in order.");
+            checkCondition(queue.isEmpty(), "Queue should be empty.");
+#ifdef PQUEUE_COUNT_OPERATIONS
+            checkCondition(operationCounters.allocations == 0, "A small queue should not allocate.");
+#endif
+        }
+
+        /* The 17th entry should spill, and emptying should return to inline. */
+        {
+            logInfo("Enqueueing 1000 random strings, then draining.");
+            SmallPriorityQueue<PQueue> queue;
+            for (int i = 0; i < 1000; i++) {
+                int priority = randomInteger(-1000, 1000);
+                queue.enqueue(integerToString(priority), priority);
+                if (i == 15) checkCondition(!queue.isSpilled(), "16 entries should stay inline.");
+                if (i == 16) checkCondition(queue.isSpilled(), "17 entries should spill.");
+            }
+            checkCondition(queue.size() == 1000, "Size should be 1000.");
+            checkCondition(drainsInOrder(queue), "Spilled entries should dequeue in order.");
+            checkCondition(!queue.isSpilled(), "An emptied queue should be inline again.");
+
+            queue.enqueue("b", 2);
+            queue.enqueue("a", 1);
+            checkCondition(!queue.isSpilled() && queue.peek() == "a", "Reused queue should be inline.");
+            for (int i = 0; i < 20; i++) {
+                queue.enqueue("c", 3);
+            }
+            queue.clear();
+            checkCondition(queue.isEmpty() && !queue.isSpilled(), "Clear should empty both modes.");
+        }
+
+        /* An engine built at the spill should break ties as the queue does. */
+        {
+            logInfo("Constructing a FIFO queue, then spilling 20 equal priorities under lexicographic.");
+            setTieBreakPolicy(TIE_BREAK_FIFO);
+            SmallPriorityQueue<PQueue> queue;
+            setTieBreakPolicy(TIE_BREAK_LEXICOGRAPHIC);
+            for (int i = 0; i < 20; i++) {
+                queue.enqueue(integerToString(19 - i), 1);
+            }
+            bool isCorrect = queue.isSpilled();
+            for (int i = 0; i < 20; i++) {
+                if (queue.dequeue() != integerToString(19 - i)) isCorrect = false;
+            }
+            checkCondition(isCorrect, "Spilled ties should still dequeue in FIFO order.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+
+    endTest("Small Buffer Tests");
+}
+
+/* Function: tieBreakTests
+ * ------------------------------------------------------------------
+ * Tests that the given queue type orders equal priorities by the
+ * current tie-break policy: by value, in FIFO order, or not at all.
+ */
+template <typename PQueue>
+    void tieBreakTests() {
+    beginTest("Tie Break Tests");
+
+    try {
+        /* Under FIFO, equal priorities should dequeue in the order enqueued. */
+        {
+            logInfo("Enqueueing 1000 random strings at 5 priorities, FIFO.");
+            setTieBreakPolicy(TIE_BREAK_FIFO);
+            PQueue queue;
+            Vector<Vector<string> > enqueued(5);
+            for (int i = 0; i < 1000; i++) {
+                string s = randomNumberString();
+                int priority = randomInteger(0, 4);
+                enqueued[priority].add(s);
+                queue.enqueue(s, priority);
+            }
+            bool isCorrect = true;
+            for (int priority = 0; priority < 5; priority++) {
+                for (int i = 0; i < enqueued[priority].size(); i++) {
+                    if (queue.peekPriority() != priority || queue.dequeue() != enqueued[priority][i]) {
+                        isCorrect = false;
+                    }
+                }
+            }
+            checkCondition(isCorrect, "Equal priorities should dequeue in FIFO order.");
+        }
+
+        /* A queue should keep the policy it was constructed with. */
+        {
+            logInfo("Constructing a FIFO queue, then enqueueing b, c and a under lexicographic.");
+            setTieBreakPolicy(TIE_BREAK_FIFO);
+            PQueue queue;
+            setTieBreakPolicy(TIE_BREAK_LEXICOGRAPHIC);
+            queue.enqueue("b", 1);
+            queue.enqueue("c", 1);
+            queue.enqueue("a", 1);
+            checkCondition(queue.dequeue() == "b" && queue.dequeue() == "c" && queue.dequeue() == "a",
+                           "The queue should stay FIFO.");
+        }
+
+        /* With no tie-break, priorities should still come out in order. */
+        {
+            logInfo("Enqueueing 1000 random strings at 5 priorities, no tie-break.");
+            setTieBreakPolicy(TIE_BREAK_NONE);
+            PQueue queue;
+            Vector<string> enqueued;
+            for (int i = 0; i < 1000; i++) {
+                string s = randomNumberString();
+                enqueued.add(s);
+                queue.enqueue(s, randomInteger(0, 4));
+            }
+            Vector<string> dequeued;
+            bool isCorrect = true;
+            int last = queue.peekPriority();
+            while (!queue.isEmpty()) {
+                if (queue.peekPriority() < last) isCorrect = false;
+                last = queue.peekPriority();
+                dequeued.add(queue.dequeue());
+            }
+            sort(enqueued.begin(), enqueued.end());
+            sort(dequeued.begin(), dequeued.end());
+            checkCondition(isCorrect, "Priorities should dequeue in order.");
+            checkCondition(enqueued == dequeued, "Every value should dequeue once.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+    setTieBreakPolicy(TIE_BREAK_LEXICOGRAPHIC);
+
+    endTest("Tie Break Tests");
+}
+
+/* Function: moveTests
+ * ------------------------------------------------------------------
+ * Tests that the given queue type moves values in and out instead
+ * of copying them. A long string keeps its character buffer when it
+ * is moved, so it should come back out with the same one.
+ */
+template <typename PQueue>
+    void moveTests() {
+    beginTest("Move Tests");
+
+    try {
+        /* A moved value should make the round trip without a copy. */
+        {
+            logInfo("Moving a 4096-character string through 100 others.");
+            PQueue queue;
+            for (int i = 0; i < 100; i++) {
+                queue.enqueue(randomString(), randomInteger(1, 100));
+            }
+#ifdef PQUEUE_COUNT_OPERATIONS
+            clearOperationCounters();
+#endif
+            string large(4096, 'x');
+            const char *characters = large.data();
+            queue.enqueue(std::move(large), 0);
+            checkCondition(queue.peek().data() == characters, "Peek should refer to the queued value.");
+            string dequeued = queue.dequeue();
+            checkCondition(dequeued.data() == characters, "The value should be moved in and out.");
+#ifdef PQUEUE_COUNT_OPERATIONS
+            checkCondition(operationCounters.copies == 0, "No entry should be copied.");
+#endif
+            checkCondition(drainsInOrder(queue), "The other values should still dequeue in order.");
+        }
+
+        /* Emplaced values should be built from their arguments. */
+        {
+            logInfo("Emplacing three values.");
+            PQueue queue;
+            queue.emplace(2, 3, 'b');
+            queue.emplace(1, "aaa");
+            string value = "cccc";
+            queue.emplace(3, value, 1, 2);
+            checkCondition(queue.dequeue() == "aaa", "First value should be aaa.");
+            checkCondition(queue.dequeue() == "bbb", "Second value should be bbb.");
+            checkCondition(queue.dequeue() == "cc" && value == "cccc",
+                           "Third value should be a substring, leaving its source.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+
+    endTest("Move Tests");
+}
+
+/* Function: tryTests
+ * ------------------------------------------------------------------
+ * Tests that the try* methods of the given queue type report an
+ * empty queue without throwing, and otherwise agree with dequeue,
+ * peek and peekPriority.
+ */
+template <typename PQueue>
+    void tryTests() {
+    beginTest("Try Tests");
+
+    try {
+        /* An empty queue should report failure and leave the outputs alone. */
+        {
+            logInfo("Trying an empty queue.");
+            PQueue queue;
+            string value = "untouched";
+            int priority = 137;
+            checkCondition(!queue.tryDequeue(value) && value == "untouched",
+                           "tryDequeue should fail on an empty queue.");
+            checkCondition(queue.tryPeek() == NULL, "tryPeek should return NULL on an empty queue.");
+            checkCondition(!queue.tryPeekPriority(priority) && priority == 137,
+                           "tryPeekPriority should fail on an empty queue.");
+        }
+
+        /* A loop on tryDequeue alone should drain the queue in order. */
+        {
+            logInfo("Draining 1000 random strings with tryDequeue.");
+            PQueue queue;
+            Vector<int> priorities;
+            for (int i = 0; i < 1000; i++) {
+                int priority = randomInteger(-1000, 1000);
+                priorities.add(priority);
+                queue.enqueue(integerToString(priority), priority);
+            }
+            sort(priorities.begin(), priorities.end());
+            bool isCorrect = true;
+            int count = 0;
+            int priority;
+            string value;
+            while (queue.tryPeekPriority(priority)) {
+                const string *peeked = queue.tryPeek();
+                if (peeked == NULL || *peeked != queue.peek()) isCorrect = false;
+                if (!queue.tryDequeue(value) || count >= priorities.size() ||
+                        priority != priorities[count] || value != integerToString(priority)) {
+                    isCorrect = false;
+                }
+                count++;
+            }
+            checkCondition(isCorrect, "Values should come out in order.");
+            checkCondition(count == 1000 && queue.isEmpty(), "Every value should come out once.");
+            checkCondition(!queue.tryDequeue(value), "tryDequeue should fail once drained.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+
+    endTest("Try Tests");
+}
+
+/* Class: CountingMemoryResource
+ * ------------------------------------------------------------------
+ * A resource that passes every request on to the default one while
+ * counting the allocations and the bytes not yet given back.
+ */
+class CountingMemoryResource : public MemoryResource {
+public:
+    CountingMemoryResource() : allocations(0), outstandingBytes(0) {}
+
+    void *allocate(size_t bytes, size_t alignment) {
+        allocations++;
+        outstandingBytes += bytes;
+        return defaultMemoryResource()->allocate(bytes, alignment);
+    }
+
+    void deallocate(void *block, size_t bytes, size_t alignment) {
+        outstandingBytes -= bytes;
+        defaultMemoryResource()->deallocate(block, bytes, alignment);
+    }
+
+    int allocations;
+    long outstandingBytes;
+};
+
+/* Function: churn
+ * ------------------------------------------------------------------
+ * Dequeues half of a queue of 2 * half entries and enqueues as many
+ * again, with the same priorities every time it is called.
+ */
+template <typename PQueue>
+    void churn(PQueue& queue, int half) {
+    for (int i = 0; i < half; i++) {
+        queue.dequeue();
+    }
+    for (int i = 0; i < half; i++) {
+        queue.enqueue("churned", (i * 37) % 101);
+    }
+}
+
+/* Function: memoryResourceTests
+ * ------------------------------------------------------------------
+ * Tests that the given queue type takes all of its own memory from
+ * the resource it is constructed with and gives it all back, and
+ * that it runs over the monotonic and pool resources.
+ */
+template <typename PQueue>
+    void memoryResourceTests() {
+    beginTest("Memory Resource Tests");
+
+    try {
+        /* Everything taken from the resource should be given back. */
+        {
+            logInfo("Running 1000 random strings through a counted resource.");
+            CountingMemoryResource counting;
+            {
+                PQueue queue(&counting);
+                for (int i = 0; i < 1000; i++) {
+                    queue.enqueue(randomString(), randomInteger(-1000, 1000));
+                }
+                checkCondition(counting.allocations > 0, "The queue should allocate from its resource.");
+                checkCondition(drainsInOrder(queue), "Values should come out in order.");
+                for (int i = 0; i < 100; i++) {
+                    queue.enqueue(randomString(), randomInteger(-1000, 1000));
+                }
+            }
+            checkCondition(counting.outstandingBytes == 0, "The queue should give back all it took.");
+        }
+
+        /* An arena should take a few growing chunks and free them at once. */
+        {
+            logInfo("Running 2000 operations over a monotonic buffer.");
+            CountingMemoryResource upstream;
+            MonotonicBufferResource arena(1024, &upstream);
+            {
+                PQueue queue(&arena);
+                for (int i = 0; i < 1000; i++) {
+                    queue.enqueue(randomString(), randomInteger(-1000, 1000));
+                }
+                churn(queue, 500);
+                checkCondition(drainsInOrder(queue), "Values should come out in order.");
+            }
+            checkCondition(upstream.allocations < 32, "The arena should grow in a few chunks.");
+            arena.release();
+            checkCondition(upstream.outstandingBytes == 0, "Release should return every chunk.");
+        }
+
+        /* A warmed-up pool should serve steady churn from its free lists. */
+        {
+            logInfo("Churning 500 entries over a pool.");
+            CountingMemoryResource upstream;
+            PoolResource pool(&upstream);
+            {
+                PQueue queue(&pool);
+                for (int i = 0; i < 1000; i++) {
+                    queue.enqueue("loaded", (i * 37) % 101);
+                }
+                churn(queue, 500);
+                churn(queue, 500);
+                int warmAllocations = upstream.allocations;
+                for (int round = 0; round < 10; round++) {
+                    churn(queue, 500);
+                }
+                checkCondition(upstream.allocations == warmAllocations,
+                               "Steady churn should not reach upstream.");
+                checkCondition(queue.size() == 1000, "Churn should keep the size.");
+                checkCondition(drainsInOrder(queue), "Values should come out in order.");
+            }
+            pool.release();
+            checkCondition(upstream.outstandingBytes == 0, "Release should return every chunk.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+
+    endTest("Memory Resource Tests");
+}
+
+/* Function: zeroClock
+ * ------------------------------------------------------------------
+ * A fake clock source that lets the timing wheel tests start the
+ * wheel at time zero and move it forward by hand.
+ */
+long zeroClock() {
+    return 0;
+}
+
+/* Function: timingWheelTests
+ * ------------------------------------------------------------------
+ * Tests the TimingWheelPriorityQueue, which has its own interface of
+ * schedule/cancel/advanceTo rather than enqueue/dequeue.
+ */
+void timingWheelTests() {
+    beginTest("Timing Wheel Tests");
+
+    try {
+        /* Entries should come back in expiry order, and only once their time has come. */
+        {
+            logInfo("Scheduling entries in every level of the wheel.");
+            TimingWheelPriorityQueue wheel(zeroClock);
+            wheel.schedule("D", 5000000000L);
+            wheel.schedule("C", 70000);
+            wheel.schedule("B", 300);
+            wheel.schedule("A", 3);
+            checkCondition(wheel.size() == 4, "Wheel should hold four entries.");
+
+            Vector<string> expired = wheel.advanceTo(2);
+            checkCondition(expired.isEmpty(), "Nothing should expire before its time.");
+            expired = wheel.advanceTo(300);
+            checkCondition(expired.size() == 2 && expired[0] == "A" && expired[1] == "B",
+                           "Entries in the lower levels should expire in order.");
+            expired = wheel.advanceTo(69999);
+            checkCondition(expired.isEmpty(), "Cascaded entries should not expire early.");
+            expired = wheel.advanceTo(5000000000L);
+            checkCondition(expired.size() == 2 && expired[0] == "C" && expired[1] == "D",
+                           "Entries in the upper levels and overflow should expire in order.");
+            checkCondition(wheel.isEmpty(), "Wheel should be empty after all entries expire.");
+        }
+
+        /* Cancelled entries should never expire, and stale handles should be rejected. */
+        {
+            logInfo("Cancelling entries before they expire.");
+            TimingWheelPriorityQueue wheel(zeroClock);
+            TimingWheelPriorityQueue::TimerId first = wheel.schedule("first", 10);
+            wheel.schedule("second", 10);
+            checkCondition(wheel.cancel(first), "Cancelling a scheduled entry should succeed.");
+            checkCondition(!wheel.cancel(first), "Cancelling the same entry twice should fail.");
+            wheel.schedule("third", 10);
+            Vector<string> expired = wheel.advanceTo(10);
+            checkCondition(expired.size() == 2 && expired[0] == "second" && expired[1] == "third",
+                           "Only uncancelled entries should expire.");
+        }
+
+        /* Equal expiries should be ordered by value, and past expiries should fire at once. */
+        {
+            logInfo("Sorting 1000 random expiries.");
+            TimingWheelPriorityQueue wheel(zeroClock);
+            Vector<string> randomValues;
+            for (int i = 0; i < 1000; i++) {
+                randomValues += randomNumberString(6);
+                wheel.schedule(randomValues[i], stringToInteger(randomValues[i]));
+            }
+            sort(randomValues.begin(), randomValues.end());
+            Vector<string> expired = wheel.advanceTo(999999);
+            checkCondition(expired == randomValues, "Wheel correctly sorted 1000 random expiries.");
+
+            wheel.schedule("late", 5);
+            expired = wheel.advanceTo(1000000);
+            checkCondition(expired.size() == 1 && expired[0] == "late",
+                           "Entries scheduled in the past should expire on the next advance.");
+        }
+
+        /* Entries due at or before the current time should fire without moving the clock. */
+        {
+            logInfo("Scheduling entries at and before the current time.");
+            TimingWheelPriorityQueue wheel(zeroClock);
+            wheel.advanceTo(100);
+            wheel.schedule("now", wheel.currentTime());
+            wheel.schedule("late", 50);
+            wheel.schedule("next", 101);
+            Vector<string> expired = wheel.advanceTo(100);
+            checkCondition(expired.size() == 2 && expired[0] == "late" && expired[1] == "now",
+                           "Past-due entries should expire on an advance to the same time.");
+            checkCondition(wheel.size() == 1 && wheel.currentTime() == 100, "The clock should not move.");
+            TimingWheelPriorityQueue::TimerId id = wheel.schedule("cancelled", 10);
+            checkCondition(wheel.cancel(id), "A past-due entry should be cancellable.");
+            expired = wheel.advanceTo(101);
+            checkCondition(expired.size() == 1 && expired[0] == "next", "Only the later entry should expire.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+
+    endTest("Timing Wheel Tests");
+}
+
+/* Function: adaptiveTests
+ * ------------------------------------------------------------------
+ * Tests the RadixHeapPriorityQueue, which only takes monotone
+ * priorities, and that the AdaptivePriorityQueue changes engine as
+ * its workload changes without losing or misordering entries.
+ */
+void adaptiveTests() {
+    beginTest("Adaptive Tests");
+
+    try {
+        /* The radix heap should sort monotone priorities and reject the rest. */
+        {
+            logInfo("Running a hold workload through the radix heap.");
+            RadixHeapPriorityQueue queue;
+            for (int i = 0; i < 1000; i++) {
+                queue.enqueue(integerToString(i), randomInteger(-1000, 1000));
+            }
+            bool isCorrect = true;
+            int last = queue.peekPriority();
+            for (int i = 0; i < 10000; i++) {
+                int priority = queue.peekPriority();
+                if (priority < last) isCorrect = false;
+                last = priority;
+                queue.enqueue(queue.dequeue(), priority + randomInteger(0, 100000));
+            }
+            checkCondition(isCorrect, "Radix heap should dequeue in order.");
+            checkCondition(drainsInOrder(queue), "Radix heap should drain in order.");
+
+            queue.enqueue("B", 5);
+            queue.enqueue("A", 5);
+            queue.enqueue("C", 9);
+            checkCondition(queue.dequeue() == "A", "Equal priorities should break ties by value.");
+            checkCondition(queue.accepts(5) && !queue.accepts(4), "Only monotone priorities should be accepted.");
+            bool rejected = false;
+            try {
+                queue.enqueue("D", 4);
+            } catch (ErrorException&) {
+                rejected = true;
+            }
+            checkCondition(rejected, "Enqueueing behind the front should report an error.");
+        }
+
+        AdaptiveThresholds thresholds;
+        thresholds.smallSize = 16;
+        thresholds.drainingSize = 256;
+        thresholds.externalSize = 4000;
+        thresholds.sampleInterval = 64;
+        thresholds.stableSamples = 1;
+
+        /* The engine should follow the queue from small to large and back. */
+        {
+            logInfo("Growing an adaptive queue with random priorities.");
+            AdaptivePriorityQueue queue(thresholds);
+            for (int i = 0; i < 10; i++) {
+                queue.enqueue(randomString(), randomInteger(0, 100));
+            }
+            checkCondition(queue.engine() == ENGINE_SORTED_ARRAY, "Small queue should use the sorted array.");
+            for (int i = 0; i < 1000; i++) {
+                queue.enqueue(randomString(), randomInteger(0, 100000));
+                if (i % 4 == 0) queue.dequeue();
+            }
+            checkCondition(queue.engine() == ENGINE_HEAP, "Large random queue should use the heap.");
+
+            logInfo("Running a hold workload on it.");
+            for (int i = 0; i < 1000; i++) {
+                int priority = queue.peekPriority();
+                queue.enqueue(queue.dequeue(), priority + randomInteger(0, 1000));
+            }
+            checkCondition(queue.engine() == ENGINE_RADIX_HEAP, "Monotone queue should use the radix heap.");
+            queue.enqueue("Urgent", -1);
+            checkCondition(queue.engine() == ENGINE_HEAP, "Out-of-order enqueue should leave the radix heap.");
+            checkCondition(queue.peek() == "Urgent", "Out-of-order entry should be at the front.");
+
+            logInfo("Draining it.");
+            int migrations = queue.migrations();
+            int last = queue.peekPriority();
+            bool isCorrect = true;
+            while (queue.size() > 100) {
+                int priority = queue.peekPriority();
+                if (priority < last) isCorrect = false;
+                last = priority;
+                queue.dequeue();
+            }
+            checkCondition(queue.engine() == ENGINE_SORTED_ARRAY, "Draining queue should use the sorted array.");
+            checkCondition(queue.migrations() > migrations, "Draining should have migrated the queue.");
+            checkCondition(isCorrect && drainsInOrder(queue), "Queue should dequeue in order across migrations.");
+        }
+
+        /* A backlog should spill to external memory and come back intact. */
+        {
+            logInfo("Building a backlog of 5000 entries.");
+            AdaptivePriorityQueue queue(thresholds);
+            for (int i = 0; i < 5000; i++) {
+                queue.enqueue(randomString(), randomInteger(0, 100000));
+            }
+            checkCondition(queue.engine() == ENGINE_EXTERNAL, "Backlog should spill to external memory.");
+            checkCondition(queue.size() == 5000, "Backlog should keep every entry.");
+            checkCondition(drainsInOrder(queue), "Backlog should dequeue in order.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+
+    endTest("Adaptive Tests");
+}
+
 /* Function: testPriorityQueue
  * ------------------------------------------------------------------
- * A function that runs the full battery of tests on a priority
- * queue of arbitrary type.
+ * A function that runs the full battery of tests on a priority
+ * queue of arbitrary type.
+ */
+template <typename PQueue>
+    void testPriorityQueue() {
+
+    basicStructuralTests<PQueue> ();
+    sortAscendingTests<PQueue> ();
+    sortDescendingTests<PQueue> ();
+    sortRandomTests<PQueue> ();
+    sortCraftedTests<PQueue> ();
+    sortDuplicateTests<PQueue> ();
+    reuseTests<PQueue> ();
+
+    /* If you want to run your own custom tests, uncomment this line. */
+    // myVeryOwnTests<PQueue> ();
+}
+
+/* Function: minMaxHeapTests
+ * ------------------------------------------------------------------
+ * Tests that the MinMaxHeapPriorityQueue dequeues from both ends in
+ * order, including when the two ends are mixed.
+ */
+void minMaxHeapTests() {
+    beginTest("Min-Max Heap Tests");
+
+    try {
+        /* The least urgent entries should come off the bottom in reverse order. */
+        {
+            logInfo("Enqueueing 1000 random strings and dequeueing the maximum.");
+            MinMaxHeapPriorityQueue queue;
+            for (int i = 0; i < 1000; i++) {
+                int priority = randomInteger(-1000, 1000);
+                queue.enqueue(integerToString(priority), priority);
+            }
+            bool isCorrect = true;
+            int last = queue.peekMaxPriority();
+            while (!queue.isEmpty()) {
+                int priority = queue.peekMaxPriority();
+                if (priority > last || queue.dequeueMax() != integerToString(priority)) {
+                    isCorrect = false;
+                }
+                last = priority;
+            }
+            checkCondition(isCorrect, "Maxima should dequeue in reverse order.");
+        }
+
+        /* Shedding from the bottom should leave the most urgent entries. */
+        {
+            logInfo("Keeping the 100 most urgent of 10000 random strings.");
+            MinMaxHeapPriorityQueue queue;
+            Vector<int> priorities;
+            for (int i = 0; i < 10000; i++) {
+                int priority = randomInteger(-100000, 100000);
+                priorities.add(priority);
+                queue.enqueue(integerToString(priority), priority);
+                if (queue.size() > 100) queue.dequeueMax();
+            }
+            sort(priorities.begin(), priorities.end());
+            checkCondition(queue.size() == 100, "Queue should hold 100 entries.");
+            checkCondition(queue.peekMaxPriority() == priorities[99], "Maximum should be the 100th smallest.");
+            bool isCorrect = true;
+            for (int i = 0; i < 100; i++) {
+                if (queue.peekPriority() != priorities[i]) isCorrect = false;
+                queue.dequeueMin();
+            }
+            checkCondition(isCorrect, "Minima should dequeue in order.");
+        }
+
+        /* Ties should be broken by value at both ends. */
+        {
+            logInfo("Enqueueing a, b and c at one priority.");
+            MinMaxHeapPriorityQueue queue;
+            queue.enqueue("b", 5);
+            queue.enqueue("c", 5);
+            queue.enqueue("a", 5);
+            checkCondition(queue.peekMin() == "a", "Minimum should be a.");
+            checkCondition(queue.peekMax() == "c", "Maximum should be c.");
+            checkCondition(queue.dequeueMax() == "c" && queue.dequeueMax() == "b" &&
+                           queue.dequeueMax() == "a", "Maxima should be c, b, a.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+
+    endTest("Min-Max Heap Tests");
+}
+
+/* Function: boundedTests
+ * ------------------------------------------------------------------
+ * Tests that a BoundedPriorityQueue keeps the most urgent entries of
+ * a stream once it is full, or the first ones when it rejects.
  */
-template <typename PQueue>
-    void testPriorityQueue() {
+void boundedTests() {
+    beginTest("Bounded Tests");
 
-    basicStructuralTests<PQueue> ();
-    sortAscendingTests<PQueue> ();
-    sortDescendingTests<PQueue> ();
-    sortRandomTests<PQueue> ();
-    sortCraftedTests<PQueue> ();
-    sortDuplicateTests<PQueue> ();
-    reuseTests<PQueue> ();
+    try {
+        /* An evicting queue should end up with the top K of the stream. */
+        {
+            logInfo("Keeping the 100 most urgent of 100000 random strings.");
+            BoundedPriorityQueue queue(100);
+            Vector<int> priorities;
+            for (int i = 0; i < 100000; i++) {
+                int priority = randomInteger(-1000000, 1000000);
+                priorities.add(priority);
+                queue.enqueue(integerToString(priority), priority);
+            }
+            sort(priorities.begin(), priorities.end());
+            checkCondition(queue.isFull() && queue.size() == 100, "Queue should hold 100 entries.");
+            checkCondition(queue.evictions() == 100000 - 100, "Every enqueue past 100 should overflow.");
+            checkCondition(queue.peekLastPriority() == priorities[99], "Last should be the 100th smallest.");
+            Vector<PQEntry> top = queue.extractSorted();
+            bool isCorrect = top.size() == 100;
+            for (int i = 0; i < top.size(); i++) {
+                if (top[i].priority != priorities[i] || top[i].value != integerToString(priorities[i])) {
+                    isCorrect = false;
+                }
+            }
+            checkCondition(isCorrect, "Sorted extraction should be the top 100 in order.");
+            checkCondition(queue.isEmpty(), "Extraction should empty the queue.");
+        }
 
-    /* If you want to run your own custom tests, uncomment this line. */
-    // myVeryOwnTests<PQueue> ();
+        /* Ties with the last entry should be broken by value. */
+        {
+            logInfo("Offering entries that tie with the least urgent one.");
+            BoundedPriorityQueue queue(2);
+            queue.enqueue("b", 1);
+            queue.enqueue("d", 1);
+            checkCondition(!queue.enqueue("e", 1), "e should not displace d.");
+            checkCondition(queue.enqueue("c", 1), "c should displace d.");
+            checkCondition(queue.peekLast() == "c" && queue.peek() == "b", "Queue should hold b and c.");
+        }
+
+        /* Under FIFO, ties with the last entry should keep the earlier one. */
+        {
+            logInfo("Offering tying entries to FIFO queues of 1 and 2.");
+            setTieBreakPolicy(TIE_BREAK_FIFO);
+            BoundedPriorityQueue single(1);
+            BoundedPriorityQueue pair(2);
+            setTieBreakPolicy(TIE_BREAK_LEXICOGRAPHIC);
+            single.enqueue("b", 1);
+            checkCondition(!single.enqueue("a", 1) && single.peek() == "b", "a should not displace b.");
+            pair.enqueue("z", 1);
+            pair.enqueue("y", 1);
+            checkCondition(!pair.enqueue("a", 1), "a should not displace y.");
+            checkCondition(pair.dequeue() == "z" && pair.dequeue() == "y", "Queue should hold z and y in order.");
+        }
+
+        /* A rejecting queue should keep what it was given first. */
+        {
+            logInfo("Offering 10 entries to a rejecting queue of 5.");
+            BoundedPriorityQueue queue(5, BOUNDED_REJECT);
+            bool isCorrect = true;
+            for (int i = 10; i > 0; i--) {
+                if (queue.enqueue(integerToString(i), i) != (i > 5)) isCorrect = false;
+            }
+            checkCondition(isCorrect, "Only the first 5 enqueues should be kept.");
+            checkCondition(queue.peekPriority() == 6 && queue.peekLastPriority() == 10,
+                           "Queue should hold 6 through 10.");
+            queue.dequeue();
+            checkCondition(queue.enqueue("1", 1) && queue.peek() == "1", "A dequeue should make room.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+
+    endTest("Bounded Tests");
+}
+
+/* Function: unrolledLinkedTests
+ * ------------------------------------------------------------------
+ * Tests that LinkedPriorityQueue reuses dequeued nodes in both of its
+ * modes, and that the unrolled list keeps its order as blocks split,
+ * fill from the end and empty from the front.
+ */
+void unrolledLinkedTests() {
+    beginTest("Unrolled Linked Tests");
+
+    try {
+        /* Steady churn should be served from the free list. */
+        LinkedListMode modes[] = {LINKED_NODE_PER_ENTRY, LINKED_UNROLLED};
+        for (LinkedListMode mode : modes) {
+            logInfo(mode == LINKED_UNROLLED ? "Churning 500 entries over unrolled blocks."
+                                            : "Churning 500 entries over list nodes.");
+            CountingMemoryResource counting;
+            {
+                LinkedPriorityQueue queue(mode, &counting);
+                for (int i = 0; i < 1000; i++) {
+                    queue.enqueue("loaded", (i * 37) % 101);
+                }
+                churn(queue, 500);
+                churn(queue, 500);
+                int warmAllocations = counting.allocations;
+                for (int round = 0; round < 10; round++) {
+                    churn(queue, 500);
+                }
+                /*
+                 *  Split blocks are never merged again, so an unrolled
+                 *  list slowly settles into a few more, emptier blocks.
+                 */
+                int allowed = (mode == LINKED_UNROLLED) ? 50 : 0;
+                checkCondition(counting.allocations - warmAllocations <= allowed,
+                               "Steady churn should allocate at most once per 100 enqueues.");
+                checkCondition(queue.size() == 1000, "Churn should keep the size.");
+            }
+            checkCondition(counting.outstandingBytes == 0, "Freed nodes should be given back.");
+        }
+
+        /* Runs in either direction should come out in order. */
+        {
+            logInfo("Enqueueing 100 ascending, then 100 descending priorities.");
+            UnrolledLinkedPriorityQueue queue;
+            for (int i = 0; i < 100; i++) {
+                queue.enqueue(integerToString(i), i);
+            }
+            for (int i = 0; i < 100; i++) {
+                queue.enqueue(integerToString(99 - i), 99 - i);
+            }
+            checkCondition(queue.size() == 200, "Queue should have 200 elements.");
+            bool isCorrect = true;
+            for (int i = 0; i < 200; i++) {
+                if (queue.peekPriority() != i / 2 || queue.dequeue() != integerToString(i / 2)) {
+                    isCorrect = false;
+                }
+            }
+            checkCondition(isCorrect, "Both runs should interleave in order.");
+        }
+
+        /* Mixed operations should agree with a sorted reference. */
+        {
+            logInfo("Running 20000 random operations over few priorities.");
+            UnrolledLinkedPriorityQueue queue;
+            multiset<int> reference;
+            bool isCorrect = true;
+            for (int i = 0; i < 20000; i++) {
+                if (reference.empty() || randomChance(0.55)) {
+                    int priority = randomInteger(0, 50);
+                    queue.enqueue(integerToString(priority), priority);
+                    reference.insert(priority);
+                } else {
+                    int priority = *reference.begin();
+                    reference.erase(reference.begin());
+                    if (queue.peekPriority() != priority || queue.dequeue() != integerToString(priority)) {
+                        isCorrect = false;
+                    }
+                }
+            }
+            checkCondition(isCorrect, "Dequeues should match the reference.");
+            checkCondition(queue.size() == (int) reference.size(), "Sizes should match the reference.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+
+    endTest("Unrolled Linked Tests");
+}
+
+/* Function: indirectHeapTests
+ * ------------------------------------------------------------------
+ * Tests that the handles an IndirectHeapPriorityQueue returns can
+ * remove entries and change their priorities, and that freed slots
+ * are reused.
+ */
+void indirectHeapTests() {
+    beginTest("Indirect Heap Tests");
+
+    try {
+        /* Removing and reprioritizing through handles should keep the order. */
+        {
+            logInfo("Removing and reprioritizing 1000 random strings by handle.");
+            IndirectHeapPriorityQueue queue;
+            Vector<IndirectHeapPriorityQueue::Handle> handles;
+            for (int i = 0; i < 1000; i++) {
+                int priority = randomInteger(-1000, 1000);
+                handles.add(queue.enqueue(integerToString(priority), priority));
+            }
+            bool isCorrect = true;
+            for (int i = 0; i < handles.size(); i++) {
+                if (i % 3 == 0) {
+                    int priority = queue.priorityOf(handles[i]);
+                    if (queue.remove(handles[i]) != integerToString(priority)) isCorrect = false;
+                } else if (i % 3 == 1) {
+                    queue.changePriority(handles[i], queue.priorityOf(handles[i]) - randomInteger(0, 2000));
+                }
+            }
+            checkCondition(isCorrect, "Removal should return the entry's value.");
+            checkCondition(queue.size() == 666, "Removed entries should leave the queue.");
+            checkCondition(!queue.contains(handles[0]) && queue.contains(handles[1]),
+                           "Only queued handles should be contained.");
+            checkCondition(drainsInOrder(queue), "Entries should drain in priority order.");
+        }
+
+        /* The most urgent entry should be reachable by handle. */
+        {
+            logInfo("Enqueueing a, b and c and decreasing c.");
+            IndirectHeapPriorityQueue queue;
+            queue.enqueue("a", 1);
+            queue.enqueue("b", 2);
+            IndirectHeapPriorityQueue::Handle c = queue.enqueue("c", 3);
+            queue.changePriority(c, 0);
+            checkCondition(queue.peekHandle() == c && queue.valueOf(c) == "c", "c should be first.");
+            checkCondition(queue.dequeue() == "c", "c should dequeue first.");
+            IndirectHeapPriorityQueue::Handle d = queue.enqueue("d", 5);
+            checkCondition(d == c, "The freed slot should be reused.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+
+    endTest("Indirect Heap Tests");
+}
+
+/* Function: binomialHeapTests
+ * ------------------------------------------------------------------
+ * Tests that a BinomialHeapPriorityQueue keeps each tree in the slot
+ * of its order as roots are dequeued, so that size() stays right
+ * through a drain and a clear.
+ */
+void binomialHeapTests() {
+    beginTest("Binomial Heap Tests");
+
+    try {
+        /* Dequeuing a low-order root should not shift the trees above it. */
+        {
+            logInfo("Enqueueing 0 through 99 and checking size() after each dequeue.");
+            BinomialHeapPriorityQueue queue;
+            for (int i = 0; i < 100; i++) {
+                queue.enqueue(integerToString(i), i);
+            }
+            bool isCorrect = true;
+            for (int i = 0; i < 100; i++) {
+                if (queue.dequeue() != integerToString(i)) isCorrect = false;
+                if (queue.size() != 99 - i) isCorrect = false;
+            }
+            checkCondition(isCorrect, "Size should drop by one with each dequeue.");
+            checkCondition(queue.isEmpty(), "The drained queue should be empty.");
+        }
+
+        /* Interleaving should keep the count exact. */
+        {
+            logInfo("Interleaving 1000 random enqueues with dequeues.");
+            BinomialHeapPriorityQueue queue;
+            int expected = 0;
+            bool isCorrect = true;
+            for (int i = 0; i < 1000; i++) {
+                queue.enqueue(integerToString(i), randomInteger(-100, 100));
+                expected++;
+                if (i % 3 == 2) {
+                    queue.dequeue();
+                    queue.dequeue();
+                    expected -= 2;
+                }
+                if (queue.size() != expected) isCorrect = false;
+            }
+            checkCondition(isCorrect, "Size should match the entries enqueued less those dequeued.");
+            checkCondition(drainsInOrder(queue), "Entries should drain in priority order.");
+        }
+
+        /* Clearing frees the trees and leaves a usable queue. */
+        {
+            logInfo("Clearing 50 entries and enqueueing a, b and c.");
+            BinomialHeapPriorityQueue queue;
+            for (int i = 0; i < 50; i++) {
+                queue.enqueue(integerToString(i), i);
+            }
+            queue.clear();
+            queue.enqueue("c", 3);
+            queue.enqueue("a", 1);
+            queue.enqueue("b", 2);
+            checkCondition(queue.size() == 3, "Only the new entries should remain.");
+            checkCondition(queue.dequeue() == "a", "a should dequeue first.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+
+    endTest("Binomial Heap Tests");
+}
+
+/* Function: externalTests
+ * ------------------------------------------------------------------
+ * Tests that an ExternalPriorityQueue with a tiny memory budget keeps
+ * few runs on disk by merging them level by level, and that equal
+ * priorities keep their FIFO order through the runs.
+ */
+void externalTests() {
+    beginTest("External Tests");
+
+    try {
+        /* A thousand spills should leave only a few runs per level. */
+        {
+            logInfo("Enqueueing 2000 random strings with a budget of 4 entries.");
+            ExternalPriorityQueue queue(4);
+            int mostRuns = 0;
+            for (int i = 0; i < 2000; i++) {
+                int priority = randomInteger(-1000, 1000);
+                queue.enqueue(integerToString(priority), priority);
+                if (queue.runCount() > mostRuns) mostRuns = queue.runCount();
+            }
+            checkCondition(mostRuns < 32, "Level merging should keep the run count small.");
+            checkCondition(queue.size() == 2000, "Size should be 2000.");
+            checkCondition(drainsInOrder(queue), "Entries should drain in priority order.");
+        }
+
+        /* Ties spilled to disk should come back in FIFO order. */
+        {
+            logInfo("Enqueueing 500 strings at 3 priorities with a budget of 8 entries, FIFO.");
+            setTieBreakPolicy(TIE_BREAK_FIFO);
+            ExternalPriorityQueue queue(8);
+            setTieBreakPolicy(TIE_BREAK_LEXICOGRAPHIC);
+            Vector<Vector<string> > enqueued(3);
+            for (int i = 0; i < 500; i++) {
+                int priority = randomInteger(0, 2);
+                enqueued[priority].add(integerToString(499 - i));
+                queue.enqueue(integerToString(499 - i), priority);
+            }
+            bool isCorrect = queue.runCount() > 0;
+            for (int priority = 0; priority < 3; priority++) {
+                for (int i = 0; i < enqueued[priority].size(); i++) {
+                    if (queue.peekPriority() != priority || queue.dequeue() != enqueued[priority][i]) {
+                        isCorrect = false;
+                    }
+                }
+            }
+            checkCondition(isCorrect, "Spilled ties should dequeue in FIFO order.");
+            checkCondition(queue.isEmpty() && queue.runCount() == 0, "Drained queue should have no runs.");
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+    setTieBreakPolicy(TIE_BREAK_LEXICOGRAPHIC);
+
+    endTest("External Tests");
+}
+
+/* Function: sharedMemoryTests
+ * ------------------------------------------------------------------
+ * Tests that a SharedMemoryPriorityQueue stays usable when a process
+ * is killed part way through an operation: the next process to lock
+ * the segment should get the lock and find the heap repaired.
+ */
+void sharedMemoryTests() {
+    beginTest("Shared Memory Tests");
+
+#ifndef _WIN32
+    const string name = "/pqueue-crash-test";
+    SharedMemoryPriorityQueue::unlink(name);
+    try {
+        logInfo("Killing 20 children while they enqueue and dequeue.");
+        SharedMemoryPriorityQueue queue(name, 1000);
+        for (int i = 0; i < 100; i++) {
+            queue.enqueue(integerToString(i), randomInteger(-1000, 1000));
+        }
+        bool isCorrect = true;
+        for (int round = 0; round < 20 && isCorrect; round++) {
+            pid_t child = fork();
+            if (child == 0) {
+                /* The child shares the parent's mapping and never returns. */
+                try {
+                    for (int i = 0; ; i++) {
+                        queue.enqueue(integerToString(i), randomInteger(-1000, 1000));
+                        queue.dequeue();
+                    }
+                } catch (...) {
+                    _exit(1);
+                }
+            }
+            if (child < 0) error("fork failed");
+            usleep(2000 + 500 * round);
+            kill(child, SIGKILL);
+            waitpid(child, NULL, 0);
+
+            /* Both calls lock the segment; a dead owner must not block them. */
+            int size = queue.size();
+            int count = 0;
+            int last = 0;
+            while (!queue.isEmpty()) {
+                int priority = queue.peekPriority();
+                queue.dequeue();
+                if (count > 0 && priority < last) isCorrect = false;
+                last = priority;
+                count++;
+            }
+            if (count != size || size < 99 || size > 101) isCorrect = false;
+            for (int i = 0; i < 100; i++) {
+                queue.enqueue(integerToString(i), randomInteger(-1000, 1000));
+            }
+        }
+        checkCondition(isCorrect, "Queue should lock and drain in order after each child is killed.");
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+    SharedMemoryPriorityQueue::unlink(name);
+#endif
+
+    endTest("Shared Memory Tests");
+}
+
+/* Struct: IntrusiveJob
+ * ------------------------------------------------------------------
+ * A job that carries its own hook, for the intrusive queue tests.
+ * Ties on the deadline go to the lower id.
+ */
+struct IntrusiveJob : IntrusiveHeapHook {
+    int deadline;
+    int id;
+
+    bool operator <(const IntrusiveJob& other) const {
+        if (deadline != other.deadline) return deadline < other.deadline;
+        return id < other.id;
+    }
+};
+
+/* Function: intrusiveTests
+ * ------------------------------------------------------------------
+ * Tests that the IntrusivePriorityQueue orders jobs it does not own,
+ * and that jobs can be removed or reprioritized in place.
+ */
+void intrusiveTests() {
+    beginTest("Intrusive Tests");
+
+    try {
+        /* Jobs should come out in deadline order. */
+        {
+            logInfo("Enqueueing 1000 jobs with random deadlines.");
+            Vector<IntrusiveJob> jobs(1000);
+            IntrusivePriorityQueue<IntrusiveJob> queue;
+            Vector<int> deadlines;
+            for (int i = 0; i < jobs.size(); i++) {
+                jobs[i].deadline = randomInteger(-1000, 1000);
+                jobs[i].id = i;
+                deadlines.add(jobs[i].deadline);
+                queue.enqueue(jobs[i]);
+            }
+            checkCondition(queue.size() == 1000, "Queue should hold 1000 jobs.");
+            sort(deadlines.begin(), deadlines.end());
+            bool isCorrect = true;
+            for (int i = 0; i < deadlines.size(); i++) {
+                IntrusiveJob& job = queue.dequeue();
+                if (job.deadline != deadlines[i] || queue.contains(job)) isCorrect = false;
+            }
+            checkCondition(isCorrect, "Jobs should dequeue in deadline order.");
+            checkCondition(queue.isEmpty(), "Queue should be empty.");
+        }
+
+        /* Removing and rescheduling jobs in place should keep the order. */
+        {
+            logInfo("Removing and rescheduling jobs at random.");
+            Vector<IntrusiveJob> jobs(1000);
+            IntrusivePriorityQueue<IntrusiveJob> queue;
+            for (int i = 0; i < jobs.size(); i++) {
+                jobs[i].deadline = randomInteger(0, 1000);
+                jobs[i].id = i;
+                queue.enqueue(jobs[i]);
+            }
+            int removed = 0;
+            for (int i = 0; i < jobs.size(); i++) {
+                if (i % 3 == 0) {
+                    queue.remove(jobs[i]);
+                    removed++;
+                } else if (i % 3 == 1) {
+                    jobs[i].deadline = randomInteger(0, 1000);
+                    queue.update(jobs[i]);
+                }
+            }
+            checkCondition(queue.size() == 1000 - removed, "Removed jobs should leave the queue.");
+            checkCondition(!queue.contains(jobs[0]) && queue.contains(jobs[1]),
+                           "Only queued jobs should be contained.");
+            bool isCorrect = true;
+            IntrusiveJob *last = NULL;
+            while (!queue.isEmpty()) {
+                IntrusiveJob& job = queue.dequeue();
+                if (last != NULL && job < *last) isCorrect = false;
+                last = &job;
+            }
+            checkCondition(isCorrect, "Rescheduled jobs should dequeue in order.");
+        }
+
+        /* The queue should never allocate. */
+        {
+            logInfo("Enqueueing and dequeueing 1000 jobs.");
+            Vector<IntrusiveJob> jobs(1000);
+            IntrusivePriorityQueue<IntrusiveJob> queue;
+#ifdef PQUEUE_COUNT_OPERATIONS
+            clearOperationCounters();
+#endif
+            for (int i = 0; i < jobs.size(); i++) {
+                jobs[i].deadline = randomInteger(0, 100);
+                jobs[i].id = i;
+                queue.enqueue(jobs[i]);
+            }
+            queue.clear();
+            checkCondition(!queue.contains(jobs[0]) && queue.isEmpty(), "Clear should unlink every job.");
+#ifdef PQUEUE_COUNT_OPERATIONS
+            checkCondition(operationCounters.allocations == 0, "The queue should not allocate.");
+#endif
+        }
+
+    } catch (ErrorException& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.getMessage() << endl;
+    } catch (exception& e) {
+        cout << "TEST FAILURE: Unexpected exception: " << e.what() << endl;
+    } catch (...) {
+        cout << "TEST FAILURE: Unknown exception." << endl;
+    }
+
+    endTest("Intrusive Tests");
 }
 
 /* Function: printReplInstructions
@@ -1028,6 +2725,7 @@ void printReplInstructions() {
     cout << "   [e]nqueue <str> <p>:  Enqueues the string <str> with priority <p>" << endl;
     cout << "   [p]eek:        Peeks at the minimum element of the priority queue." << endl;
     cout << "   [d]equeue:     Dequeues the minimum element of the priority queue." << endl;
+    cout << "   [l]atency:            Reports the latency of each command so far." << endl;
     cout << "   [q]uit:               Quits the interpret and returns to the menu." << endl;
     cout << endl;
     cout << "The first letter of any command can be used as a substitute" << endl;
@@ -1048,7 +2746,8 @@ void printReplInstructions() {
  *
  * will execute those corresponding commands on the priority queue.
  * You can use this code to interactively step through your priority
- * queue.
+ * queue. The queue is instrumented, so the latency command can
+ * report how long each kind of call has taken.
  */
 template <typename PQueue>
     void replTestPriorityQueue() {
@@ -1059,7 +2758,8 @@ template <typename PQueue>
      * this function returns.
      */
     {
-        PQueue queue;
+        InstrumentedPriorityQueue<PQueue> queue;
+        queue.latencies().clear();
         while (true) {
             /* Get a command from the user. */
             istringstream command(getLine("Enter command: "));
@@ -1080,6 +2780,8 @@ template <typename PQueue>
                         cout << queue.size() << endl;
                     } else if (action == "dequeue" || action == "d") {
                         cout << queue.dequeue() << endl;
+                    } else if (action == "latency" || action == "l") {
+                        printLatencyReport(cout, queue.latencies());
                     } else if (action == "quit" || action == "q") {
                         cout << "Leaving test environment...   " << flush;
                         break;
@@ -1112,6 +2814,49 @@ template <typename PQueue>
     cout << endl;
 }
 
+/* Class: SpillingExternalPriorityQueue
+ * ------------------------------------------------------------------
+ * An ExternalPriorityQueue with a memory budget small enough that the
+ * tests above write runs to disk and merge them back together.
+ */
+class SpillingExternalPriorityQueue : public ExternalPriorityQueue {
+public:
+    SpillingExternalPriorityQueue() : ExternalPriorityQueue(256) {}
+};
+
+/* Class: RoomyBoundedPriorityQueue
+ * ------------------------------------------------------------------
+ * A BoundedPriorityQueue with room for everything the generic tests
+ * enqueue, so they can run against it without anything evicted.
+ */
+class RoomyBoundedPriorityQueue : public BoundedPriorityQueue {
+public:
+    RoomyBoundedPriorityQueue() : BoundedPriorityQueue(5000) {}
+};
+
+/* Class: PrivateSharedMemoryPriorityQueue
+ * ------------------------------------------------------------------
+ * A SharedMemoryPriorityQueue in a fresh segment that is unlinked as
+ * soon as it is attached, so each test gets its own empty queue and
+ * nothing is left behind when it is destroyed.
+ */
+class PrivateSharedMemoryPriorityQueue : public SharedMemoryPriorityQueue {
+public:
+    PrivateSharedMemoryPriorityQueue() : SharedMemoryPriorityQueue(freshSegment(), 20000) {
+        unlink(kSegmentName);
+    }
+
+private:
+    static string freshSegment() {
+        unlink(kSegmentName);
+        return kSegmentName;
+    }
+
+    static const string kSegmentName;
+};
+
+const string PrivateSharedMemoryPriorityQueue::kSegmentName = "/pqueue-test";
+
 /* Constants for the menu. */
 enum {
     REPL_VECTOR = 1,
@@ -1122,6 +2867,18 @@ enum {
     TEST_HEAP,
     REPL_BINOMIALHEAP,
     TEST_BINOMIALHEAP,
+    TEST_TIMINGWHEEL,
+    REPL_EXTERNAL,
+    TEST_EXTERNAL,
+    REPL_SHARED_MEMORY,
+    TEST_SHARED_MEMORY,
+    REPL_ADAPTIVE,
+    TEST_ADAPTIVE,
+    REPL_MINMAX_HEAP,
+    TEST_MINMAX_HEAP,
+    REPL_GROUPED,
+    TEST_GROUPED,
+    TEST_INTRUSIVE,
     QUIT
 };
 
@@ -1135,11 +2892,23 @@ void displayMenu() {
     cout << REPL_VECTOR << ": Manually test VectorPriorityQueue" << endl;
     cout << TEST_VECTOR << ": Automatically test VectorPriorityQueue" << endl;
     cout << REPL_DOUBLY_LINKED_LIST << ": Manually test LinkedPriorityQueue" << endl;
-    cout << TEST_DOUBLY_LINKED_LIST << ": Automatically test LinkedPriorityQueue" << endl;
+    cout << TEST_DOUBLY_LINKED_LIST << ": Automatically test LinkedPriorityQueue and UnrolledLinkedPriorityQueue" << endl;
     cout << REPL_HEAP << ": Manually test HeapPriorityQueue" << endl;
-    cout << TEST_HEAP << ": Automatically test HeapPriorityQueue" << endl;
+    cout << TEST_HEAP << ": Automatically test HeapPriorityQueue and IndirectHeapPriorityQueue" << endl;
     cout << REPL_BINOMIALHEAP << ": Manually test BinomialHeapPriorityQueue" << endl;
     cout << TEST_BINOMIALHEAP << ": Automatically test BinomialHeapPriorityQueue" << endl;
+    cout << TEST_TIMINGWHEEL << ": Automatically test TimingWheelPriorityQueue" << endl;
+    cout << REPL_EXTERNAL << ": Manually test ExternalPriorityQueue" << endl;
+    cout << TEST_EXTERNAL << ": Automatically test ExternalPriorityQueue" << endl;
+    cout << REPL_SHARED_MEMORY << ": Manually test SharedMemoryPriorityQueue" << endl;
+    cout << TEST_SHARED_MEMORY << ": Automatically test SharedMemoryPriorityQueue" << endl;
+    cout << REPL_ADAPTIVE << ": Manually test AdaptivePriorityQueue" << endl;
+    cout << TEST_ADAPTIVE << ": Automatically test AdaptivePriorityQueue" << endl;
+    cout << REPL_MINMAX_HEAP << ": Manually test MinMaxHeapPriorityQueue" << endl;
+    cout << TEST_MINMAX_HEAP << ": Automatically test MinMaxHeapPriorityQueue and BoundedPriorityQueue" << endl;
+    cout << REPL_GROUPED << ": Manually test GroupedPriorityQueue" << endl;
+    cout << TEST_GROUPED << ": Automatically test GroupedPriorityQueue" << endl;
+    cout << TEST_INTRUSIVE << ": Automatically test IntrusivePriorityQueue" << endl;
     cout << QUIT << ": Quit" << endl;
 }
 
@@ -1154,28 +2923,135 @@ int main() {
         switch (getInteger("Enter choice: ")) {
         case TEST_VECTOR:
             testPriorityQueue<VectorPriorityQueue> ();
+            snapshotTests<VectorPriorityQueue> ();
+            durableTests<VectorPriorityQueue> ();
+            traceTests<VectorPriorityQueue> ();
+            smallBufferTests<VectorPriorityQueue> ();
+            tieBreakTests<VectorPriorityQueue> ();
+            moveTests<VectorPriorityQueue> ();
+            tryTests<VectorPriorityQueue> ();
+            memoryResourceTests<VectorPriorityQueue> ();
             break;
         case REPL_VECTOR:
             replTestPriorityQueue<VectorPriorityQueue> ();
             break;
         case TEST_DOUBLY_LINKED_LIST:
             testPriorityQueue<LinkedPriorityQueue> ();
+            snapshotTests<LinkedPriorityQueue> ();
+            durableTests<LinkedPriorityQueue> ();
+            traceTests<LinkedPriorityQueue> ();
+            smallBufferTests<LinkedPriorityQueue> ();
+            tieBreakTests<LinkedPriorityQueue> ();
+            moveTests<LinkedPriorityQueue> ();
+            tryTests<LinkedPriorityQueue> ();
+            memoryResourceTests<LinkedPriorityQueue> ();
+            testPriorityQueue<UnrolledLinkedPriorityQueue> ();
+            snapshotTests<UnrolledLinkedPriorityQueue> ();
+            tieBreakTests<UnrolledLinkedPriorityQueue> ();
+            moveTests<UnrolledLinkedPriorityQueue> ();
+            tryTests<UnrolledLinkedPriorityQueue> ();
+            memoryResourceTests<UnrolledLinkedPriorityQueue> ();
+            unrolledLinkedTests();
             break;
         case REPL_DOUBLY_LINKED_LIST:
             replTestPriorityQueue<LinkedPriorityQueue> ();
             break;
         case TEST_HEAP:
             testPriorityQueue<HeapPriorityQueue> ();
+            snapshotTests<HeapPriorityQueue> ();
+            durableTests<HeapPriorityQueue> ();
+            traceTests<HeapPriorityQueue> ();
+            smallBufferTests<HeapPriorityQueue> ();
+            tieBreakTests<HeapPriorityQueue> ();
+            moveTests<HeapPriorityQueue> ();
+            tryTests<HeapPriorityQueue> ();
+            tryTests<InstrumentedPriorityQueue<HeapPriorityQueue> > ();
+            memoryResourceTests<HeapPriorityQueue> ();
+            testPriorityQueue<BufferedHeapPriorityQueue> ();
+            snapshotTests<BufferedHeapPriorityQueue> ();
+            memoryResourceTests<BufferedHeapPriorityQueue> ();
+            testPriorityQueue<LazyHeapPriorityQueue> ();
+            snapshotTests<LazyHeapPriorityQueue> ();
+            tryTests<LazyHeapPriorityQueue> ();
+            memoryResourceTests<LazyHeapPriorityQueue> ();
+            tryTests<SmallPriorityQueue<BufferedHeapPriorityQueue> > ();
+            testPriorityQueue<IndirectHeapPriorityQueue> ();
+            moveTests<IndirectHeapPriorityQueue> ();
+            tryTests<IndirectHeapPriorityQueue> ();
+            memoryResourceTests<IndirectHeapPriorityQueue> ();
+            indirectHeapTests();
             break;
         case REPL_HEAP:
             replTestPriorityQueue<HeapPriorityQueue> ();
             break;
         case TEST_BINOMIALHEAP:
             testPriorityQueue<BinomialHeapPriorityQueue> ();
+            snapshotTests<BinomialHeapPriorityQueue> ();
+            durableTests<BinomialHeapPriorityQueue> ();
+            traceTests<BinomialHeapPriorityQueue> ();
+            smallBufferTests<BinomialHeapPriorityQueue> ();
+            tieBreakTests<BinomialHeapPriorityQueue> ();
+            moveTests<BinomialHeapPriorityQueue> ();
+            tryTests<BinomialHeapPriorityQueue> ();
+            binomialHeapTests();
+            memoryResourceTests<BinomialHeapPriorityQueue> ();
             break;
         case REPL_BINOMIALHEAP:
             replTestPriorityQueue<BinomialHeapPriorityQueue> ();
             break;
+        case TEST_TIMINGWHEEL:
+            timingWheelTests();
+            break;
+        case TEST_EXTERNAL:
+            testPriorityQueue<SpillingExternalPriorityQueue> ();
+            tieBreakTests<SpillingExternalPriorityQueue> ();
+            tryTests<SpillingExternalPriorityQueue> ();
+            externalTests();
+            break;
+        case REPL_EXTERNAL:
+            replTestPriorityQueue<SpillingExternalPriorityQueue> ();
+            break;
+        case TEST_SHARED_MEMORY:
+            testPriorityQueue<PrivateSharedMemoryPriorityQueue> ();
+            tryTests<PrivateSharedMemoryPriorityQueue> ();
+            sharedMemoryTests();
+            break;
+        case REPL_SHARED_MEMORY:
+            replTestPriorityQueue<PrivateSharedMemoryPriorityQueue> ();
+            break;
+        case TEST_ADAPTIVE:
+            testPriorityQueue<SortedArrayPriorityQueue> ();
+            tryTests<SortedArrayPriorityQueue> ();
+            tryTests<RadixHeapPriorityQueue> ();
+            testPriorityQueue<AdaptivePriorityQueue> ();
+            tryTests<AdaptivePriorityQueue> ();
+            adaptiveTests();
+            break;
+        case REPL_ADAPTIVE:
+            replTestPriorityQueue<AdaptivePriorityQueue> ();
+            break;
+        case TEST_MINMAX_HEAP:
+            testPriorityQueue<MinMaxHeapPriorityQueue> ();
+            tryTests<MinMaxHeapPriorityQueue> ();
+            memoryResourceTests<MinMaxHeapPriorityQueue> ();
+            minMaxHeapTests();
+            tryTests<RoomyBoundedPriorityQueue> ();
+            boundedTests();
+            break;
+        case REPL_MINMAX_HEAP:
+            replTestPriorityQueue<MinMaxHeapPriorityQueue> ();
+            break;
+        case TEST_GROUPED:
+            testPriorityQueue<GroupedPriorityQueue> ();
+            tieBreakTests<GroupedPriorityQueue> ();
+            tryTests<GroupedPriorityQueue> ();
+            break;
+        case REPL_GROUPED:
+            replTestPriorityQueue<GroupedPriorityQueue> ();
+            break;
+        case TEST_INTRUSIVE:
+            intrusiveTests();
+            break;
         case QUIT:
             return 0;
         default: